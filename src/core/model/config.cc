@@ -27,6 +27,7 @@
 #include "log.h"
 
 #include <sstream>
+#include <algorithm>
 
 /**
  * \file
@@ -856,6 +857,29 @@ MatchContainer LookupMatches (std::string path)
   NS_LOG_FUNCTION (path);
   return ConfigImpl::Get ()->LookupMatches (path);
 }
+MatchContainer LookupTraceMatches (std::string path, std::string *leaf)
+{
+  NS_LOG_FUNCTION (path << leaf);
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT (slash != std::string::npos);
+  *leaf = path.substr (slash + 1);
+  return ConfigImpl::Get ()->LookupMatches (path.substr (0, slash));
+}
+uint32_t GetNodeId (std::string path)
+{
+  NS_LOG_FUNCTION (path);
+  const std::string prefix = "/NodeList/";
+  std::string::size_type end = std::min (path.find ('/', prefix.size ()), path.size ());
+  if (path.compare (0, prefix.size (), prefix) != 0 || end == prefix.size ()
+      || std::min (path.find_first_not_of ("0123456789", prefix.size ()), path.size ()) != end)
+    {
+      NS_FATAL_ERROR ("Path " << path << " does not start with /NodeList/<index>");
+    }
+  std::istringstream iss (path.substr (prefix.size (), end - prefix.size ()));
+  uint32_t nodeId;
+  iss >> nodeId;
+  return nodeId;
+}
 
 void RegisterRootNamespaceObject (Ptr<Object> obj)
 {
@@ -21,6 +21,8 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "object.h"
+#include "callback.h"
 #include <string>
 #include <vector>
 
@@ -258,6 +260,61 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \param [in] path A path in the "/NodeList/" namespace, such as a matched
+ *          path or a trace context.
+ * \returns The index of the node of the path, in "/NodeList/<index>/".
+ *
+ * A fatal error is raised if the path does not start with "/NodeList/<index>".
+ */
+uint32_t GetNodeId (std::string path);
+
+/**
+ * \ingroup config
+ * \param [in] path A path to match trace sources, in the "/NodeList/"
+ *          namespace.
+ * \param [out] leaf The name of the trace source at the end of the path.
+ * \returns A container which contains all the objects which match the path
+ *          without its last element.
+ *
+ * This function is used by Config::ConnectWithNodeId and
+ * Config::DisconnectWithNodeId.
+ */
+MatchContainer LookupTraceMatches (std::string path, std::string *leaf);
+
+/**
+ * \ingroup config
+ * \param [in] path A path to match trace sources, in the "/NodeList/"
+ *          namespace.
+ * \param [in] cb The callback to connect to the matching trace sources,
+ *          whose first argument is a node index.
+ *
+ * This function will attempt to find all trace sources which
+ * match the input path and will then connect the input callback
+ * to them in such a way that the callback will receive the index
+ * of the node of the trace source upon trace event notification.
+ * Unlike Config::Connect, the node index is bound once when
+ * connecting, so that no context string is built, copied or parsed
+ * on each trace event.
+ */
+template <typename R, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename T8>
+void ConnectWithNodeId (std::string path,
+                        Callback<R,uint32_t,T1,T2,T3,T4,T5,T6,T7,T8> cb);
+/**
+ * \ingroup config
+ * \param [in] path A path to match trace sources, in the "/NodeList/"
+ *          namespace.
+ * \param [in] cb The callback to disconnect from the matching trace sources.
+ *
+ * This function undoes the work of Config::ConnectWithNodeId.
+ */
+template <typename R, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename T8>
+void DisconnectWithNodeId (std::string path,
+                           Callback<R,uint32_t,T1,T2,T3,T4,T5,T6,T7,T8> cb);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -289,6 +346,44 @@ Ptr<Object> GetRootNamespaceObject (uint32_t i);
 
 } // namespace Config
 
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace Config {
+
+template <typename R, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename T8>
+void
+ConnectWithNodeId (std::string path,
+                   Callback<R,uint32_t,T1,T2,T3,T4,T5,T6,T7,T8> cb)
+{
+  std::string leaf;
+  MatchContainer container = LookupTraceMatches (path, &leaf);
+  for (std::size_t i = 0; i < container.GetN (); ++i)
+    {
+      uint32_t nodeId = GetNodeId (container.GetMatchedPath (i));
+      container.Get (i)->TraceConnectWithoutContext (leaf, cb.Bind (nodeId));
+    }
+}
+
+template <typename R, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename T8>
+void
+DisconnectWithNodeId (std::string path,
+                      Callback<R,uint32_t,T1,T2,T3,T4,T5,T6,T7,T8> cb)
+{
+  std::string leaf;
+  MatchContainer container = LookupTraceMatches (path, &leaf);
+  for (std::size_t i = 0; i < container.GetN (); ++i)
+    {
+      uint32_t nodeId = GetNodeId (container.GetMatchedPath (i));
+      container.Get (i)->TraceDisconnectWithoutContext (leaf, cb.Bind (nodeId));
+    }
+}
+
+} // namespace Config
+
 } // namespace ns3
 
 #endif /* CONFIG_H */
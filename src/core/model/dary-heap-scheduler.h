@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::DaryHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-friendly 4-ary implicit heap event scheduler
+ *
+ * This is the same classic data structure as HeapScheduler, with two
+ * changes aimed at the event populations of large wireless simulations,
+ * where many events share a timestamp (for example every cell's slot
+ * boundary):
+ *  - each node has four children instead of two, which halves the
+ *    depth of the heap, and hence the number of levels RemoveNext has
+ *    to visit;
+ *  - the sort keys are stored inline in their own array, apart from the
+ *    EventImpl pointers.  An EventKey is 16 bytes, so the four children
+ *    compared at each level of a top-down pass span a single 64-byte
+ *    cache line, and the event implementations are never touched while
+ *    sifting.
+ *
+ * Entries are moved into a hole rather than swapped, so each level of
+ * a sift costs one store per array.
+ *
+ * Like HeapScheduler, Remove () is a linear search; it is only used
+ * by Simulator::Remove, which is rare.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DaryHeapScheduler ();
+  /** Destructor. */
+  virtual ~DaryHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Number of children of each node. */
+  static const std::size_t ARITY = 4;
+
+  /**
+   * Move an entry up the heap to its proper position.
+   *
+   * \param [in] index The index of the hole to fill.
+   * \param [in] key The key of the entry to place.
+   * \param [in] impl The event of the entry to place.
+   */
+  void SiftUp (std::size_t index, const EventKey &key, EventImpl *impl);
+  /**
+   * Move an entry down the heap to its proper position.
+   *
+   * \param [in] index The index of the hole to fill.
+   * \param [in] key The key of the entry to place.
+   * \param [in] impl The event of the entry to place.
+   */
+  void SiftDown (std::size_t index, const EventKey &key, EventImpl *impl);
+  /**
+   * Remove the entry at a given index and restore the heap property.
+   *
+   * \param [in] index The index of the entry to remove.
+   */
+  void RemoveAt (std::size_t index);
+
+  /** The sort keys, managed as a 4-ary heap rooted at index 0. */
+  std::vector<EventKey> m_keys;
+  /** The events, at the same indexes as their keys in m_keys. */
+  std::vector<EventImpl *> m_impls;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
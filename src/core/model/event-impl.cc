@@ -21,6 +21,9 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <atomic>
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -66,4 +69,274 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+#ifdef EVENT_IMPL_POOL
+/*
+ * Slab allocator behind EventImpl::operator new.
+ *
+ * Event sizes are rounded up to a multiple of g_poolGranularity and each
+ * size class has its own singly-linked free list per thread, so the fast
+ * paths are a few loads and stores with no locking.
+ *
+ * Events are often released by another thread than the one which
+ * allocated them (cross-thread injection, partitions of the
+ * multithreaded simulator), so free blocks accumulate where events die
+ * rather than where they are born.  A thread therefore keeps at most
+ * g_poolThreadCap free blocks per size class and moves batches of
+ * g_poolBatch blocks beyond that to a shared depot, and hands its whole
+ * free lists to the depot when it exits.  An empty free list is refilled
+ * with a batch from the depot first, and only then by carving a new slab
+ * out of the heap, so the pool never grows beyond the peak number of live
+ * events plus the per-thread caches.
+ *
+ * Slabs are never returned to the system, since blocks of one slab are
+ * spread over many threads.  Every slab is kept reachable from
+ * g_poolSlabs so leak checkers stay quiet.
+ *
+ * Logging is avoided here: these functions run for every event.
+ */
+namespace {
+
+/** Size class granularity, in bytes. */
+const std::size_t g_poolGranularity = 16;
+/** Number of size classes; larger events use the global heap. */
+const std::size_t g_poolClasses = 16;
+/** Number of blocks moved at once to or from the depot, and carved from each slab. */
+const std::size_t g_poolBatch = 64;
+/** Number of free blocks per size class a thread keeps for itself. */
+const std::size_t g_poolThreadCap = 2 * g_poolBatch;
+
+/** An unused block, linked in a free list. */
+struct PoolBlock
+{
+  PoolBlock *next;       //!< Next free block of the same size class.
+  PoolBlock *nextBatch;  //!< Next batch in the depot, set on the first block of a batch.
+};
+
+static_assert (sizeof (PoolBlock) <= g_poolGranularity,
+               "A free block does not fit in the smallest size class");
+
+/** Slab header, padded so the blocks which follow are suitably aligned. */
+union PoolSlab
+{
+  PoolSlab *next;          //!< Next slab in g_poolSlabs.
+  std::max_align_t align;  //!< Alignment padding.
+};
+
+/** The free list of one size class in one thread. */
+struct PoolFreeList
+{
+  PoolBlock *head;    //!< First free block.
+  std::size_t count;  //!< Number of blocks in the list.
+};
+
+/**
+ * Per-thread pool state.
+ *
+ * Plain data, so accessing it costs no more than any other thread_local
+ * variable; the thread exit hook lives in PoolExitHook.
+ */
+struct PoolCache
+{
+  bool hooked;                               //!< PoolExitHook armed in this thread.
+  PoolFreeList freeLists[g_poolClasses];     //!< Free lists, one per size class.
+};
+
+/** This thread's pool state. */
+thread_local PoolCache g_poolCache;
+
+/** Batches of free blocks given up by threads, one stack per size class. */
+PoolBlock *g_poolDepot[g_poolClasses];
+
+/** Protects g_poolDepot; only taken once every g_poolBatch events. */
+std::atomic_flag g_poolDepotLock = ATOMIC_FLAG_INIT;
+
+/** All slabs ever allocated, by any thread. */
+std::atomic<PoolSlab *> g_poolSlabs (0);
+
+/**
+ * Push a chain of free blocks onto the depot.
+ * \param [in] index The size class index.
+ * \param [in] batch The first block of a null-terminated chain.
+ */
+void
+PoolDepotPush (std::size_t index, PoolBlock *batch)
+{
+  while (g_poolDepotLock.test_and_set (std::memory_order_acquire))
+    {
+    }
+  batch->nextBatch = g_poolDepot[index];
+  g_poolDepot[index] = batch;
+  g_poolDepotLock.clear (std::memory_order_release);
+}
+
+/**
+ * Pop a chain of free blocks from the depot.
+ * \param [in] index The size class index.
+ * \returns The first block of the chain, or 0 if the depot is empty.
+ */
+PoolBlock *
+PoolDepotPop (std::size_t index)
+{
+  while (g_poolDepotLock.test_and_set (std::memory_order_acquire))
+    {
+    }
+  PoolBlock *batch = g_poolDepot[index];
+  if (batch != 0)
+    {
+      g_poolDepot[index] = batch->nextBatch;
+    }
+  g_poolDepotLock.clear (std::memory_order_release);
+  return batch;
+}
+
+/** Returns the free blocks of a thread to the depot when the thread exits. */
+struct PoolExitHook
+{
+  ~PoolExitHook ()
+  {
+    for (std::size_t index = 0; index < g_poolClasses; ++index)
+      {
+        PoolFreeList &list = g_poolCache.freeLists[index];
+        if (list.head != 0)
+          {
+            PoolDepotPush (index, list.head);
+          }
+        list.head = 0;
+        list.count = 0;
+      }
+  }
+};
+
+/** Armed on the first slow path taken by each thread. */
+thread_local PoolExitHook g_poolExitHook;
+
+/**
+ * Make sure the free lists of this thread go to the depot on thread exit.
+ *
+ * Blocks released after the hook ran (by destructors of other thread
+ * locals or statics) stay in the thread's lists and are lost with it.
+ */
+void
+PoolHook (void)
+{
+  if (!g_poolCache.hooked)
+    {
+      g_poolCache.hooked = true;
+      // Odr-use the thread_local so its destructor is registered.
+      static_cast<void> (&g_poolExitHook);
+    }
+}
+
+/**
+ * Refill an empty free list, from the depot if it has a batch and
+ * otherwise from a new slab.
+ * \param [in] index The size class index.
+ */
+void
+PoolRefill (std::size_t index)
+{
+  PoolHook ();
+  PoolFreeList &list = g_poolCache.freeLists[index];
+
+  PoolBlock *batch = PoolDepotPop (index);
+  if (batch != 0)
+    {
+      std::size_t count = 0;
+      for (PoolBlock *block = batch; block != 0; block = block->next)
+        {
+          ++count;
+        }
+      list.head = batch;
+      list.count = count;
+      return;
+    }
+
+  std::size_t blockSize = (index + 1) * g_poolGranularity;
+  char *raw = static_cast<char *> (::operator new (sizeof (PoolSlab) + blockSize * g_poolBatch));
+
+  PoolSlab *slab = reinterpret_cast<PoolSlab *> (raw);
+  slab->next = g_poolSlabs.load (std::memory_order_relaxed);
+  while (!g_poolSlabs.compare_exchange_weak (slab->next, slab, std::memory_order_release,
+                                             std::memory_order_relaxed))
+    {
+    }
+
+  char *blocks = raw + sizeof (PoolSlab);
+  for (std::size_t i = 0; i < g_poolBatch - 1; ++i)
+    {
+      reinterpret_cast<PoolBlock *> (blocks + i * blockSize)->next =
+        reinterpret_cast<PoolBlock *> (blocks + (i + 1) * blockSize);
+    }
+  reinterpret_cast<PoolBlock *> (blocks + (g_poolBatch - 1) * blockSize)->next = 0;
+  list.head = reinterpret_cast<PoolBlock *> (blocks);
+  list.count = g_poolBatch;
+}
+
+/**
+ * Move one batch from a free list over g_poolThreadCap to the depot.
+ * \param [in] index The size class index.
+ */
+void
+PoolSpill (std::size_t index)
+{
+  PoolHook ();
+  PoolFreeList &list = g_poolCache.freeLists[index];
+
+  PoolBlock *batch = list.head;
+  PoolBlock *last = batch;
+  for (std::size_t i = 1; i < g_poolBatch; ++i)
+    {
+      last = last->next;
+    }
+  list.head = last->next;
+  list.count -= g_poolBatch;
+  last->next = 0;
+  PoolDepotPush (index, batch);
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t index = (size - 1) / g_poolGranularity;
+  if (index >= g_poolClasses)
+    {
+      return ::operator new (size);
+    }
+  PoolFreeList &list = g_poolCache.freeLists[index];
+  if (list.head == 0)
+    {
+      PoolRefill (index);
+    }
+  PoolBlock *block = list.head;
+  list.head = block->next;
+  --list.count;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t index = (size - 1) / g_poolGranularity;
+  if (index >= g_poolClasses)
+    {
+      ::operator delete (p);
+      return;
+    }
+  PoolFreeList &list = g_poolCache.freeLists[index];
+  PoolBlock *block = static_cast<PoolBlock *> (p);
+  block->next = list.head;
+  list.head = block;
+  if (++list.count > g_poolThreadCap)
+    {
+      PoolSpill (index);
+    }
+}
+#endif /* EVENT_IMPL_POOL */
+
 } // namespace ns3
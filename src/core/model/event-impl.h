@@ -21,7 +21,9 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
+#include "ns3/core-config.h"
 
 /**
  * \file
@@ -66,6 +68,35 @@ public:
    */
   bool IsCancelled (void);
 
+#ifdef EVENT_IMPL_POOL
+  /**
+   * Allocate storage for an event from the calling thread's pool.
+   *
+   * Every event type created by MakeEvent() and friends inherits this
+   * allocator, so scheduling does not reach the global heap once the
+   * pool for that event size is warm.  Events too large for the
+   * pooled size classes are passed on to the global operator new.
+   * The pool is left out when ns-3 is configured with
+   * --disable-event-pool.
+   *
+   * \param [in] size The size of the concrete event type.
+   * \returns The storage.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return event storage to the calling thread's pool.
+   *
+   * Events may be released by a thread other than the one which created
+   * them.  A thread keeps a bounded number of free blocks per size class
+   * and hands any excess back to a shared depot, as it does with all of
+   * its blocks when it exits, so other threads reuse the storage.
+   *
+   * \param [in] p The storage to release.
+   * \param [in] size The size of the concrete event type.
+   */
+  static void operator delete (void *p, std::size_t size);
+#endif /* EVENT_IMPL_POOL */
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "non-copyable.h"
+
+#include <atomic>
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup thread
+ *
+ * \brief Unbounded, lock-free, multiple-producer single-consumer queue.
+ *
+ * Any number of threads may call Push() concurrently; only one thread
+ * at a time may call Pop() or IsEmpty().  Push() is wait-free (a single
+ * atomic exchange); Pop() never blocks.
+ *
+ * This is the node-based queue described by D. Vyukov: producers swing
+ * the head pointer to their new node and then link the previous head
+ * to it, while the consumer follows the \c next links from a stub node
+ * at the tail.  A producer that has been preempted between those two
+ * steps makes the queue look temporarily empty to the consumer; the
+ * element becomes visible as soon as the producer resumes, and ordering
+ * between elements pushed by the same producer is always preserved.
+ *
+ * \tparam T \deduced The element type, which must be copy-assignable
+ *           and default-constructible.
+ */
+template <typename T>
+class MpscQueue : private NonCopyable
+{
+public:
+  /** Constructor. */
+  MpscQueue ();
+  /** Destructor; any remaining elements are discarded. */
+  ~MpscQueue ();
+
+  /**
+   * Append an element.  Safe to call from any thread.
+   * \param [in] value The element to append.
+   */
+  void Push (const T &value);
+  /**
+   * Remove the oldest visible element.  Consumer thread only.
+   * \param [out] value The element removed, if any.
+   * \returns \c true if an element was removed.
+   */
+  bool Pop (T &value);
+  /**
+   * Check for visible elements.  Consumer thread only.
+   * \returns \c true if there is nothing to Pop().
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /** Queue node. */
+  struct Node
+  {
+    std::atomic<Node *> next;  //!< The next (newer) node.
+    T value;                   //!< The element.
+  };
+
+  /** Most recently pushed node; written by producers. */
+  std::atomic<Node *> m_head;
+  /** Keep m_tail off the cache line the producers write to. */
+  char m_pad[64 - sizeof (std::atomic<Node *>)];
+  /** Stub node whose successor is the oldest element; consumer only. */
+  Node *m_tail;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue ()
+{
+  Node *stub = new Node;
+  stub->next.store (0, std::memory_order_relaxed);
+  m_head.store (stub, std::memory_order_relaxed);
+  m_tail = stub;
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  while (m_tail != 0)
+    {
+      Node *next = m_tail->next.load (std::memory_order_relaxed);
+      delete m_tail;
+      m_tail = next;
+    }
+}
+
+template <typename T>
+void
+MpscQueue<T>::Push (const T &value)
+{
+  Node *node = new Node;
+  node->next.store (0, std::memory_order_relaxed);
+  node->value = value;
+  Node *prev = m_head.exchange (node, std::memory_order_acq_rel);
+  prev->next.store (node, std::memory_order_release);
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop (T &value)
+{
+  Node *tail = m_tail;
+  Node *next = tail->next.load (std::memory_order_acquire);
+  if (next == 0)
+    {
+      return false;
+    }
+  // The popped node becomes the new stub.
+  value = next->value;
+  m_tail = next;
+  delete tail;
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  return m_tail->next.load (std::memory_order_acquire) == 0;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
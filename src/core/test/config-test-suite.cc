@@ -775,6 +775,121 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+/**
+ * \ingroup config-tests
+ * Root namespace object with a "NodeList" of test objects.
+ */
+class NodeListConfigTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * Add a node
+   * \param node test object
+   */
+  void AddNode (Ptr<ConfigTestObject> node) { m_nodes.push_back (node); }
+
+private:
+  std::vector<Ptr<ConfigTestObject> > m_nodes; //!< NodeList attribute target.
+};
+
+TypeId
+NodeListConfigTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("NodeListConfigTestObject")
+    .SetParent<Object> ()
+    .AddAttribute ("NodeList", "",
+                   ObjectVectorValue (),
+                   MakeObjectVectorAccessor (&NodeListConfigTestObject::m_nodes),
+                   MakeObjectVectorChecker<ConfigTestObject> ())
+    ;
+  return tid;
+}
+
+/**
+ * \ingroup config-tests
+ * Test for the ability to trace connect with the node index as context.
+ */
+class NodeIdTraceConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  NodeIdTraceConfigTestCase ();
+  /** Destructor. */
+  virtual ~NodeIdTraceConfigTestCase () {}
+
+  /**
+   * Trace callback with node index.
+   * \param nodeId The node index.
+   * \param oldValue The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithNodeId (uint32_t nodeId, int16_t oldValue, int16_t newValue)
+  {
+    NS_UNUSED (oldValue);
+    m_nodeId = nodeId;
+    m_newValue = newValue;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_nodeId;  //!< The node index.
+  int16_t m_newValue; //!< Flag to detect tracing result.
+};
+
+NodeIdTraceConfigTestCase::NodeIdTraceConfigTestCase ()
+  : TestCase ("Check ability to trace connect with the node index as context")
+{
+}
+
+void
+NodeIdTraceConfigTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (Config::GetNodeId ("/NodeList/0"), 0u, "Wrong node index");
+  NS_TEST_ASSERT_MSG_EQ (Config::GetNodeId ("/NodeList/17/DeviceList/2/Mac"), 17u, "Wrong node index");
+
+  Ptr<NodeListConfigTestObject> root = CreateObject<NodeListConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> node0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> node1 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> node2 = CreateObject<ConfigTestObject> ();
+  root->AddNode (node0);
+  root->AddNode (node1);
+  root->AddNode (node2);
+
+  Callback<void, uint32_t, int16_t, int16_t> cb =
+    MakeCallback (&NodeIdTraceConfigTestCase::TraceWithNodeId, this);
+  Config::ConnectWithNodeId ("/NodeList/1|2/Source", cb);
+
+  m_nodeId = 0;
+  m_newValue = 0;
+  node2->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -2, "Trace 2 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_nodeId, 2u, "Trace 2 did not provide the expected node index");
+
+  m_newValue = 0;
+  node1->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -3, "Trace 1 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_nodeId, 1u, "Trace 1 did not provide the expected node index");
+
+  m_newValue = 0;
+  node0->SetAttribute ("Source", IntegerValue (-4));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 0 fired unexpectedly");
+
+  Config::DisconnectWithNodeId ("/NodeList/2/Source", cb);
+  node2->SetAttribute ("Source", IntegerValue (-5));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 2 fired after disconnection");
+  node1->SetAttribute ("Source", IntegerValue (-6));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -6, "Trace 1 did not fire as expected");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * Test for the ability to search attributes of parent classes
@@ -848,6 +963,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new NodeIdTraceConfigTestCase);
 }
 
 /**
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+#include "ns3/test.h"
+
+#include <set>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup events
+ * EventImpl storage pool test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * An event of a size class no other code is expected to use.
+ */
+class PoolTestEvent : public EventImpl
+{
+public:
+  char m_payload[200];  //!< Padding to the chosen size class.
+protected:
+  virtual void Notify (void)
+  {
+  }
+};
+
+/** A batch of events. */
+typedef std::vector<EventImpl *> PoolTestEvents;
+
+/** Events allocated or released at once; well above the per-thread cache. */
+static const uint32_t g_poolTestEvents = 1024;
+/** Upper bound on the free blocks a thread keeps per size class. */
+static const uint32_t g_poolTestThreadCache = 128;
+
+/**
+ * Thread body: allocate g_poolTestEvents events.
+ * \param [in,out] events The allocated events.
+ */
+static void
+PoolTestAllocate (PoolTestEvents *events)
+{
+  for (uint32_t i = 0; i < g_poolTestEvents; ++i)
+    {
+      events->push_back (new PoolTestEvent ());
+    }
+}
+
+/**
+ * Thread body: release events.
+ * \param [in,out] events The events to release; cleared.
+ */
+static void
+PoolTestRelease (PoolTestEvents *events)
+{
+  for (PoolTestEvents::iterator it = events->begin (); it != events->end (); ++it)
+    {
+      delete *it;
+    }
+  events->clear ();
+}
+
+/**
+ * Thread body: allocate twice g_poolTestEvents events.
+ * \param [in,out] events The allocated events.
+ */
+static void
+PoolTestAllocateTwice (PoolTestEvents *events)
+{
+  PoolTestAllocate (events);
+  PoolTestAllocate (events);
+}
+
+/**
+ * Thread body: allocate then release g_poolTestEvents events.
+ * \param [in,out] events The addresses of the events, no longer valid.
+ */
+static void
+PoolTestAllocateAndRelease (PoolTestEvents *events)
+{
+  PoolTestAllocate (events);
+  PoolTestEvents released (*events);
+  PoolTestRelease (&released);
+}
+
+/**
+ * Run a function in a new thread and wait for it to exit.
+ * \param [in] f The thread body.
+ * \param [in,out] events The argument of the thread body.
+ */
+static void
+PoolTestRunThread (void (*f)(PoolTestEvents *), PoolTestEvents *events)
+{
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (f, events));
+  thread->Start ();
+  thread->Join ();
+}
+
+/**
+ * Count the events stored at one of the given addresses.
+ * \param [in] events The events to check.
+ * \param [in] addresses The addresses.
+ * \returns The number of events found.
+ */
+static uint32_t
+PoolTestCountReused (const PoolTestEvents &events, const PoolTestEvents &addresses)
+{
+  std::set<EventImpl *> known (addresses.begin (), addresses.end ());
+  uint32_t reused = 0;
+  for (PoolTestEvents::const_iterator it = events.begin (); it != events.end (); ++it)
+    {
+      reused += known.count (*it);
+    }
+  return reused;
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that storage released by another thread is reused by a third one.
+ */
+class EventImplPoolCrossThreadTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  EventImplPoolCrossThreadTestCase ();
+  virtual void DoRun (void);
+};
+
+EventImplPoolCrossThreadTestCase::EventImplPoolCrossThreadTestCase ()
+  : TestCase ("Check that events released by another thread are reused")
+{
+}
+
+void
+EventImplPoolCrossThreadTestCase::DoRun (void)
+{
+  PoolTestEvents produced;
+  PoolTestRunThread (&PoolTestAllocate, &produced);
+  PoolTestEvents addresses (produced);
+
+  // This thread releases them all, far more than it keeps for itself.
+  PoolTestRelease (&produced);
+
+  PoolTestEvents consumed;
+  PoolTestRunThread (&PoolTestAllocate, &consumed);
+  uint32_t reused = PoolTestCountReused (consumed, addresses);
+  PoolTestRelease (&consumed);
+
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (reused, g_poolTestEvents - g_poolTestThreadCache,
+                               "Storage released by the main thread not reused");
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that the storage a thread holds is reused after it exits.
+ */
+class EventImplPoolThreadExitTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  EventImplPoolThreadExitTestCase ();
+  virtual void DoRun (void);
+};
+
+EventImplPoolThreadExitTestCase::EventImplPoolThreadExitTestCase ()
+  : TestCase ("Check that the events of an exited thread are reused")
+{
+}
+
+void
+EventImplPoolThreadExitTestCase::DoRun (void)
+{
+  PoolTestEvents exited;
+  PoolTestRunThread (&PoolTestAllocateAndRelease, &exited);
+
+  // Every block the first thread released, including those it still
+  // held when it exited, is handed out again before new slabs are cut.
+  PoolTestEvents consumed;
+  PoolTestRunThread (&PoolTestAllocateTwice, &consumed);
+  uint32_t reused = PoolTestCountReused (exited, consumed);
+  PoolTestRelease (&consumed);
+
+  NS_TEST_ASSERT_MSG_EQ (reused, g_poolTestEvents,
+                         "Storage held by an exited thread not reused");
+}
+
+
+/**
+ * \ingroup core-tests
+ * EventImpl storage pool test suite.
+ */
+class EventImplPoolTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  EventImplPoolTestSuite ()
+    : TestSuite ("event-impl-pool")
+  {
+#ifdef EVENT_IMPL_POOL
+    AddTestCase (new EventImplPoolCrossThreadTestCase ());
+    AddTestCase (new EventImplPoolThreadExitTestCase ());
+#endif /* EVENT_IMPL_POOL */
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * EventImplPoolTestSuite instance variable.
+ */
+static EventImplPoolTestSuite g_eventImplPoolTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
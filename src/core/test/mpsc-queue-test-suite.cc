@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/mpsc-queue.h"
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+#include "ns3/test.h"
+
+#include <list>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup thread
+ * MpscQueue test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * Check FIFO order with a single thread.
+ */
+class MpscQueueFifoTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  MpscQueueFifoTestCase ();
+  virtual void DoRun (void);
+};
+
+MpscQueueFifoTestCase::MpscQueueFifoTestCase ()
+  : TestCase ("Check single-threaded MpscQueue FIFO order")
+{
+}
+
+void
+MpscQueueFifoTestCase::DoRun (void)
+{
+  MpscQueue<uint32_t> queue;
+  uint32_t value = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (queue.IsEmpty (), true, "New queue not empty");
+  NS_TEST_ASSERT_MSG_EQ (queue.Pop (value), false, "Pop from empty queue");
+
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      queue.Push (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.IsEmpty (), false, "Queue empty after Push");
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue.Pop (value), true, "Missing element");
+      NS_TEST_ASSERT_MSG_EQ (value, i, "Out of order element");
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.IsEmpty (), true, "Drained queue not empty");
+
+  // Leave some elements behind for the destructor.
+  queue.Push (1);
+  queue.Push (2);
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that no element is lost or reordered with concurrent producers.
+ */
+class MpscQueueProducersTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] producers The number of producer threads.
+   */
+  MpscQueueProducersTestCase (uint32_t producers);
+  virtual void DoRun (void);
+
+private:
+  /** Element: producer index and sequence number. */
+  typedef std::pair<uint32_t, uint32_t> Item;
+  /**
+   * Producer thread body.
+   * \param [in] context The test case and the producer index.
+   */
+  static void Produce (std::pair<MpscQueueProducersTestCase *, uint32_t> context);
+
+  uint32_t m_producers;      //!< Number of producer threads.
+  MpscQueue<Item> m_queue;   //!< The queue under test.
+};
+
+/** Elements pushed by each producer. */
+static const uint32_t g_itemsPerProducer = 20000;
+
+MpscQueueProducersTestCase::MpscQueueProducersTestCase (uint32_t producers)
+  : TestCase ("Check MpscQueue with " + std::to_string (producers) +
+              " producer threads"),
+    m_producers (producers)
+{
+}
+
+void
+MpscQueueProducersTestCase::Produce (std::pair<MpscQueueProducersTestCase *, uint32_t> context)
+{
+  for (uint32_t i = 0; i < g_itemsPerProducer; ++i)
+    {
+      context.first->m_queue.Push (Item (context.second, i));
+    }
+}
+
+void
+MpscQueueProducersTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t p = 0; p < m_producers; ++p)
+    {
+      threads.push_back (Create<SystemThread> (
+        MakeBoundCallback (&MpscQueueProducersTestCase::Produce,
+                           std::pair<MpscQueueProducersTestCase *, uint32_t> (this, p))));
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+
+  std::vector<uint32_t> next (m_producers, 0);
+  uint64_t expected = static_cast<uint64_t> (m_producers) * g_itemsPerProducer;
+  uint64_t received = 0;
+  bool ordered = true;
+  Item item;
+  while (received < expected)
+    {
+      if (m_queue.Pop (item))
+        {
+          ordered = ordered && (item.second == next[item.first]);
+          next[item.first] = item.second + 1;
+          ++received;
+        }
+    }
+
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (ordered, true, "Per-producer order not preserved");
+  NS_TEST_ASSERT_MSG_EQ (m_queue.IsEmpty (), true, "Unexpected extra elements");
+}
+
+
+/**
+ * \ingroup core-tests
+ * MpscQueue test suite.
+ */
+class MpscQueueTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  MpscQueueTestSuite ()
+    : TestSuite ("mpsc-queue")
+  {
+    AddTestCase (new MpscQueueFifoTestCase ());
+    AddTestCase (new MpscQueueProducersTestCase (1));
+    AddTestCase (new MpscQueueProducersTestCase (4));
+    AddTestCase (new MpscQueueProducersTestCase (16));
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * MpscQueueTestSuite instance variable.
+ */
+static MpscQueueTestSuite g_mpscQueueTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
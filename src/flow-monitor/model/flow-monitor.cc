@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include <fstream>
 #include <sstream>
 
@@ -69,6 +70,12 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxHistogramBins", ("The maximum number of bins of the delay and jitter histograms, "
+                                        "allocated at once for each flow. Longer delays and jitters are "
+                                        "counted in the last bin. Zero for no bound."),
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowMonitor::m_maxHistogramBins),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -102,6 +109,12 @@ FlowMonitor::DoDispose (void)
   Object::DoDispose ();
 }
 
+std::size_t
+FlowMonitor::TrackedPacketKeyHash::operator() (const TrackedPacketKey &key) const
+{
+  return std::hash<uint64_t> () ((static_cast<uint64_t> (key.first) << 32) | key.second);
+}
+
 inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
@@ -121,6 +134,11 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
       ref.timesForwarded = 0;
       ref.delayHistogram.SetDefaultBinWidth (m_delayBinWidth);
       ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
+      if (m_maxHistogramBins > 0)
+        {
+          ref.delayHistogram.SetMaxBins (m_maxHistogramBins);
+          ref.jitterHistogram.SetMaxBins (m_maxHistogramBins);
+        }
       ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
       ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
       return ref;
@@ -140,10 +158,12 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  TrackedPacketKey key (flowId, packetId);
+  TrackedPacket &tracked = m_trackedPackets[key];
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
+  m_expiryQueue.push_back (std::make_pair (now, key));
   NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
                                                                 << ").");
 
@@ -167,7 +187,7 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
+  TrackedPacketKey key (flowId, packetId);
   TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
   if (tracked == m_trackedPackets.end ())
     {
@@ -178,6 +198,7 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
 
   tracked->second.timesForwarded++;
   tracked->second.lastSeenTime = Simulator::Now ();
+  m_expiryQueue.push_back (std::make_pair (tracked->second.lastSeenTime, key));
 
   Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
@@ -290,25 +311,27 @@ FlowMonitor::GetFlowStats () const
 void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
-  Time now = Simulator::Now ();
+  Time expiry = Simulator::Now () - maxDelay;
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  // The queue is in increasing last seen time order, so only the packets
+  // at its front can be lost.
+  while (!m_expiryQueue.empty () && m_expiryQueue.front ().first <= expiry)
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
+      TrackedPacketMap::iterator tracked = m_trackedPackets.find (m_expiryQueue.front ().second);
+      // skip the packets already received or dropped, and the packets seen
+      // again since this entry was queued
+      if (tracked != m_trackedPackets.end ()
+          && tracked->second.lastSeenTime == m_expiryQueue.front ().first)
         {
           // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
+          FlowStatsContainerI flow = m_flowStats.find (tracked->first.first);
           NS_ASSERT (flow != m_flowStats.end ());
           flow->second.lostPackets++;
 
           // we won't track it anymore
-          m_trackedPackets.erase (iter++);
-        }
-      else
-        {
-          iter++;
+          m_trackedPackets.erase (tracked);
         }
+      m_expiryQueue.pop_front ();
     }
 }
 
@@ -23,6 +23,8 @@
 
 #include <vector>
 #include <map>
+#include <deque>
+#include <unordered_map>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
@@ -275,9 +277,22 @@ private:
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
+  /// Key of a tracked packet: (FlowId,PacketId)
+  typedef std::pair<FlowId, FlowPacketId> TrackedPacketKey;
+  /// Hash of a tracked packet key
+  struct TrackedPacketKeyHash
+  {
+    /// \param key the tracked packet key
+    /// \return the hash of the key
+    std::size_t operator() (const TrackedPacketKey &key) const;
+  };
   /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  typedef std::unordered_map<TrackedPacketKey, TrackedPacket, TrackedPacketKeyHash> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
+  /// (last seen time, (FlowId,PacketId)) of the tracked packets, in
+  /// increasing time order. A packet seen again gets a new entry, and
+  /// the outdated entries are skipped when they expire.
+  std::deque<std::pair<Time, TrackedPacketKey> > m_expiryQueue;
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
@@ -292,6 +307,7 @@ private:
   double m_packetSizeBinWidth;  //!< packet size bin width (for histograms)
   double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
   Time m_flowInterruptionsMinTime; //!< Flow interruptions minimum time
+  uint32_t m_maxHistogramBins; //!< Maximum number of bins of the delay and jitter histograms
 
   /// Get the stats for a given flow
   /// \param flowId the Flow identification
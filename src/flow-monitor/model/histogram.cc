@@ -19,6 +19,7 @@
 //
 
 #include <cmath>
+#include <algorithm>
 
 #include "histogram.h"
 #include "ns3/simulator.h"
@@ -41,7 +42,7 @@ NS_LOG_COMPONENT_DEFINE ("Histogram");
 uint32_t 
 Histogram::GetNBins () const
 {
-  return m_histogram.size ();
+  return m_nBins;
 }
 
 double 
@@ -65,14 +66,22 @@ Histogram::GetBinWidth (uint32_t index) const
 void 
 Histogram::SetDefaultBinWidth (double binWidth)
 {
-  NS_ASSERT (m_histogram.size () == 0); //we can only change the bin width if no values were added
+  NS_ASSERT (m_nBins == 0); //we can only change the bin width if no values were added
   m_binWidth = binWidth;
 }
 
+void
+Histogram::SetMaxBins (uint32_t maxBins)
+{
+  NS_ASSERT (m_nBins == 0); //we can only bound the bins if no values were added
+  m_maxBins = maxBins;
+  m_histogram.assign (maxBins, 0);
+}
+
 uint32_t 
 Histogram::GetBinCount (uint32_t index) 
 {
-  NS_ASSERT (index < m_histogram.size ());
+  NS_ASSERT (index < m_nBins);
   return m_histogram[index];
 }
 
@@ -84,19 +93,29 @@ Histogram::AddValue (double value)
   //check if we need to resize the vector
   NS_LOG_DEBUG ("AddValue: index=" << index << ", m_histogram.size()=" << m_histogram.size ());
 
-  if (index >= m_histogram.size ())
+  if (m_maxBins > 0)
+    {
+      // the bins are already allocated, count the overflow in the last one
+      index = std::min (index, m_maxBins - 1);
+    }
+  else if (index >= m_histogram.size ())
     {
       m_histogram.resize (index + 1, 0);
     }
   m_histogram[index]++;
+  m_nBins = std::max (m_nBins, index + 1);
 }
 
 Histogram::Histogram (double binWidth)
+  : m_nBins (0),
+    m_maxBins (0)
 {
   m_binWidth = binWidth;
 }
 
 Histogram::Histogram ()
+  : m_nBins (0),
+    m_maxBins (0)
 {
   m_binWidth = DEFAULT_BIN_WIDTH;
 }
@@ -105,12 +124,12 @@ void
 Histogram::SerializeToXmlStream (std::ostream &os, uint16_t indent, std::string elementName) const
 {
   os << std::string ( indent, ' ' ) << "<" << elementName // << " binWidth=\"" << m_binWidth << "\""
-     << " nBins=\"" << m_histogram.size () << "\""
+     << " nBins=\"" << m_nBins << "\""
      << " >\n";
   indent += 2;
 
 #if 1 // two alternative forms of representing bin data, one more verbose than the other one
-  for (uint32_t index = 0; index < m_histogram.size (); index++)
+  for (uint32_t index = 0; index < m_nBins; index++)
     {
       if (m_histogram[index])
         {
@@ -125,7 +144,7 @@ Histogram::SerializeToXmlStream (std::ostream &os, uint16_t indent, std::string
     }
 #else
   os << std::string ( indent+2, ' ' );
-  for (uint32_t index = 0; index < m_histogram.size (); index++)
+  for (uint32_t index = 0; index < m_nBins; index++)
     {
       if (index > 0)
         {
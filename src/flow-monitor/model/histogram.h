@@ -89,6 +89,19 @@ public:
    * \param binWidth the bin width
    */
   void SetDefaultBinWidth (double binWidth);
+
+  /**
+   * \brief Bound the number of bins.
+   *
+   * The bins are then allocated at once, in a fixed-size array, and the
+   * values beyond the last bin are counted in the last bin. By default
+   * (zero), the number of bins grows with the largest value added.
+   *
+   * Note that you can bound the number of bins only if the histogram is empty.
+   *
+   * \param maxBins the maximum number of bins, or zero for no bound
+   */
+  void SetMaxBins (uint32_t maxBins);
   /**
    * \brief Get the number of data added to the bin.
    * \param index the bin index
@@ -115,6 +128,8 @@ public:
 private:
   std::vector<uint32_t> m_histogram; //!< Histogram data
   double m_binWidth; //!< Bin width
+  uint32_t m_nBins; //!< Number of bins up to the last non-empty bin
+  uint32_t m_maxBins; //!< Maximum number of bins (0 for no bound)
 };
 
 
@@ -101,6 +101,18 @@ Ipv6FlowClassifier::Ipv6FlowClassifier ()
 {
 }
 
+std::size_t
+Ipv6FlowClassifier::FiveTupleHash::operator() (const FiveTuple &tuple) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t ports = (static_cast<uint64_t> (tuple.protocol) << 32)
+    | (static_cast<uint32_t> (tuple.sourcePort) << 16) | tuple.destinationPort;
+  uint64_t hash = addressHash (tuple.sourceAddress);
+  hash = hash * 0x9e3779b97f4a7c15ULL ^ addressHash (tuple.destinationAddress);
+  hash = hash * 0x9e3779b97f4a7c15ULL ^ ports;
+  return std::hash<uint64_t> () (hash);
+}
+
 bool
 Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPayload,
                               uint32_t *out_flowId, uint32_t *out_packetId)
@@ -149,35 +161,31 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
   tuple.destinationPort = dstPort;
 
   // try to insert the tuple, but check if it already exists
-  std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
-    = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
+  std::pair<std::unordered_map<FiveTuple, uint32_t, FiveTupleHash>::iterator, bool> insert
+    = m_flowMap.insert (std::make_pair (tuple, static_cast<uint32_t> (m_flows.size ())));
 
   // if the insertion succeeded, we need to assign this tuple a new flow identifier
   if (insert.second)
     {
-      FlowId newFlowId = GetNewFlowId ();
-      insert.first->second = newFlowId;
-      m_flowPktIdMap[newFlowId] = 0;
-      m_flowDscpMap[newFlowId];
+      FlowState flow;
+      flow.tuple = tuple;
+      flow.flowId = GetNewFlowId ();
+      flow.lastPacketId = 0;
+      std::fill (flow.dscpCounts, flow.dscpCounts + 64, 0);
+      m_flowIdMap[flow.flowId] = m_flows.size ();
+      m_flows.push_back (flow);
     }
   else
     {
-      m_flowPktIdMap[insert.first->second] ++;
+      m_flows[insert.first->second].lastPacketId++;
     }
+  FlowState &flow = m_flows[insert.first->second];
 
   // increment the counter of packets with the same DSCP value
-  Ipv6Header::DscpType dscp = ipHeader.GetDscp ();
-  std::pair<std::map<Ipv6Header::DscpType, uint32_t>::iterator, bool> dscpInserter
-    = m_flowDscpMap[insert.first->second].insert (std::pair<Ipv6Header::DscpType, uint32_t> (dscp, 1));
-
-  // if the insertion did not succeed, we need to increment the counter
-  if (!dscpInserter.second)
-    {
-      m_flowDscpMap[insert.first->second][dscp] ++;
-    }
+  flow.dscpCounts[ipHeader.GetDscp ()]++;
 
-  *out_flowId = insert.first->second;
-  *out_packetId = m_flowPktIdMap[*out_flowId];
+  *out_flowId = flow.flowId;
+  *out_packetId = flow.lastPacketId;
 
   return true;
 }
@@ -186,13 +194,10 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
 Ipv6FlowClassifier::FiveTuple
 Ipv6FlowClassifier::FindFlow (FlowId flowId) const
 {
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  std::unordered_map<FlowId, uint32_t>::const_iterator flow = m_flowIdMap.find (flowId);
+  if (flow != m_flowIdMap.end ())
     {
-      if (iter->second == flowId)
-        {
-          return iter->first;
-        }
+      return m_flows[flow->second].tuple;
     }
   NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
   FiveTuple retval = { Ipv6Address::GetZero (), Ipv6Address::GetZero (), 0, 0, 0 };
@@ -209,15 +214,22 @@ Ipv6FlowClassifier::SortByCount::operator() (std::pair<Ipv6Header::DscpType, uin
 std::vector<std::pair<Ipv6Header::DscpType, uint32_t> >
 Ipv6FlowClassifier::GetDscpCounts (FlowId flowId) const
 {
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
-    = m_flowDscpMap.find (flowId);
+  std::unordered_map<FlowId, uint32_t>::const_iterator flow = m_flowIdMap.find (flowId);
 
-  if (flow == m_flowDscpMap.end ())
+  if (flow == m_flowIdMap.end ())
     {
       NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
     }
 
-  std::vector<std::pair<Ipv6Header::DscpType, uint32_t> > v (flow->second.begin (), flow->second.end ());
+  const FlowState &state = m_flows[flow->second];
+  std::vector<std::pair<Ipv6Header::DscpType, uint32_t> > v;
+  for (uint32_t dscp = 0; dscp < 64; dscp++)
+    {
+      if (state.dscpCounts[dscp] > 0)
+        {
+          v.push_back (std::make_pair (static_cast<Ipv6Header::DscpType> (dscp), state.dscpCounts[dscp]));
+        }
+    }
   std::sort (v.begin (), v.end (), SortByCount ());
   return v;
 }
@@ -228,28 +240,33 @@ Ipv6FlowClassifier::SerializeToXmlStream (std::ostream &os, uint16_t indent) con
   Indent (os, indent); os << "<Ipv6FlowClassifier>\n";
 
   indent += 2;
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  // serialize the flows in five-tuple order
+  std::vector<std::pair<FiveTuple, uint32_t> > flows;
+  for (uint32_t i = 0; i < m_flows.size (); i++)
     {
+      flows.push_back (std::make_pair (m_flows[i].tuple, i));
+    }
+  std::sort (flows.begin (), flows.end ());
+  for (std::vector<std::pair<FiveTuple, uint32_t> >::const_iterator
+       iter = flows.begin (); iter != flows.end (); iter++)
+    {
+      const FlowState &flow = m_flows[iter->second];
       Indent (os, indent);
-      os << "<Flow flowId=\"" << iter->second << "\""
-         << " sourceAddress=\"" << iter->first.sourceAddress << "\""
-         << " destinationAddress=\"" << iter->first.destinationAddress << "\""
-         << " protocol=\"" << int(iter->first.protocol) << "\""
-         << " sourcePort=\"" << iter->first.sourcePort << "\""
-         << " destinationPort=\"" << iter->first.destinationPort << "\">\n";
+      os << "<Flow flowId=\"" << flow.flowId << "\""
+         << " sourceAddress=\"" << flow.tuple.sourceAddress << "\""
+         << " destinationAddress=\"" << flow.tuple.destinationAddress << "\""
+         << " protocol=\"" << int(flow.tuple.protocol) << "\""
+         << " sourcePort=\"" << flow.tuple.sourcePort << "\""
+         << " destinationPort=\"" << flow.tuple.destinationPort << "\">\n";
 
       indent += 2;
-      std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
-        = m_flowDscpMap.find (iter->second);
-
-      if (flow != m_flowDscpMap.end ())
+      for (uint32_t dscp = 0; dscp < 64; dscp++)
         {
-          for (std::map<Ipv6Header::DscpType, uint32_t>::const_iterator i = flow->second.begin (); i != flow->second.end (); i++)
+          if (flow.dscpCounts[dscp] > 0)
             {
               Indent (os, indent);
-              os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t> (i->first) << "\""
-                 << " packets=\"" << std::dec << i->second << "\" />\n";
+              os << "<Dscp value=\"0x" << std::hex << dscp << "\""
+                 << " packets=\"" << std::dec << flow.dscpCounts[dscp] << "\" />\n";
             }
         }
 
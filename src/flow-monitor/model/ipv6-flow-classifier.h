@@ -24,6 +24,8 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "ns3/ipv6-header.h"
 #include "ns3/flow-classifier.h"
@@ -93,12 +95,29 @@ public:
 
 private:
 
-  /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> > m_flowDscpMap;
+  /// Hash of a FiveTuple
+  struct FiveTupleHash
+  {
+    /// \param tuple the five-tuple
+    /// \return the hash of the five-tuple
+    std::size_t operator() (const FiveTuple &tuple) const;
+  };
+
+  /// Identifiers and packet counters of a flow
+  struct FlowState
+  {
+    FiveTuple tuple;            //!< the flow five-tuple
+    FlowId flowId;              //!< the flow identifier
+    FlowPacketId lastPacketId;  //!< the identifier of the last packet of the flow
+    uint32_t dscpCounts[64];    //!< number of packets seen with each DSCP value
+  };
+
+  /// Map to Flows Identifiers to indexes in m_flows
+  std::unordered_map<FiveTuple, uint32_t, FiveTupleHash> m_flowMap;
+  /// Map to FlowIds to indexes in m_flows
+  std::unordered_map<FlowId, uint32_t> m_flowIdMap;
+  /// Flows, in the order they were first seen
+  std::vector<FlowState> m_flows;
 
 };
 
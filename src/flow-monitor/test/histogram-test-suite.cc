@@ -78,6 +78,21 @@ HistogramTestCase::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (h0.GetNBins (), 22, "");
     NS_TEST_EXPECT_MSG_EQ (h0.GetBinCount (21), 1, "");
   }
+
+  Histogram h1 (0.5);
+  // Testing bounded bins
+  {
+    h1.SetMaxBins (4);
+    NS_TEST_EXPECT_MSG_EQ (h1.GetNBins (), 0, "");
+    h1.AddValue (0.7);
+    NS_TEST_EXPECT_MSG_EQ (h1.GetNBins (), 2, "");
+    NS_TEST_EXPECT_MSG_EQ (h1.GetBinCount (1), 1, "");
+    h1.AddValue (1.6);
+    h1.AddValue (12.0);
+    NS_TEST_EXPECT_MSG_EQ (h1.GetNBins (), 4, "");
+    NS_TEST_EXPECT_MSG_EQ (h1.GetBinCount (2), 0, "");
+    NS_TEST_EXPECT_MSG_EQ (h1.GetBinCount (3), 2, "the overflow goes to the last bin");
+  }
 }
 
 /**
@@ -0,0 +1,134 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * A row of mmWave eNBs, each serving a few UEs, distributed over MPI
+ * ranks: eNB i and its UEs run on rank i % (number of ranks), and the
+ * spectrum channels forward the inter-cell interference between ranks.
+ *
+ * Run with, e.g.:
+ *   mpirun -np 4 ./waf --run "mmwave-distributed-enbs --numEnb=8"
+ * and compare the wall clock time printed by rank 0 with -np 1.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mpi-interface.h"
+#include <ns3/buildings-helper.h>
+#include "ns3/log.h"
+#include <chrono>
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+using namespace mmwave;
+
+int
+main (int argc, char *argv[])
+{
+#ifdef NS3_MPI
+  uint32_t numEnb = 4;
+  uint32_t numUePerEnb = 2;
+  double interSiteDistance = 100.0;
+  double simTime = 0.1;
+
+  CommandLine cmd;
+  cmd.AddValue ("numEnb", "Number of eNBs", numEnb);
+  cmd.AddValue ("numUePerEnb", "Number of UEs attached to each eNB", numUePerEnb);
+  cmd.AddValue ("interSiteDistance", "Distance between two eNBs [m]", interSiteDistance);
+  cmd.AddValue ("simTime", "Simulation time [s]", simTime);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (&argc, &argv);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  Ptr<MmWaveHelper> ptr_mmWave = CreateObject<MmWaveHelper> ();
+  ptr_mmWave->SetAttribute ("SpectrumChannelType",
+                            StringValue ("ns3::MultiModelSpectrumRemoteChannel"));
+  ptr_mmWave->Initialize ();
+
+  // The whole topology is built on every rank, each cell on the rank
+  // given by its system id.  The helper gives the remote channels a
+  // propagation delay model, and a lookahead of that delay plus a slot.
+  NodeContainer enbNodes;
+  NodeContainer ueNodes;
+  std::vector<NodeContainer> cellUes (numEnb);
+  for (uint32_t i = 0; i < numEnb; i++)
+    {
+      enbNodes.Create (1, i % systemCount);
+      cellUes[i].Create (numUePerEnb, i % systemCount);
+      ueNodes.Add (cellUes[i]);
+    }
+
+  Ptr<ListPositionAllocator> enbPositionAlloc = CreateObject<ListPositionAllocator> ();
+  Ptr<ListPositionAllocator> uePositionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < numEnb; i++)
+    {
+      enbPositionAlloc->Add (Vector (i * interSiteDistance, 0.0, 10.0));
+      for (uint32_t j = 0; j < numUePerEnb; j++)
+        {
+          uePositionAlloc->Add (Vector (i * interSiteDistance, 20.0 + 10.0 * j, 1.5));
+        }
+    }
+
+  MobilityHelper enbmobility;
+  enbmobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  enbmobility.SetPositionAllocator (enbPositionAlloc);
+  enbmobility.Install (enbNodes);
+  BuildingsHelper::Install (enbNodes);
+
+  MobilityHelper uemobility;
+  uemobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  uemobility.SetPositionAllocator (uePositionAlloc);
+  uemobility.Install (ueNodes);
+  BuildingsHelper::Install (ueNodes);
+
+  NetDeviceContainer enbNetDev = ptr_mmWave->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueNetDev = ptr_mmWave->InstallUeDevice (ueNodes);
+
+  // The UEs are closer to their own eNB, which runs on the same rank
+  ptr_mmWave->AttachToClosestEnb (ueNetDev, enbNetDev);
+
+  enum EpsBearer::Qci q = EpsBearer::GBR_CONV_VOICE;
+  EpsBearer bearer (q);
+  ptr_mmWave->ActivateDataRadioBearer (ueNetDev, bearer);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  if (systemId == 0)
+    {
+      std::cout << numEnb << " eNBs on " << systemCount << " ranks: "
+                << elapsed << " s of wall clock time" << std::endl;
+    }
+
+  MpiInterface::Disable ();
+  return 0;
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
@@ -87,49 +87,46 @@ public:
 /**
  * Callback function for DL TX statistics for both RLC and PDCP
  * /param arg
- * /param path
  * /param rnti
  * /param lcid
  * /param packetSize
  */
 void
-DlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
+DlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg,
                  uint16_t rnti, uint8_t lcid, uint32_t packetSize)
 {
-  NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize);
+  NS_LOG_FUNCTION (arg->imsi << arg->cellId << rnti << (uint16_t)lcid << packetSize);
   arg->stats->DlTxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize);
 }
 
 /**
  * Callback function for DL RX statistics for both RLC and PDCP
  * /param arg
- * /param path
  * /param rnti
  * /param lcid
  * /param packetSize
  * /param delay
  */
 void
-DlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
+DlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg,
                  uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint64_t delay)
 {
-  NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize << delay);
+  NS_LOG_FUNCTION (arg->imsi << arg->cellId << rnti << (uint16_t)lcid << packetSize << delay);
   arg->stats->DlRxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize, delay);
 }
 
 /**
  * Callback function for UL TX statistics for both RLC and PDCP
  * /param arg
- * /param path
  * /param rnti
  * /param lcid
  * /param packetSize
  */
 void
-UlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
+UlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg,
                  uint16_t rnti, uint8_t lcid, uint32_t packetSize)
 {
-  NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize);
+  NS_LOG_FUNCTION (arg->imsi << arg->cellId << rnti << (uint16_t)lcid << packetSize);
 
   arg->stats->UlTxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize);
 }
@@ -137,33 +134,32 @@ UlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
 /**
  * Callback function for UL RX statistics for both RLC and PDCP
  * /param arg
- * /param path
  * /param rnti
  * /param lcid
  * /param packetSize
  * /param delay
  */
 void
-UlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
+UlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg,
                  uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint64_t delay)
 {
-  NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize << delay);
+  NS_LOG_FUNCTION (arg->imsi << arg->cellId << rnti << (uint16_t)lcid << packetSize << delay);
 
   arg->stats->UlRxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize, delay);
 }
 
 void
-SwitchToLteCallback (Ptr<McMmWaveBoundCallbackArgument> arg, std::string path, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+SwitchToLteCallback (Ptr<McMmWaveBoundCallbackArgument> arg, uint64_t imsi, uint16_t cellId, uint16_t rnti)
 {
-  NS_LOG_FUNCTION (path << rnti << cellId << imsi);
+  NS_LOG_FUNCTION (rnti << cellId << imsi);
 
   arg->stats->SwitchToLte (imsi, cellId, rnti);
 }
 
 void
-SwitchToMmWaveCallback (Ptr<McMmWaveBoundCallbackArgument> arg, std::string path, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+SwitchToMmWaveCallback (Ptr<McMmWaveBoundCallbackArgument> arg, uint64_t imsi, uint16_t cellId, uint16_t rnti)
 {
-  NS_LOG_FUNCTION (path << rnti << cellId << imsi);
+  NS_LOG_FUNCTION (rnti << cellId << imsi);
 
   arg->stats->SwitchToMmWave (imsi, cellId, rnti);
 }
@@ -321,9 +317,9 @@ MmWaveBearerStatsConnector::EnsureConnected ()
       Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/SwitchToMmWave",
            MakeBoundCallback (&MmWaveBearerStatsConnector::NotifySwitchToMmWaveUe, this));
       // mmWave SINR from RT, LTE SINR from the PHY callbacks
-      Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/NotifyMmWaveSinr",
+      Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteEnbRrc/NotifyMmWaveSinr",
           MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyMmWaveSinr, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteUePhy/ReportCurrentCellRsrpSinr",
+      Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUePhy/ReportCurrentCellRsrpSinr",
                    MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyLteSinr, this));
       m_connected = true;
     }
@@ -402,7 +398,7 @@ MmWaveBearerStatsConnector::NotifySecondaryMmWaveEnbAvailable (MmWaveBearerStats
 }
 
 void
-MmWaveBearerStatsConnector::NotifyMmWaveSinr (MmWaveBearerStatsConnector* c, std::string context, uint64_t imsi, uint16_t cellId, long double sinr)
+MmWaveBearerStatsConnector::NotifyMmWaveSinr (MmWaveBearerStatsConnector* c, uint64_t imsi, uint16_t cellId, long double sinr)
 {
   c->PrintMmWaveSinr (imsi, cellId, sinr);
 }
@@ -415,11 +411,11 @@ MmWaveBearerStatsConnector::PrintMmWaveSinr (uint64_t imsi, uint16_t cellId, lon
   {
     m_mmWaveSinrOutFile.open(GetMmWaveSinrOutputFilename() .c_str());
   }
-  m_mmWaveSinrOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << cellId << " " << 10*std::log10(sinr) << std::endl;
+  m_mmWaveSinrOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << cellId << " " << 10*std::log10(sinr) << "\n";
 }
 
 void
-MmWaveBearerStatsConnector::NotifyLteSinr (MmWaveBearerStatsConnector* c, std::string context, uint16_t cellId, uint16_t rnti, double rsrp, double sinr, uint8_t cc)
+MmWaveBearerStatsConnector::NotifyLteSinr (MmWaveBearerStatsConnector* c, uint16_t cellId, uint16_t rnti, double rsrp, double sinr, uint8_t cc)
 {
   c->PrintLteSinr (rnti, cellId, sinr);
 }
@@ -432,7 +428,7 @@ MmWaveBearerStatsConnector::PrintLteSinr (uint16_t rnti, uint16_t cellId, double
   {
     m_lteSinrOutFile.open(GetLteSinrOutputFilename() .c_str());
   }
-  m_lteSinrOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << rnti << " " << cellId << " " << sinr << std::endl;
+  m_lteSinrOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << rnti << " " << cellId << " " << sinr << "\n";
 }
 
 std::string
@@ -601,29 +597,29 @@ MmWaveBearerStatsConnector::ConnectSrb0Traces (std::string context, uint64_t ims
       arg->stats = m_rlcStats;
 
       // diconnect eventually previously connected SRB0 both at UE and eNB
-      Config::Disconnect (ueRrcPath + "/Srb0/LteRlc/TxPDU",
+      Config::DisconnectWithoutContext (ueRrcPath + "/Srb0/LteRlc/TxPDU",
                           MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Disconnect (ueRrcPath + "/Srb0/LteRlc/RxPDU",
+      Config::DisconnectWithoutContext (ueRrcPath + "/Srb0/LteRlc/RxPDU",
                           MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Disconnect (ueManagerPath + "/Srb0/LteRlc/TxPDU",
+      Config::DisconnectWithoutContext (ueManagerPath + "/Srb0/LteRlc/TxPDU",
                           MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Disconnect (ueManagerPath + "/Srb0/LteRlc/RxPDU",
+      Config::DisconnectWithoutContext (ueManagerPath + "/Srb0/LteRlc/RxPDU",
                           MakeBoundCallback (&UlRxPduCallback, arg));
 
       // connect SRB0 both at UE and eNB
-      Config::Connect (ueRrcPath + "/Srb0/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (ueRrcPath + "/Srb0/LteRlc/TxPDU",
                        MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (ueRrcPath + "/Srb0/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (ueRrcPath + "/Srb0/LteRlc/RxPDU",
                        MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb0/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (ueManagerPath + "/Srb0/LteRlc/TxPDU",
                        MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb0/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (ueManagerPath + "/Srb0/LteRlc/RxPDU",
                        MakeBoundCallback (&UlRxPduCallback, arg));
 
       // connect SRB1 at eNB only (at UE SRB1 will be setup later)
-      Config::Connect (ueManagerPath + "/Srb1/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (ueManagerPath + "/Srb1/LteRlc/TxPDU",
                        MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb1/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (ueManagerPath + "/Srb1/LteRlc/RxPDU",
                        MakeBoundCallback (&UlRxPduCallback, arg));
 
       Config::Connect (ueManagerPath + "/SecondaryRlcCreated",
@@ -638,9 +634,9 @@ MmWaveBearerStatsConnector::ConnectSrb0Traces (std::string context, uint64_t ims
       arg->stats = m_pdcpStats;
 
       // connect SRB1 at eNB only (at UE SRB1 will be setup later)
-      Config::Connect (ueManagerPath + "/Srb1/LtePdcp/RxPDU",
+      Config::ConnectWithoutContext (ueManagerPath + "/Srb1/LtePdcp/RxPDU",
 		       MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb1/LtePdcp/TxPDU",
+      Config::ConnectWithoutContext (ueManagerPath + "/Srb1/LtePdcp/TxPDU",
 		       MakeBoundCallback (&DlTxPduCallback, arg));
     }
 }
@@ -727,9 +723,9 @@ MmWaveBearerStatsConnector::ConnectDrbTracesUe (std::string context, uint64_t im
       m_rlcDrbDlRxCb = MakeBoundCallback (&DlRxPduCallback, arg);
       m_rlcDrbUlTxCb = MakeBoundCallback (&UlTxPduCallback, arg);
 
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (basePath + "/DataRadioBearerMap/*/LteRlc/TxPDU",
            m_rlcDrbUlTxCb);
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (basePath + "/DataRadioBearerMap/*/LteRlc/RxPDU",
            m_rlcDrbDlRxCb);
 
     }
@@ -743,9 +739,9 @@ MmWaveBearerStatsConnector::ConnectDrbTracesUe (std::string context, uint64_t im
       m_pdcpDrbDlRxCb = MakeBoundCallback (&DlRxPduCallback, arg);
       m_pdcpDrbUlTxCb = MakeBoundCallback (&UlTxPduCallback, arg);
 
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
+      Config::ConnectWithoutContext (basePath + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
            m_pdcpDrbDlRxCb);
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LtePdcp/TxPDU",
+      Config::ConnectWithoutContext (basePath + "/DataRadioBearerMap/*/LtePdcp/TxPDU",
            m_pdcpDrbUlTxCb);
     }
 }
@@ -763,9 +759,9 @@ MmWaveBearerStatsConnector::ConnectSrb1TracesUe (std::string ueRrcPath, uint64_t
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
-      Config::Connect (basePath + "/Srb1/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (basePath + "/Srb1/LteRlc/TxPDU",
                        MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (basePath + "/Srb1/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (basePath + "/Srb1/LteRlc/RxPDU",
                        MakeBoundCallback (&DlRxPduCallback, arg));
     }
   if (m_pdcpStats)
@@ -774,18 +770,18 @@ MmWaveBearerStatsConnector::ConnectSrb1TracesUe (std::string ueRrcPath, uint64_t
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_pdcpStats;
-      Config::Connect (basePath + "/Srb1/LtePdcp/RxPDU",
+      Config::ConnectWithoutContext (basePath + "/Srb1/LtePdcp/RxPDU",
            MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (basePath + "/Srb1/LtePdcp/TxPDU",
+      Config::ConnectWithoutContext (basePath + "/Srb1/LtePdcp/TxPDU",
            MakeBoundCallback (&UlTxPduCallback, arg));
     }
   if(m_mcStats)
     {
       Ptr<McMmWaveBoundCallbackArgument> arg = Create<McMmWaveBoundCallbackArgument> ();
       arg->stats = m_mcStats;
-      Config::Connect (basePath + "/SwitchToLte",
+      Config::ConnectWithoutContext (basePath + "/SwitchToLte",
             MakeBoundCallback (&SwitchToLteCallback, arg));
-      Config::Connect (basePath + "/SwitchToMmWave",
+      Config::ConnectWithoutContext (basePath + "/SwitchToMmWave",
             MakeBoundCallback (&SwitchToMmWaveCallback, arg));
     }
 }
@@ -804,13 +800,13 @@ MmWaveBearerStatsConnector::ConnectSrb1TracesEnb (std::string context, uint64_t
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
-      Config::Connect (basePath.str () + "/Srb0/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/Srb0/LteRlc/RxPDU",
            MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb0/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/Srb0/LteRlc/TxPDU",
            MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/Srb1/LteRlc/RxPDU",
            MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/Srb1/LteRlc/TxPDU",
            MakeBoundCallback (&DlTxPduCallback, arg));
     }
   if (m_pdcpStats)
@@ -819,9 +815,9 @@ MmWaveBearerStatsConnector::ConnectSrb1TracesEnb (std::string context, uint64_t
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_pdcpStats;
-      Config::Connect (basePath.str () + "/Srb1/LtePdcp/TxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/Srb1/LtePdcp/TxPDU",
            MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LtePdcp/RxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/Srb1/LtePdcp/RxPDU",
            MakeBoundCallback (&UlRxPduCallback, arg));
     }
 }
@@ -839,9 +835,9 @@ MmWaveBearerStatsConnector::ConnectDrbTracesEnb (std::string context, uint64_t i
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/DataRadioBearerMap/*/LteRlc/RxPDU",
            MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/DataRadioBearerMap/*/LteRlc/TxPDU",
            MakeBoundCallback (&DlTxPduCallback, arg));
     }
   if (m_pdcpStats)
@@ -850,9 +846,9 @@ MmWaveBearerStatsConnector::ConnectDrbTracesEnb (std::string context, uint64_t i
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_pdcpStats;
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LtePdcp/TxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/DataRadioBearerMap/*/LtePdcp/TxPDU",
            MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
+      Config::ConnectWithoutContext (basePath.str () + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
            MakeBoundCallback (&UlRxPduCallback, arg));
     }
 }
@@ -870,9 +866,9 @@ MmWaveBearerStatsConnector::DisconnectTracesUe (std::string context, uint64_t im
     {
       Ptr<McMmWaveBoundCallbackArgument> arg = Create<McMmWaveBoundCallbackArgument> ();
       arg->stats = m_mcStats;
-      Config::Disconnect (basePath + "/SwitchToLte",
+      Config::DisconnectWithoutContext (basePath + "/SwitchToLte",
           MakeBoundCallback (&SwitchToLteCallback, arg));
-      Config::Disconnect (basePath + "/SwitchToMmWave",
+      Config::DisconnectWithoutContext (basePath + "/SwitchToMmWave",
           MakeBoundCallback (&SwitchToMmWaveCallback, arg));
   }
 }
@@ -890,8 +886,8 @@ MmWaveBearerStatsConnector::DisconnectDrbTracesUe (std::string context, uint64_t
       Config::MatchContainer rlc_container = Config::LookupMatches(basePath +  "/DataRadioBearerMap/*/LteRlc/");
       NS_LOG_LOGIC ("Number of RLC to disconnect " << rlc_container.GetN());
 
-      rlc_container.Disconnect ("RxPDU",m_rlcDrbDlRxCb);
-      rlc_container.Disconnect ("TxPDU",m_rlcDrbUlTxCb);
+      rlc_container.DisconnectWithoutContext ("RxPDU",m_rlcDrbDlRxCb);
+      rlc_container.DisconnectWithoutContext ("TxPDU",m_rlcDrbUlTxCb);
     }
 
   if (m_pdcpStats)
@@ -899,8 +895,8 @@ MmWaveBearerStatsConnector::DisconnectDrbTracesUe (std::string context, uint64_t
       Config::MatchContainer pdcp_container = Config::LookupMatches(basePath +  "/DataRadioBearerMap/*/LtePdcp/");
       NS_LOG_LOGIC ("Number of PDCP to disconnect " << pdcp_container.GetN());
 
-      pdcp_container.Disconnect ("RxPDU",m_pdcpDrbDlRxCb);
-      pdcp_container.Disconnect ("TxPDU",m_pdcpDrbUlTxCb);
+      pdcp_container.DisconnectWithoutContext ("RxPDU",m_pdcpDrbDlRxCb);
+      pdcp_container.DisconnectWithoutContext ("TxPDU",m_pdcpDrbUlTxCb);
     }
 }
 
@@ -928,9 +924,9 @@ MmWaveBearerStatsConnector::ConnectSecondaryTracesUe (std::string context, uint6
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
       // for MC devices
-      Config::Connect (basePath + "/DataRadioRlcMap/*/TxPDU",
+      Config::ConnectWithoutContext (basePath + "/DataRadioRlcMap/*/TxPDU",
            MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (basePath + "/DataRadioRlcMap/*/RxPDU",
+      Config::ConnectWithoutContext (basePath + "/DataRadioRlcMap/*/RxPDU",
            MakeBoundCallback (&DlRxPduCallback, arg));
     }
 }
@@ -952,9 +948,9 @@ MmWaveBearerStatsConnector::ConnectSecondaryTracesEnb (std::string context, uint
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
       // for MC devices
-      Config::Connect (basePath.str() + "/DataRadioRlcMap/*/LteRlc/RxPDU",
+      Config::ConnectWithoutContext (basePath.str() + "/DataRadioRlcMap/*/LteRlc/RxPDU",
            MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str() + "/DataRadioRlcMap/*/LteRlc/TxPDU",
+      Config::ConnectWithoutContext (basePath.str() + "/DataRadioRlcMap/*/LteRlc/TxPDU",
            MakeBoundCallback (&DlTxPduCallback, arg));
     }
 }
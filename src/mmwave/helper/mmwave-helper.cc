@@ -44,6 +44,8 @@
 #include "mmwave-helper.h"
 #include <ns3/abort.h>
 #include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/multi-model-spectrum-remote-channel.h>
+#include <ns3/propagation-delay-model.h>
 #include <ns3/uinteger.h>
 #include <ns3/double.h>
 #include <ns3/ipv4.h>
@@ -132,6 +134,13 @@ MmWaveHelper::GetTypeId (void)
 					   StringValue ("ns3::MmWaveBeamforming"),
 					   MakeStringAccessor (&MmWaveHelper::SetChannelModelType),
 					   MakeStringChecker ())
+		.AddAttribute ("SpectrumChannelType",
+					   "The type of spectrum channel to be used for both the mmWave "
+					   "and the LTE channels. Use ns3::MultiModelSpectrumRemoteChannel "
+					   "to distribute the cells over MPI ranks.",
+					   StringValue ("ns3::MultiModelSpectrumChannel"),
+					   MakeStringAccessor (&MmWaveHelper::SetSpectrumChannelType),
+					   MakeStringChecker ())
 		.AddAttribute ("Scheduler",
 				      "The type of scheduler to be used for MmWave eNBs. "
 				      "The allowed values for this attributes are the type names "
@@ -346,6 +355,13 @@ MmWaveHelper::MmWaveChannelModelInitialization (void)
 	{
 		Ptr<SpectrumChannel> channel = m_channelFactory.Create<SpectrumChannel> ();
 		Ptr<MmWavePhyMacCommon> phyMacCommon = m_componentCarrierPhyParams.at(it->first).GetConfigurationParameters();
+		if (DynamicCast<MultiModelSpectrumRemoteChannel> (channel) != 0)
+		{
+			// the lookahead of a channel spanning ranks is its smallest
+			// propagation delay plus a slot
+			channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+			channel->SetAttribute ("SlotDuration", TimeValue (Seconds (phyMacCommon->GetTti ())));
+		}
 
 		if (!m_pathlossModelType.empty ())
 		{
@@ -441,6 +457,14 @@ MmWaveHelper::LteChannelModelInitialization (void)
 	// setup of LTE channels & related
 	m_downlinkChannel = m_lteChannelFactory.Create<SpectrumChannel> ();
 	m_uplinkChannel = m_lteChannelFactory.Create<SpectrumChannel> ();
+	if (DynamicCast<MultiModelSpectrumRemoteChannel> (m_downlinkChannel) != 0)
+	{
+		// an LTE TTI lasts one subframe
+		m_downlinkChannel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+		m_downlinkChannel->SetAttribute ("SlotDuration", TimeValue (MilliSeconds (1)));
+		m_uplinkChannel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+		m_uplinkChannel->SetAttribute ("SlotDuration", TimeValue (MilliSeconds (1)));
+	}
 	m_downlinkPathlossModel = m_dlPathlossModelFactory.Create ();
 	Ptr<SpectrumPropagationLossModel> dlSplm = m_downlinkPathlossModel->GetObject<SpectrumPropagationLossModel> ();
 	if (dlSplm != 0)
@@ -516,6 +540,14 @@ MmWaveHelper::SetChannelModelType (std::string type)
 	m_channelModelType = type;
 }
 
+void
+MmWaveHelper::SetSpectrumChannelType (std::string type)
+{
+	NS_LOG_FUNCTION (this << type);
+	m_channelFactory.SetTypeId (type);
+	m_lteChannelFactory.SetTypeId (type);
+}
+
 void
 MmWaveHelper::SetSchedulerType (std::string type)
 {
@@ -2950,11 +2982,11 @@ MmWaveHelper::EnableDlPhyTrace (void)
 	//		MakeBoundCallback (&MmWavePhyRxTrace::ReportCurrentCellRsrpSinrCallback, m_phyStats));
 
  // regulare mmWave UE device
-	Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+	Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
 			MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceUeCallback, m_phyStats));
 
  // MC ue device
-	Config::Connect ("/NodeList/*/DeviceList/*/MmWaveComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+	Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/MmWaveComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
 			MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceUeCallback, m_phyStats));
 }
 
@@ -2962,7 +2994,7 @@ void
 MmWaveHelper::EnableUlPhyTrace (void)
 {
 	NS_LOG_FUNCTION_NOARGS ();
-	Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
+	Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
 			MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceEnbCallback, m_phyStats));
 }
 
@@ -2970,7 +3002,7 @@ void
 MmWaveHelper::EnableEnbPacketCountTrace ()
 {
 	NS_LOG_FUNCTION_NOARGS ();
-	Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/ReportEnbTxRxPacketCount",
+	Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/ReportEnbTxRxPacketCount",
 			MakeBoundCallback (&MmWavePhyRxTrace::ReportPacketCountEnbCallback, m_phyStats));
 
 }
@@ -2979,7 +3011,7 @@ void
 MmWaveHelper::EnableUePacketCountTrace ()
 {
 	NS_LOG_FUNCTION_NOARGS ();
-	Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/ReportUeTxRxPacketCount",
+	Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/ReportUeTxRxPacketCount",
 			MakeBoundCallback (&MmWavePhyRxTrace::ReportPacketCountUeCallback, m_phyStats));
 
 }
@@ -2988,7 +3020,7 @@ void
 MmWaveHelper::EnableTransportBlockTrace ()
 {
 	NS_LOG_FUNCTION_NOARGS ();
-	Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/ReportDownlinkTbSize",
+	Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/ReportDownlinkTbSize",
 				MakeBoundCallback (&MmWavePhyRxTrace::ReportDownLinkTBSize, m_phyStats));
 }
 
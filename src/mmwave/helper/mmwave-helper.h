@@ -121,6 +121,12 @@ public:
 	void SetAntenna (uint16_t Nrx, uint16_t Ntx);
 	void SetPathlossModelType (std::string type);
 	void SetChannelModelType (std::string type);
+	/**
+	 * Set the type of the mmWave and LTE spectrum channels.
+	 *
+	 * \param type the type of a class inheriting from ns3::SpectrumChannel
+	 */
+	void SetSpectrumChannelType (std::string type);
 	void SetLtePathlossModelType (std::string type);
 
 	/**
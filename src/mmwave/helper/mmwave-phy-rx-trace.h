@@ -49,16 +49,16 @@ public:
 	MmWavePhyRxTrace();
 	virtual ~MmWavePhyRxTrace();
 	static TypeId GetTypeId (void);
-	static void ReportCurrentCellRsrpSinrCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
+	static void ReportCurrentCellRsrpSinrCallback (Ptr<MmWavePhyRxTrace> phyStats,
 						uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power);
-	static void ReportPacketCountUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
+	static void ReportPacketCountUeCallback (Ptr<MmWavePhyRxTrace> phyStats,
 			UePhyPacketCountParameter param);
-	static void ReportPacketCountEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
+	static void ReportPacketCountEnbCallback (Ptr<MmWavePhyRxTrace> phyStats,
 			EnbPhyPacketCountParameter param);
-	static void ReportDownLinkTBSize (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
+	static void ReportDownLinkTBSize (Ptr<MmWavePhyRxTrace> phyStats,
 			uint64_t imsi, uint64_t tbSize);
-	static void RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
-	static void RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
+	static void RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, RxPacketTraceParams param);
+	static void RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, RxPacketTraceParams param);
 	void SetOutputFilename( std::string fileName);
 
 private:
@@ -389,6 +389,12 @@ MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
 				// Do nothing
 			}
 		}
+		else
+		{
+			// A signal of another kind, e.g. forwarded by another rank
+			// through a MultiModelSpectrumRemoteChannel, only interferes
+			m_interferenceData->AddSignal (params->psd, params->duration);
+		}
 	}
 }
 
@@ -0,0 +1,137 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark for the Ns2MobilityHelper with large traces.
+ *
+ * A synthetic ns-2 trace is written, like the ones SUMO exports for a large
+ * number of vehicles, with one setdest command per node and per second. The
+ * trace is installed either scheduling all events at install time (eager
+ * mode), streaming it into the simulation (streaming mode) or converting it
+ * into a binary trace first (binary mode), and the install time, the run time
+ * and the peak memory use of the process are reported. Run each mode in its
+ * own process to compare the peak memory, e.g.:
+ *   ./waf --run "ns2-mobility-bench --nodes=2000 --duration=600 --mode=eager"
+ *   ./waf --run "ns2-mobility-bench --nodes=2000 --duration=600 --mode=streaming"
+ *   ./waf --run "ns2-mobility-bench --nodes=2000 --duration=600 --mode=binary"
+ */
+
+#include <fstream>
+#include <chrono>
+#include <sys/resource.h>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/ns2-mobility-helper.h"
+#include "ns3/binary-mobility-helper.h"
+
+using namespace ns3;
+
+/// Number of course changes
+static uint64_t g_courseChanges = 0;
+
+/// Count a course change
+static void
+CourseChange (Ptr<const MobilityModel> mobility)
+{
+  g_courseChanges++;
+}
+
+/// Get the wall clock time in seconds since a start time
+static double
+Elapsed (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 1000;
+  uint32_t duration = 300;
+  std::string mode = "streaming";
+  std::string traceFile = "ns2-mobility-bench.ns_movements";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes in the trace", nodes);
+  cmd.AddValue ("duration", "Trace duration (s), with one waypoint per second", duration);
+  cmd.AddValue ("mode", "Install mode: eager, streaming or binary", mode);
+  cmd.AddValue ("traceFile", "Name of the synthetic trace file to write", traceFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (mode != "eager" && mode != "streaming" && mode != "binary", "Invalid mode " << mode);
+
+  // Write the synthetic trace, with the commands sorted by time as SUMO does
+  std::ofstream trace (traceFile.c_str ());
+  NS_ABORT_MSG_IF (!trace.is_open (), "Could not write trace file " << traceFile);
+  for (uint32_t n = 0; n < nodes; n++)
+    {
+      trace << "$node_(" << n << ") set X_ " << n % 100 * 10.0 << "\n"
+            << "$node_(" << n << ") set Y_ " << n / 100 * 10.0 << "\n";
+    }
+  for (uint32_t t = 1; t <= duration; t++)
+    {
+      for (uint32_t n = 0; n < nodes; n++)
+        {
+          double x = (n % 100) * 10.0 + (t % 2 ? 5.0 : 0.0);
+          double y = (n / 100) * 10.0 + (t % 4 < 2 ? 0.0 : 5.0);
+          trace << "$ns_ at " << t << ".0 \"$node_(" << n << ") setdest "
+                << x << " " << y << " " << 10.0 << "\"\n";
+        }
+    }
+  trace.close ();
+
+  NodeContainer container;
+  container.Create (nodes);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Ns2MobilityHelper ns2 = Ns2MobilityHelper (traceFile);
+  std::string binaryFile = traceFile + ".bin";
+  double convertTime = 0;
+  if (mode == "binary")
+    {
+      ns2.WriteBinaryTrace (binaryFile);
+      convertTime = Elapsed (start);
+      start = std::chrono::steady_clock::now ();
+      BinaryMobilityHelper binary (binaryFile);
+      binary.Install ();
+    }
+  else
+    {
+      ns2.SetStreaming (mode == "streaming");
+      ns2.Install ();
+    }
+  double installTime = Elapsed (start);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::MobilityModel/CourseChange",
+                                 MakeCallback (&CourseChange));
+
+  start = std::chrono::steady_clock::now ();
+  Simulator::Stop (Seconds (duration + 1));
+  Simulator::Run ();
+  double runTime = Elapsed (start);
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  std::cout << "mode: " << mode << ", nodes: " << nodes
+            << ", trace commands: " << static_cast<uint64_t> (nodes) * duration << std::endl
+            << "convert time: " << convertTime << " s, install time: " << installTime << " s, run time: " << runTime
+            << " s, peak RSS: " << usage.ru_maxrss / 1024 << " MB"
+            << ", course changes: " << g_courseChanges << std::endl;
+
+  Simulator::Destroy ();
+  std::remove (traceFile.c_str ());
+  std::remove (binaryFile.c_str ());
+  return 0;
+}
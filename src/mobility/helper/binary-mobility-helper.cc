@@ -0,0 +1,367 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/waypoint-mobility-model.h"
+#include "binary-mobility-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryMobilityHelper");
+
+/// Binary mobility trace file magic
+static const char g_binaryTraceMagic[8] = "NS3MOBT";
+/// Binary mobility trace file format version
+static const uint32_t g_binaryTraceVersion = 1;
+/// Distance under which a segment start is at the current node position (m)
+static const double g_positionTolerance = 1e-6;
+
+/**
+ * A binary mobility trace file mapped in memory. It is shared by the nodes
+ * still following the trace, and unmapped when the last one is done.
+ */
+class BinaryMobilityTrace : public SimpleRefCount<BinaryMobilityTrace>
+{
+public:
+  /**
+   * Map a binary mobility trace file, checking its header and size.
+   * \param filename The trace file name.
+   */
+  BinaryMobilityTrace (std::string filename);
+  ~BinaryMobilityTrace ();
+
+  /** \return The number of entries in the node table. */
+  uint32_t GetNNodes (void) const;
+  /**
+   * \param i The node table index.
+   * \return The node table entry.
+   */
+  const BinaryMobilityTraceNode & GetNode (uint32_t i) const;
+  /**
+   * \param i The segment index.
+   * \return The segment.
+   */
+  const BinaryMobilityTraceSegment & GetSegment (uint64_t i) const;
+
+private:
+  void *m_data;                               //!< Mapped file
+  size_t m_size;                              //!< Mapped file size
+  const BinaryMobilityTraceHeader *m_header;  //!< File header
+  const BinaryMobilityTraceNode *m_nodes;     //!< Node table
+  const BinaryMobilityTraceSegment *m_segments; //!< Segment arrays
+};
+
+BinaryMobilityTrace::BinaryMobilityTrace (std::string filename)
+  : m_data (MAP_FAILED),
+    m_size (0)
+{
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << filename << " for reading");
+    }
+  struct stat st;
+  if (fstat (fd, &st) == 0 && st.st_size >= static_cast<off_t> (sizeof (BinaryMobilityTraceHeader)))
+    {
+      m_size = st.st_size;
+      m_data = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+  close (fd);
+  if (m_data == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("Could not map trace file " << filename);
+    }
+
+  const uint8_t *data = static_cast<const uint8_t *> (m_data);
+  m_header = reinterpret_cast<const BinaryMobilityTraceHeader *> (data);
+  m_nodes = reinterpret_cast<const BinaryMobilityTraceNode *> (data + sizeof (BinaryMobilityTraceHeader));
+  m_segments = reinterpret_cast<const BinaryMobilityTraceSegment *> (m_nodes + m_header->m_nodes);
+  if (std::memcmp (m_header->m_magic, g_binaryTraceMagic, sizeof (g_binaryTraceMagic)) != 0
+      || m_header->m_version != g_binaryTraceVersion)
+    {
+      NS_FATAL_ERROR ("Trace file " << filename << " is not a binary mobility trace (version " <<
+                      g_binaryTraceVersion << ")");
+    }
+  uint64_t size = sizeof (BinaryMobilityTraceHeader)
+    + m_header->m_nodes * sizeof (BinaryMobilityTraceNode)
+    + m_header->m_segments * sizeof (BinaryMobilityTraceSegment);
+  if (size != m_size)
+    {
+      NS_FATAL_ERROR ("Trace file " << filename << " has " << m_size << " bytes instead of " << size);
+    }
+}
+
+BinaryMobilityTrace::~BinaryMobilityTrace ()
+{
+  munmap (m_data, m_size);
+}
+
+uint32_t
+BinaryMobilityTrace::GetNNodes (void) const
+{
+  return m_header->m_nodes;
+}
+
+const BinaryMobilityTraceNode &
+BinaryMobilityTrace::GetNode (uint32_t i) const
+{
+  return m_nodes[i];
+}
+
+const BinaryMobilityTraceSegment &
+BinaryMobilityTrace::GetSegment (uint64_t i) const
+{
+  return m_segments[i];
+}
+
+/**
+ * Cursor into the segments of a node with a ConstantVelocityMobilityModel.
+ * Only the next segment of each node is scheduled.
+ */
+struct BinaryMobilityCursor : public SimpleRefCount<BinaryMobilityCursor>
+{
+  Ptr<const BinaryMobilityTrace> m_trace;     //!< Mapped trace
+  Ptr<ConstantVelocityMobilityModel> m_model; //!< Node mobility model
+  uint64_t m_next;                            //!< Next segment index
+  uint64_t m_end;                             //!< Index after the last segment of the node
+  Time m_origin;                              //!< Simulation time of the trace time zero
+};
+
+/**
+ * \param segment A segment.
+ * \return The segment start position.
+ */
+static Vector
+GetPosition (const BinaryMobilityTraceSegment &segment)
+{
+  return Vector (segment.m_position[0], segment.m_position[1], segment.m_position[2]);
+}
+
+/**
+ * \param segment A segment.
+ * \return The segment velocity.
+ */
+static Vector
+GetVelocity (const BinaryMobilityTraceSegment &segment)
+{
+  return Vector (segment.m_velocity[0], segment.m_velocity[1], segment.m_velocity[2]);
+}
+
+/**
+ * \param segment A segment.
+ * \param time A trace time, not before the segment start.
+ * \return The position along the segment at this time.
+ */
+static Vector
+GetPositionAt (const BinaryMobilityTraceSegment &segment, double time)
+{
+  double elapsed = time - segment.m_time;
+  return Vector (segment.m_position[0] + segment.m_velocity[0] * elapsed,
+                 segment.m_position[1] + segment.m_velocity[1] * elapsed,
+                 segment.m_position[2] + segment.m_velocity[2] * elapsed);
+}
+
+/**
+ * Get the simulation delay until a trace time.
+ * \param origin The simulation time of the trace time zero.
+ * \param time The trace time.
+ * \return The delay (never negative).
+ */
+static Time
+DelayTo (Time origin, double time)
+{
+  Time delay = origin + Seconds (time) - Simulator::Now ();
+  return delay.IsStrictlyNegative () ? Time (0) : delay;
+}
+
+/**
+ * Start the next segment of a node, and schedule the following one.
+ * \param cursor The node cursor.
+ */
+static void
+BinaryMobilityNext (Ptr<BinaryMobilityCursor> cursor)
+{
+  const BinaryMobilityTraceSegment &segment = cursor->m_trace->GetSegment (cursor->m_next++);
+  Vector position = GetPosition (segment);
+  if (CalculateDistance (cursor->m_model->GetPosition (), position) > g_positionTolerance)
+    {
+      cursor->m_model->SetPosition (position);
+    }
+  cursor->m_model->SetVelocity (GetVelocity (segment));
+
+  if (cursor->m_next < cursor->m_end)
+    {
+      Simulator::Schedule (DelayTo (cursor->m_origin, cursor->m_trace->GetSegment (cursor->m_next).m_time),
+                           &BinaryMobilityNext, cursor);
+    }
+}
+
+
+BinaryMobilityHelper::BinaryMobilityHelper (std::string filename)
+  : m_filename (filename),
+    m_startTime (Seconds (0))
+{
+}
+
+void
+BinaryMobilityHelper::SetStartTime (Time start)
+{
+  m_startTime = start;
+}
+
+void
+BinaryMobilityHelper::Install (void) const
+{
+  Install (NodeList::Begin (), NodeList::End ());
+}
+
+void
+BinaryMobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
+{
+  Ptr<BinaryMobilityTrace> trace = Create<BinaryMobilityTrace> (m_filename);
+  double start = m_startTime.GetSeconds ();
+  Time origin = Simulator::Now () - m_startTime;
+
+  for (uint32_t i = 0; i < trace->GetNNodes (); i++)
+    {
+      const BinaryMobilityTraceNode &node = trace->GetNode (i);
+      Ptr<Object> object = store.Get (node.m_nodeId);
+      if (object == 0)
+        {
+          NS_LOG_ERROR ("Unknown node ID (corrupted file?): " << node.m_nodeId);
+          continue;
+        }
+      if (node.m_segments == 0)
+        {
+          continue;
+        }
+
+      // Binary search for the current segment of the node: the last one
+      // starting at or before the start time, if any.
+      const BinaryMobilityTraceSegment *first = &trace->GetSegment (node.m_first);
+      const BinaryMobilityTraceSegment *last = first + node.m_segments;
+      const BinaryMobilityTraceSegment *next = std::upper_bound (
+          first, last, start,
+          [] (double time, const BinaryMobilityTraceSegment &segment) { return time < segment.m_time; });
+      Vector position;
+      Vector velocity;
+      if (next == first)
+        {
+          position = GetPosition (*first);
+        }
+      else
+        {
+          position = GetPositionAt (*(next - 1), start);
+          velocity = GetVelocity (*(next - 1));
+        }
+
+      Ptr<WaypointMobilityModel> waypoints = object->GetObject<WaypointMobilityModel> ();
+      if (waypoints != 0)
+        {
+          Time now = Simulator::Now ();
+          waypoints->AddWaypoint (Waypoint (now, position));
+          Time lastTime = now;
+          for (; next != last; ++next)
+            {
+              Time time = origin + Seconds (next->m_time);
+              if (time > lastTime)
+                {
+                  waypoints->AddWaypoint (Waypoint (time, GetPosition (*next)));
+                  lastTime = time;
+                }
+            }
+          continue;
+        }
+
+      Ptr<ConstantVelocityMobilityModel> model = object->GetObject<ConstantVelocityMobilityModel> ();
+      if (model == 0)
+        {
+          model = CreateObject<ConstantVelocityMobilityModel> ();
+          object->AggregateObject (model);
+        }
+      model->SetPosition (position);
+      model->SetVelocity (velocity);
+      if (next != last)
+        {
+          Ptr<BinaryMobilityCursor> cursor = Create<BinaryMobilityCursor> ();
+          cursor->m_trace = trace;
+          cursor->m_model = model;
+          cursor->m_next = node.m_first + (next - first);
+          cursor->m_end = node.m_first + node.m_segments;
+          cursor->m_origin = origin;
+          Simulator::Schedule (DelayTo (origin, next->m_time), &BinaryMobilityNext, cursor);
+        }
+    }
+}
+
+void
+BinaryMobilityHelper::Write (std::string filename,
+                             const std::map<uint32_t, std::vector<BinaryMobilityTraceSegment> > &segments)
+{
+  std::ofstream file (filename.c_str (), std::ios::out | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << filename << " for writing");
+    }
+
+  BinaryMobilityTraceHeader header;
+  std::memcpy (header.m_magic, g_binaryTraceMagic, sizeof (g_binaryTraceMagic));
+  header.m_version = g_binaryTraceVersion;
+  header.m_nodes = segments.size ();
+  header.m_segments = 0;
+  for (auto const &it : segments)
+    {
+      header.m_segments += it.second.size ();
+    }
+  file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+
+  uint64_t first = 0;
+  for (auto const &it : segments)
+    {
+      BinaryMobilityTraceNode node;
+      node.m_nodeId = it.first;
+      node.m_segments = it.second.size ();
+      node.m_first = first;
+      file.write (reinterpret_cast<const char *> (&node), sizeof (node));
+      first += it.second.size ();
+    }
+
+  for (auto const &it : segments)
+    {
+      NS_ASSERT_MSG (std::is_sorted (it.second.begin (), it.second.end (),
+                                     [] (const BinaryMobilityTraceSegment &a, const BinaryMobilityTraceSegment &b)
+                                     { return a.m_time < b.m_time; }),
+                     "Segments of node " << it.first << " are not sorted by time");
+      file.write (reinterpret_cast<const char *> (it.second.data ()),
+                  it.second.size () * sizeof (BinaryMobilityTraceSegment));
+    }
+  file.close ();
+}
+
+} // namespace ns3
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef BINARY_MOBILITY_HELPER_H
+#define BINARY_MOBILITY_HELPER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ * \brief Header of a binary mobility trace file.
+ */
+struct BinaryMobilityTraceHeader
+{
+  char m_magic[8];        //!< File magic, "NS3MOBT"
+  uint32_t m_version;     //!< File format version
+  uint32_t m_nodes;       //!< Number of entries in the node table
+  uint64_t m_segments;    //!< Total number of segments
+};
+
+/**
+ * \ingroup mobility
+ * \brief Node table entry of a binary mobility trace file.
+ */
+struct BinaryMobilityTraceNode
+{
+  uint32_t m_nodeId;      //!< Node id in the trace
+  uint32_t m_segments;    //!< Number of segments of the node
+  uint64_t m_first;       //!< Index of the first segment of the node
+};
+
+/**
+ * \ingroup mobility
+ * \brief Segment of a binary mobility trace file: from its time on, and up
+ * to the time of the next segment of the same node, the node moves from the
+ * position with constant velocity.
+ */
+struct BinaryMobilityTraceSegment
+{
+  double m_time;          //!< Segment start time (s)
+  double m_position[3];   //!< Position at the segment start (m)
+  double m_velocity[3];   //!< Velocity along the segment (m/s)
+};
+
+/**
+ * \ingroup mobility
+ * \brief Helper class which reads binary mobility traces and configures
+ * nodes mobility.
+ *
+ * A binary mobility trace stores, for each node, the array of segments of
+ * its piecewise constant velocity movement, sorted by time. The file is made
+ * of a BinaryMobilityTraceHeader, followed by the node table (one
+ * BinaryMobilityTraceNode per node, sorted by node id) and by the segment
+ * arrays of all nodes, in the byte order of the host which wrote it.
+ *
+ * Binary traces are created from ns-2 traces with
+ * Ns2MobilityHelper::WriteBinaryTrace, or from any other source with Write.
+ * The file is mapped in memory at install time, so no text is parsed, and
+ * the segments are used in place. The per node segment arrays are the time
+ * index of the trace: the simulation can start from any time of the trace
+ * (see SetStartTime), with a binary search of the current segment of each
+ * node.
+ *
+ * Nodes with a WaypointMobilityModel get one waypoint for each segment,
+ * added at install time. The waypoint model interpolates between segments,
+ * so position jumps in the trace become short movements, and a node moving
+ * at the end of the trace stops at the start of its last segment. Other
+ * nodes get a ConstantVelocityMobilityModel (created if needed, as with the
+ * Ns2MobilityHelper), and only the next segment of each node is scheduled
+ * at a time.
+ */
+class BinaryMobilityHelper
+{
+public:
+  /**
+   * \param filename filename of file which contains the binary
+   *        mobility trace.
+   */
+  BinaryMobilityHelper (std::string filename);
+
+  /**
+   * \param start the trace time to start from.
+   *
+   * The trace time start is mapped to the simulation time of Install, so
+   * the simulation resumes the trace from there. It is zero by default.
+   */
+  void SetStartTime (Time start);
+
+  /**
+   * Read the binary trace file and configure the movement
+   * patterns of all nodes contained in the global ns3::NodeList
+   * whose nodeId is matches the nodeId of the nodes in the trace
+   * file.
+   */
+  void Install (void) const;
+
+  /**
+   * \param begin an iterator which points to the start of the input
+   *        object array.
+   * \param end an iterator which points to the end of the input
+   *        object array.
+   *
+   * Read the binary trace file and configure the movement
+   * patterns of all input objects. Each input object
+   * is identified by a unique node id which reflects
+   * the index of the object in the input array.
+   */
+  template <typename T>
+  void Install (T begin, T end) const;
+
+  /**
+   * Write a binary mobility trace.
+   * \param filename the file to write.
+   * \param segments the segments of each node, sorted by time.
+   */
+  static void Write (std::string filename,
+                     const std::map<uint32_t, std::vector<BinaryMobilityTraceSegment> > &segments);
+
+private:
+  /**
+   * \brief a class to hold input objects internally
+   */
+  class ObjectStore
+  {
+public:
+    virtual ~ObjectStore () {}
+    /**
+     * Return ith object in store
+     * \param i index
+     * \return pointer to object
+     */
+    virtual Ptr<Object> Get (uint32_t i) const = 0;
+  };
+  /**
+   * Maps the binary trace file to configure the mobility of the nodes
+   * \param store Object store containing ns-3 mobility models
+   */
+  void ConfigNodesMovements (const ObjectStore &store) const;
+  std::string m_filename; //!< filename of file containing the binary trace
+  Time m_startTime;       //!< trace time to start from
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+template <typename T>
+void
+BinaryMobilityHelper::Install (T begin, T end) const
+{
+  class MyObjectStore : public ObjectStore
+  {
+public:
+    MyObjectStore (T begin, T end)
+      : m_begin (begin),
+        m_end (end)
+    {}
+    virtual Ptr<Object> Get (uint32_t i) const {
+      T iterator = m_begin;
+      iterator += i;
+      if (iterator >= m_end)
+        {
+          return 0;
+        }
+      return *iterator;
+    }
+private:
+    T m_begin;
+    T m_end;
+  };
+  ConfigNodesMovements (MyObjectStore (begin, end));
+}
+
+} // namespace ns3
+
+#endif /* BINARY_MOBILITY_HELPER_H */
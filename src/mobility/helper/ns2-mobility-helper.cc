@@ -43,13 +43,18 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <deque>
+#include <vector>
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/unused.h"
 #include "ns3/simulator.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/node-list.h"
 #include "ns3/node.h"
 #include "ns3/constant-velocity-mobility-model.h"
 #include "ns2-mobility-helper.h"
+#include "binary-mobility-helper.h"
 
 namespace ns3 {
 
@@ -102,6 +107,55 @@ struct DestinationPoint
   {};
 };
 
+/**
+ * A scheduled movement command parsed from the trace, either a setdest or a
+ * set position statement.
+ */
+struct Ns2Command
+{
+  double m_at;                //!< Command time
+  bool m_setdest;             //!< True for setdest, false for set position
+  Vector m_destination;       //!< Destination for setdest
+  double m_speed;             //!< Speed for setdest
+  char m_coord;               //!< Coordinate (X, Y or Z) for set position
+  double m_value;             //!< Coordinate value for set position
+};
+
+/**
+ * Cursor into the movement commands of a node, used when streaming the trace.
+ * Only the next command of each node is scheduled, and the commands are
+ * released as they are executed.
+ */
+struct Ns2NodeCursor : public SimpleRefCount<Ns2NodeCursor>
+{
+  Ptr<ConstantVelocityMobilityModel> m_model; //!< Node mobility model
+  int m_nodeId;                       //!< Node id in the trace
+  DestinationPoint m_last;            //!< Last movement scheduled
+  std::deque<Ns2Command> m_commands;  //!< Commands not yet executed
+};
+
+/**
+ * Movement event of a node, computed without scheduling it to convert the
+ * trace into a binary trace.
+ */
+struct Ns2OfflineEvent
+{
+  double m_at;          //!< Event time
+  bool m_setPosition;   //!< True to set the position, false to set the velocity
+  Vector m_value;       //!< New position or velocity
+  bool m_cancelled;     //!< Cancelled by a later command
+};
+
+/**
+ * Movement of a node computed without scheduling it, like the
+ * DestinationPoint of the last movement and the events scheduled for it.
+ */
+struct Ns2OfflineNode
+{
+  Vector m_initial;                     //!< Initial position
+  std::vector<Ns2Command> m_commands;   //!< Commands, in file order
+  std::vector<Ns2OfflineEvent> m_events; //!< Events, in scheduling order
+};
 
 /**
  * Parses a line of ns2 mobility
@@ -167,11 +221,50 @@ static bool IsSchedSetPos (ParseResult pr);
  */
 static bool IsSchedMobilityPos (ParseResult pr);
 
+/**
+ * Parse a scheduled movement command, checking its time and format.
+ * \param pr The parsed line.
+ * \param line The trace line, for logging.
+ * \param command The command to fill.
+ * \return true if the line has a valid command.
+ */
+static bool ParseNs2Command (const ParseResult &pr, const std::string &line, Ns2Command &command);
+
+/**
+ * Schedule the events of a movement command for a node.
+ * \param model The node mobility model.
+ * \param last The last movement scheduled for the node, updated.
+ * \param command The command.
+ * \param nodeId The node id, for logging.
+ * \param offset The time the command times are relative to.
+ */
+static void ApplyNs2Command (Ptr<ConstantVelocityMobilityModel> model, DestinationPoint &last,
+                             const Ns2Command &command, int nodeId, Time offset);
+
+/**
+ * Execute the next commands of a node streaming the trace, and schedule
+ * this function again for the following command.
+ */
+static void Ns2StreamNext (Ptr<Ns2NodeCursor> cursor);
+
+/**
+ * Get the delay until a trace time, relative to an offset (never negative).
+ */
+static Time DelayTo (double at, Time offset);
+
+/**
+ * Compute the events of the commands of a node, as ApplyNs2Command would
+ * schedule them, and replay them into segments of constant velocity.
+ * \param node The node initial position and commands.
+ * \return The node segments.
+ */
+static std::vector<BinaryMobilityTraceSegment> GetOfflineSegments (Ns2OfflineNode &node);
+
 /**
  * Set waypoints and speed for movement.
  */
 static DestinationPoint SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector lastPos, double at,
-                                     Vector finalPosition, double speed);
+                                     Vector finalPosition, double speed, Time offset);
 
 /**
  * Set initial position for a node
@@ -181,11 +274,13 @@ static Vector SetInitialPosition (Ptr<ConstantVelocityMobilityModel> model, std:
 /**
  * Schedule a set of position for a node
  */
-static Vector SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at, std::string coord, double coordVal);
+static Vector SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at, std::string coord, double coordVal,
+                               Time offset);
 
 
 Ns2MobilityHelper::Ns2MobilityHelper (std::string filename)
-  : m_filename (filename)
+  : m_filename (filename),
+    m_streaming (false)
 {
   std::ifstream file (m_filename.c_str (), std::ios::in);
   if (!(file.is_open ())) NS_FATAL_ERROR("Could not open trace file " << m_filename.c_str() << " for reading, aborting here \n");
@@ -213,9 +308,21 @@ Ns2MobilityHelper::GetMobilityModel (std::string idString, const ObjectStore &st
 }
 
 
+void
+Ns2MobilityHelper::SetStreaming (bool streaming)
+{
+  m_streaming = streaming;
+}
+
 void
 Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 {
+  if (m_streaming)
+    {
+      ConfigNodesStreaming (store);
+      return;
+    }
+
   std::map<int, DestinationPoint> last_pos;    // Stores previous movement scheduled for each node
 
   //*****************************************************************
@@ -356,93 +463,173 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 
           else // NOW EVENTS TO BE SCHEDULED
             {
-
-              // This is a scheduled event, so time at should be present
-              double at;
-
-              if (!IsNumber (pr.tokens[2]))
+              Ns2Command command;
+              if (ParseNs2Command (pr, line, command))
                 {
-                  NS_LOG_WARN ("Time is not a number: " << pr.tokens[2]);
-                  continue;
+                  ApplyNs2Command (model, last_pos[iNodeId], command, iNodeId, Time (0));
                 }
+            }
+        }
+      file.close ();
+    }
+}
 
-              at = pr.dvals[2]; // set time at
 
-              if ( at < 0 )
-                {
-                  NS_LOG_WARN ("Time is less than cero: " << at);
-                  continue;
-                }
+void
+Ns2MobilityHelper::ConfigNodesStreaming (const ObjectStore &store) const
+{
+  std::map<int, Ptr<Ns2NodeCursor> > cursors;  // Commands not yet executed for each node
 
+  // Parse the file a single time. Initial positions are set right away, as
+  // they may be at the end of the file, and scheduled commands are saved
+  // for each node, in file order, to be scheduled one at a time.
+  std::ifstream file (m_filename.c_str (), std::ios::in);
+  if (file.is_open ())
+    {
+      while (!file.eof () )
+        {
+          int         iNodeId = 0;
+          std::string nodeId;
+          std::string line;
 
-              /*
-               * In this case a new waypoint is added
-               * line like $ns_ at 1 "$node_(0) setdest 2 3 4" for 2D destination, or
-               * line like $ns_ at 2 "$node_(0) setdest 2 3 4 5" for 3D destination
-               */
-              if (IsSchedMobilityPos (pr))
-                {
-                  if (last_pos[iNodeId].m_targetArrivalTime > at)
-                    {
-                      NS_LOG_LOGIC ("Did not reach a destination! stoptime = " << last_pos[iNodeId].m_targetArrivalTime << ", at = "<<  at);
-                      double actuallytraveled = at - last_pos[iNodeId].m_travelStartTime;
-                      Vector reached = Vector (
-                          last_pos[iNodeId].m_startPosition.x + last_pos[iNodeId].m_speed.x * actuallytraveled,
-                          last_pos[iNodeId].m_startPosition.y + last_pos[iNodeId].m_speed.y * actuallytraveled,
-                          last_pos[iNodeId].m_startPosition.z + last_pos[iNodeId].m_speed.z * actuallytraveled
-                          );
-                      NS_LOG_LOGIC ("Final point = " << last_pos[iNodeId].m_finalPosition << ", actually reached = " << reached);
-                      last_pos[iNodeId].m_stopEvent.Cancel ();
-                      last_pos[iNodeId].m_finalPosition = reached;
-                    }
-                  Vector finalPosition;
-                  double speed;
-                  finalPosition.x =  pr.dvals[5];
-                  finalPosition.y = pr.dvals[6];
-                  if (pr.tokens.size () == 9) //Destination is a 3D coordinate
-                  {
-                    finalPosition.z = pr.dvals[7];
-                    speed = pr.dvals[8];
-                  }
-                  else                        //The default 2D coordinate case
-                  {
-                    finalPosition.z = 0;
-                    speed = pr.dvals[7];
-                  }
-                  //                                                        last position   time coord vector  velocity
-                  last_pos[iNodeId] = SetMovement (model, last_pos[iNodeId].m_finalPosition, at, finalPosition, speed);
-
-                  // Log new position
-                  NS_LOG_DEBUG ("Positions after scheduled movement parse for node " << iNodeId << " " << nodeId << " position= " << last_pos[iNodeId].m_finalPosition);
-                }
+          getline (file, line);
+
+          // ignore empty lines
+          if (line.empty ())
+            {
+              continue;
+            }
+
+          ParseResult pr = ParseNs2Line (line); // Parse line and obtain tokens
 
+          // Check if the line corresponds with one of the four types of lines
+          if (pr.tokens.size () != 4 && pr.tokens.size () != 7 && pr.tokens.size () != 8 && pr.tokens.size () != 9)
+            {
+              NS_LOG_ERROR ("Line has not correct number of parameters (corrupted file?): " << line << "\n");
+              continue;
+            }
 
-              /*
-               * Scheduled set position
-               * line like $ns_ at 4.634906291962 "$node_(0) set X_ 28.675920486450"
-               */
-              else if (IsSchedSetPos (pr))
+          // Get the node Id
+          nodeId  = GetNodeIdString (pr);
+          iNodeId = GetNodeIdInt (pr);
+          if (iNodeId == -1)
+            {
+              NS_LOG_ERROR ("Node number couldn't be obtained (corrupted file?): " << line << "\n");
+              continue;
+            }
+
+          // get mobility model of node
+          Ptr<ConstantVelocityMobilityModel> model = GetMobilityModel (nodeId,store);
+
+          // if model not exists, continue
+          if (model == 0)
+            {
+              NS_LOG_ERROR ("Unknown node ID (corrupted file?): " << nodeId << "\n");
+              continue;
+            }
+
+          Ptr<Ns2NodeCursor> &cursor = cursors[iNodeId];
+          if (cursor == 0)
+            {
+              cursor = Create<Ns2NodeCursor> ();
+              cursor->m_model = model;
+              cursor->m_nodeId = iNodeId;
+            }
+
+          if (IsSetInitialPos (pr))
+            {
+              cursor->m_last = DestinationPoint ();
+              cursor->m_last.m_finalPosition = SetInitialPosition (model, pr.tokens[2], pr.dvals[3]);
+              NS_LOG_DEBUG ("Positions after initial position parse for node " << iNodeId << " " << nodeId <<
+                            " position= " << cursor->m_last.m_finalPosition);
+            }
+          else
+            {
+              Ns2Command command;
+              if (ParseNs2Command (pr, line, command))
                 {
-                  //                                                                        last position vector time  coordinate   coord value
-                  last_pos[iNodeId].m_finalPosition = SetSchedPosition (model, last_pos[iNodeId].m_finalPosition, at, pr.tokens[5], pr.dvals[6]);
-                  if (last_pos[iNodeId].m_targetArrivalTime > at)
-                    {
-                      last_pos[iNodeId].m_stopEvent.Cancel ();
-                    }
-                  last_pos[iNodeId].m_targetArrivalTime = at;
-                  last_pos[iNodeId].m_travelStartTime = at;
-                  // Log new position
-                  NS_LOG_DEBUG ("Position after scheduled position parse for node " << iNodeId << " " << nodeId <<
-                                " position= " << last_pos[iNodeId].m_finalPosition);
+                  cursor->m_commands.push_back (command);
                 }
-              else
+            }
+        }
+      file.close ();
+    }
+
+  // Schedule only the first command of each node.
+  for (auto const &it : cursors)
+    {
+      if (!it.second->m_commands.empty ())
+        {
+          Simulator::Schedule (DelayTo (it.second->m_commands.front ().m_at, Simulator::Now ()),
+                               &Ns2StreamNext, it.second);
+        }
+    }
+}
+
+
+void
+Ns2MobilityHelper::WriteBinaryTrace (std::string filename) const
+{
+  std::map<uint32_t, Ns2OfflineNode> nodes;
+
+  std::ifstream file (m_filename.c_str (), std::ios::in);
+  if (file.is_open ())
+    {
+      while (!file.eof () )
+        {
+          int         iNodeId = 0;
+          std::string line;
+
+          getline (file, line);
+
+          // ignore empty lines
+          if (line.empty ())
+            {
+              continue;
+            }
+
+          ParseResult pr = ParseNs2Line (line); // Parse line and obtain tokens
+
+          // Check if the line corresponds with one of the four types of lines
+          if (pr.tokens.size () != 4 && pr.tokens.size () != 7 && pr.tokens.size () != 8 && pr.tokens.size () != 9)
+            {
+              NS_LOG_ERROR ("Line has not correct number of parameters (corrupted file?): " << line << "\n");
+              continue;
+            }
+
+          // Get the node Id
+          iNodeId = GetNodeIdInt (pr);
+          if (iNodeId == -1)
+            {
+              NS_LOG_ERROR ("Node number couldn't be obtained (corrupted file?): " << line << "\n");
+              continue;
+            }
+
+          // Initial positions are set before any command is scheduled,
+          // wherever they are in the file
+          Ns2OfflineNode &node = nodes[iNodeId];
+          if (IsSetInitialPos (pr))
+            {
+              node.m_initial = SetOneInitialCoord (node.m_initial, pr.tokens[2], pr.dvals[3]);
+            }
+          else
+            {
+              Ns2Command command;
+              if (ParseNs2Command (pr, line, command))
                 {
-                  NS_LOG_WARN ("Format Line is not correct: " << line << "\n");
+                  node.m_commands.push_back (command);
                 }
             }
         }
       file.close ();
     }
+
+  std::map<uint32_t, std::vector<BinaryMobilityTraceSegment> > segments;
+  for (auto &it : nodes)
+    {
+      segments[it.first] = GetOfflineSegments (it.second);
+    }
+  BinaryMobilityHelper::Write (filename, segments);
 }
 
 
@@ -752,9 +939,251 @@ IsSchedMobilityPos (ParseResult pr)
 
 }
 
+bool
+ParseNs2Command (const ParseResult &pr, const std::string &line, Ns2Command &command)
+{
+  // This is a scheduled event, so time at should be present
+  if (!IsNumber (pr.tokens[2]))
+    {
+      NS_LOG_WARN ("Time is not a number: " << pr.tokens[2]);
+      return false;
+    }
+
+  command.m_at = pr.dvals[2]; // set time at
+
+  if ( command.m_at < 0 )
+    {
+      NS_LOG_WARN ("Time is less than cero: " << command.m_at);
+      return false;
+    }
+
+  /*
+   * In this case a new waypoint is added
+   * line like $ns_ at 1 "$node_(0) setdest 2 3 4" for 2D destination, or
+   * line like $ns_ at 2 "$node_(0) setdest 2 3 4 5" for 3D destination
+   */
+  if (IsSchedMobilityPos (pr))
+    {
+      command.m_setdest = true;
+      command.m_destination.x = pr.dvals[5];
+      command.m_destination.y = pr.dvals[6];
+      if (pr.tokens.size () == 9) //Destination is a 3D coordinate
+        {
+          command.m_destination.z = pr.dvals[7];
+          command.m_speed = pr.dvals[8];
+        }
+      else                        //The default 2D coordinate case
+        {
+          command.m_destination.z = 0;
+          command.m_speed = pr.dvals[7];
+        }
+      return true;
+    }
+
+  /*
+   * Scheduled set position
+   * line like $ns_ at 4.634906291962 "$node_(0) set X_ 28.675920486450"
+   */
+  if (IsSchedSetPos (pr))
+    {
+      command.m_setdest = false;
+      command.m_coord = pr.tokens[5][0];
+      command.m_value = pr.dvals[6];
+      return true;
+    }
+
+  NS_LOG_WARN ("Format Line is not correct: " << line << "\n");
+  return false;
+}
+
+void
+ApplyNs2Command (Ptr<ConstantVelocityMobilityModel> model, DestinationPoint &last,
+                 const Ns2Command &command, int nodeId, Time offset)
+{
+  double at = command.m_at;
+  if (command.m_setdest)
+    {
+      if (last.m_targetArrivalTime > at)
+        {
+          NS_LOG_LOGIC ("Did not reach a destination! stoptime = " << last.m_targetArrivalTime << ", at = "<<  at);
+          double actuallytraveled = at - last.m_travelStartTime;
+          Vector reached = Vector (
+              last.m_startPosition.x + last.m_speed.x * actuallytraveled,
+              last.m_startPosition.y + last.m_speed.y * actuallytraveled,
+              last.m_startPosition.z + last.m_speed.z * actuallytraveled
+              );
+          NS_LOG_LOGIC ("Final point = " << last.m_finalPosition << ", actually reached = " << reached);
+          last.m_stopEvent.Cancel ();
+          last.m_finalPosition = reached;
+        }
+      //                                 last position   time coord vector  velocity
+      last = SetMovement (model, last.m_finalPosition, at, command.m_destination, command.m_speed, offset);
+
+      // Log new position
+      NS_LOG_DEBUG ("Positions after scheduled movement parse for node " << nodeId << " position= " << last.m_finalPosition);
+    }
+  else
+    {
+      std::string coord = std::string (1, command.m_coord) + "_";
+      //                                                last position vector time  coordinate   coord value
+      last.m_finalPosition = SetSchedPosition (model, last.m_finalPosition, at, coord, command.m_value, offset);
+      if (last.m_targetArrivalTime > at)
+        {
+          last.m_stopEvent.Cancel ();
+        }
+      last.m_targetArrivalTime = at;
+      last.m_travelStartTime = at;
+      // Log new position
+      NS_LOG_DEBUG ("Position after scheduled position parse for node " << nodeId <<
+                    " position= " << last.m_finalPosition);
+    }
+}
+
+void
+Ns2StreamNext (Ptr<Ns2NodeCursor> cursor)
+{
+  // Execute all commands of this node for the current time (or for an
+  // earlier time, when the node commands are not sorted in the trace).
+  double at = cursor->m_commands.front ().m_at;
+  while (!cursor->m_commands.empty () && cursor->m_commands.front ().m_at <= at)
+    {
+      ApplyNs2Command (cursor->m_model, cursor->m_last, cursor->m_commands.front (),
+                       cursor->m_nodeId, Simulator::Now ());
+      cursor->m_commands.pop_front ();
+    }
+
+  if (!cursor->m_commands.empty ())
+    {
+      Simulator::Schedule (DelayTo (cursor->m_commands.front ().m_at, Simulator::Now ()),
+                           &Ns2StreamNext, cursor);
+    }
+}
+
+std::vector<BinaryMobilityTraceSegment>
+GetOfflineSegments (Ns2OfflineNode &node)
+{
+  // Same as the DestinationPoint of the last movement, with the index of
+  // the stop event instead of its EventId
+  struct
+  {
+    Vector m_startPosition;
+    Vector m_speed;
+    Vector m_finalPosition;
+    double m_travelStartTime;
+    double m_targetArrivalTime;
+    int64_t m_stopEvent;
+  } last = { Vector (), Vector (), node.m_initial, 0, 0, -1 };
+
+  for (auto const &command : node.m_commands)
+    {
+      double at = command.m_at;
+      if (command.m_setdest)
+        {
+          if (last.m_targetArrivalTime > at)
+            {
+              double actuallytraveled = at - last.m_travelStartTime;
+              last.m_finalPosition = Vector (
+                  last.m_startPosition.x + last.m_speed.x * actuallytraveled,
+                  last.m_startPosition.y + last.m_speed.y * actuallytraveled,
+                  last.m_startPosition.z + last.m_speed.z * actuallytraveled
+                  );
+              if (last.m_stopEvent >= 0)
+                {
+                  node.m_events[last.m_stopEvent].m_cancelled = true;
+                }
+            }
+
+          // As in SetMovement
+          Vector start = last.m_finalPosition;
+          last = { start, Vector (), start, at, at, -1 };
+          if (command.m_speed == 0)
+            {
+              last.m_stopEvent = node.m_events.size ();
+              node.m_events.push_back ({at, false, Vector (0, 0, 0), false});
+            }
+          else if (command.m_speed > 0)
+            {
+              Vector to = command.m_destination;
+              double time = std::sqrt (std::pow (to.x - start.x, 2) + std::pow (to.y - start.y, 2)
+                                       + std::pow (to.z - start.z, 2)) / command.m_speed;
+              if (time != 0)
+                {
+                  Vector velocity ((to.x - start.x) / time, (to.y - start.y) / time, (to.z - start.z) / time);
+                  node.m_events.push_back ({at, false, velocity, false});
+                  last.m_stopEvent = node.m_events.size ();
+                  node.m_events.push_back ({at + time, false, Vector (0, 0, 0), false});
+                  last.m_speed = velocity;
+                  last.m_finalPosition.x += velocity.x * time;
+                  last.m_finalPosition.y += velocity.y * time;
+                  last.m_finalPosition.z += velocity.z * time;
+                  last.m_targetArrivalTime += time;
+                }
+            }
+        }
+      else
+        {
+          // As in SetSchedPosition
+          std::string coord = std::string (1, command.m_coord) + "_";
+          last.m_finalPosition = SetOneInitialCoord (last.m_finalPosition, coord, command.m_value);
+          node.m_events.push_back ({at, true, last.m_finalPosition, false});
+          if (last.m_targetArrivalTime > at && last.m_stopEvent >= 0)
+            {
+              node.m_events[last.m_stopEvent].m_cancelled = true;
+            }
+          last.m_targetArrivalTime = at;
+          last.m_travelStartTime = at;
+        }
+    }
+
+  // Replay the events in the simulator order: by time, then by scheduling
+  // order. Events at the same time give a single segment.
+  std::stable_sort (node.m_events.begin (), node.m_events.end (),
+                    [] (const Ns2OfflineEvent &a, const Ns2OfflineEvent &b) { return a.m_at < b.m_at; });
+  std::vector<BinaryMobilityTraceSegment> segments;
+  double time = 0;
+  Vector position = node.m_initial;
+  Vector velocity;
+  segments.push_back ({0, {position.x, position.y, position.z}, {0, 0, 0}});
+  for (auto const &event : node.m_events)
+    {
+      if (event.m_cancelled)
+        {
+          continue;
+        }
+      double elapsed = event.m_at - time;
+      position.x += velocity.x * elapsed;
+      position.y += velocity.y * elapsed;
+      position.z += velocity.z * elapsed;
+      time = event.m_at;
+      if (event.m_setPosition)
+        {
+          // Setting the position also stops the node
+          position = event.m_value;
+          velocity = Vector (0, 0, 0);
+        }
+      else
+        {
+          velocity = event.m_value;
+        }
+      if (segments.back ().m_time != time)
+        {
+          segments.push_back (BinaryMobilityTraceSegment ());
+        }
+      segments.back () = {time, {position.x, position.y, position.z}, {velocity.x, velocity.y, velocity.z}};
+    }
+  return segments;
+}
+
+Time
+DelayTo (double at, Time offset)
+{
+  Time delay = Seconds (at) - offset;
+  return delay.IsStrictlyNegative () ? Time (0) : delay;
+}
+
 DestinationPoint
 SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at,
-             Vector finalPosition, double speed)
+             Vector finalPosition, double speed, Time offset)
 {
   DestinationPoint retval;
   retval.m_startPosition = last_pos;
@@ -766,7 +1195,7 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
   if (speed == 0)
     {
       // We have to maintain last position, and stop the movement
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model,
+      retval.m_stopEvent = Simulator::Schedule (DelayTo (at, offset), &ConstantVelocityMobilityModel::SetVelocity, model,
                                                 Vector (0, 0, 0));
       return retval;
     }
@@ -789,8 +1218,8 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
       NS_LOG_DEBUG ("Calculated Speed: X=" << velocity.x << " Y=" << velocity.y << " Z=" << velocity.z);
 
       // Set the Values
-      Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model, velocity);
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at + time), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
+      Simulator::Schedule (DelayTo (at, offset), &ConstantVelocityMobilityModel::SetVelocity, model, velocity);
+      retval.m_stopEvent = Simulator::Schedule (DelayTo (at + time, offset), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
       retval.m_finalPosition.x += velocity.x * time;
       retval.m_finalPosition.y += velocity.y * time;
       retval.m_finalPosition.z += velocity.z * time;
@@ -815,13 +1244,14 @@ SetInitialPosition (Ptr<ConstantVelocityMobilityModel> model, std::string coord,
 
 // Schedule a set of position for a node
 Vector
-SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at, std::string coord, double coordVal)
+SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at, std::string coord, double coordVal,
+                  Time offset)
 {
   // update position
   Vector position = SetOneInitialCoord (last_pos, coord, coordVal);
   
   // Chedule next positions
-  Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetPosition, model,position);
+  Simulator::Schedule (DelayTo (at, offset), &ConstantVelocityMobilityModel::SetPosition, model,position);
 
   return position;
 }
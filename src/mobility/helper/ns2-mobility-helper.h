@@ -106,6 +106,31 @@ public:
    */
   template <typename T>
   void Install (T begin, T end) const;
+
+  /**
+   * \param streaming true to stream the trace into the simulation.
+   *
+   * By default, all the movement events of the trace are scheduled at
+   * install time, so the memory used grows with the trace size. When
+   * streaming, the trace is parsed once at install time and only the next
+   * movement command of each node is scheduled; the following command is
+   * scheduled when it runs. This reduces the number of pending events from
+   * the number of trace lines to the number of nodes, which is useful for
+   * long traces from SUMO with many vehicles. Commands of a node with times
+   * earlier than a previous command of the same node are run as soon as
+   * possible instead of at their time. Must be called before Install.
+   */
+  void SetStreaming (bool streaming);
+
+  /**
+   * \param filename the binary mobility trace file to write.
+   *
+   * Convert the ns-2 trace into a binary mobility trace, to be installed
+   * with the BinaryMobilityHelper. The movement of each node is computed
+   * from the trace commands as Install would schedule it, and saved as
+   * segments of constant velocity.
+   */
+  void WriteBinaryTrace (std::string filename) const;
 private:
   /**
    * \brief a class to hold input objects internally
@@ -126,6 +151,12 @@ public:
    * \param store Object store containing ns-3 mobility models
    */
   void ConfigNodesMovements (const ObjectStore &store) const;
+  /**
+   * Parses ns-2 mobility file to create ns-3 mobility events, scheduling
+   * only the next movement command of each node at a time
+   * \param store Object store containing ns-3 mobility models
+   */
+  void ConfigNodesStreaming (const ObjectStore &store) const;
   /**
    * Get or create a ConstantVelocityMobilityModel corresponding to idString
    * \param idString string name for a node
@@ -134,6 +165,7 @@ public:
    */
   Ptr<ConstantVelocityMobilityModel> GetMobilityModel (std::string idString, const ObjectStore &store) const;
   std::string m_filename; //!< filename of file containing ns-2 mobility trace
+  bool m_streaming; //!< stream the trace instead of scheduling all events at install time
 };
 
 } // namespace ns3
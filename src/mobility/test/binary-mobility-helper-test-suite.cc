@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-model.h"
+#include "ns3/waypoint-mobility-model.h"
+#include "ns3/test.h"
+#include "ns3/ns2-mobility-helper.h"
+#include "ns3/binary-mobility-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check that an ns-2 trace converted into a binary trace gives the
+ * same movement as the ns-2 trace, from the start of the trace and from a
+ * later start time, with constant velocity and waypoint mobility models.
+ */
+class BinaryMobilityHelperTestCase : public TestCase
+{
+public:
+  BinaryMobilityHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Save the positions of the nodes.
+   * \param nodes The nodes.
+   * \param positions The positions, for each sample time.
+   */
+  void Sample (NodeContainer nodes, std::vector<std::vector<Vector> > *positions);
+
+  /**
+   * Compare the positions of the nodes.
+   * \param name The compared installation.
+   * \param actual The positions to check.
+   * \param expected The reference positions.
+   * \param offset The number of reference samples to skip.
+   * \param node The node to compare, or all if -1.
+   */
+  void Compare (std::string name, const std::vector<std::vector<Vector> > &actual,
+                const std::vector<std::vector<Vector> > &expected, uint32_t offset, int node);
+};
+
+BinaryMobilityHelperTestCase::BinaryMobilityHelperTestCase ()
+  : TestCase ("Check binary mobility traces against ns-2 traces")
+{
+}
+
+void
+BinaryMobilityHelperTestCase::Sample (NodeContainer nodes, std::vector<std::vector<Vector> > *positions)
+{
+  std::vector<Vector> sample;
+  for (NodeContainer::Iterator it = nodes.Begin (); it != nodes.End (); ++it)
+    {
+      sample.push_back ((*it)->GetObject<MobilityModel> ()->GetPosition ());
+    }
+  positions->push_back (sample);
+}
+
+void
+BinaryMobilityHelperTestCase::Compare (std::string name, const std::vector<std::vector<Vector> > &actual,
+                                       const std::vector<std::vector<Vector> > &expected, uint32_t offset, int node)
+{
+  for (uint32_t i = 0; i + offset < expected.size () && i < actual.size (); i++)
+    {
+      for (uint32_t n = 0; n < actual[i].size (); n++)
+        {
+          if (node >= 0 && n != static_cast<uint32_t> (node))
+            {
+              continue;
+            }
+          double distance = CalculateDistance (actual[i][n], expected[i + offset][n]);
+          NS_TEST_EXPECT_MSG_LT (distance, 0.001, name << ": position mismatch for node " << n <<
+                                 " at sample " << i << ": " << actual[i][n] << " instead of " << expected[i + offset][n]);
+        }
+    }
+}
+
+void
+BinaryMobilityHelperTestCase::DoRun (void)
+{
+  std::string ns2File = CreateTempDirFilename ("BinaryMobilityHelperTest.ns_movements");
+  std::string binFile = CreateTempDirFilename ("BinaryMobilityHelperTest.bin");
+  std::ofstream of (ns2File.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (of.is_open (), true, "Need to write tmp. file");
+  // Node 0 has interrupted movements, a position jump which keeps the
+  // velocity and a stop. Node 1 has 3D movements only.
+  of << "$node_(0) set X_ 0.0\n"
+     << "$node_(0) set Y_ 0.0\n"
+     << "$ns_ at 1.0 \"$node_(0) setdest 10 0 2\"\n"
+     << "$ns_ at 3.0 \"$node_(0) setdest 4 10 1\"\n"
+     << "$ns_ at 8.0 \"$node_(0) set X_ 50\"\n"
+     << "$ns_ at 10.0 \"$node_(0) setdest 50 20 0\"\n"
+     << "$node_(1) set X_ 5.0\n"
+     << "$node_(1) set Y_ 5.0\n"
+     << "$node_(1) set Z_ 1.0\n"
+     << "$ns_ at 0.5 \"$node_(1) setdest 5 15 10 2\"\n"
+     << "$ns_ at 9.0 \"$node_(1) setdest 0 0 0 5\"\n";
+  of.close ();
+
+  Ns2MobilityHelper ns2 (ns2File);
+  ns2.WriteBinaryTrace (binFile);
+  BinaryMobilityHelper binary (binFile);
+  BinaryMobilityHelper seek (binFile);
+  Time start = Seconds (2.5);
+  seek.SetStartTime (start);
+
+  NodeContainer reference;
+  reference.Create (2);
+  ns2.Install (reference.Begin (), reference.End ());
+  NodeContainer velocity;
+  velocity.Create (2);
+  binary.Install (velocity.Begin (), velocity.End ());
+  NodeContainer waypoint;
+  waypoint.Create (2);
+  for (NodeContainer::Iterator it = waypoint.Begin (); it != waypoint.End (); ++it)
+    {
+      (*it)->AggregateObject (CreateObject<WaypointMobilityModel> ());
+    }
+  binary.Install (waypoint.Begin (), waypoint.End ());
+  NodeContainer seekVelocity;
+  seekVelocity.Create (2);
+  seek.Install (seekVelocity.Begin (), seekVelocity.End ());
+  NodeContainer seekWaypoint;
+  seekWaypoint.Create (2);
+  for (NodeContainer::Iterator it = seekWaypoint.Begin (); it != seekWaypoint.End (); ++it)
+    {
+      (*it)->AggregateObject (CreateObject<WaypointMobilityModel> ());
+    }
+  seek.Install (seekWaypoint.Begin (), seekWaypoint.End ());
+
+  // Sample the positions between the events of the trace
+  Time interval = MilliSeconds (250);
+  std::vector<std::vector<Vector> > referenceSamples, velocitySamples, waypointSamples;
+  std::vector<std::vector<Vector> > seekVelocitySamples, seekWaypointSamples;
+  for (Time t = MilliSeconds (125); t < Seconds (20); t += interval)
+    {
+      Simulator::Schedule (t, &BinaryMobilityHelperTestCase::Sample, this, reference, &referenceSamples);
+      Simulator::Schedule (t, &BinaryMobilityHelperTestCase::Sample, this, velocity, &velocitySamples);
+      Simulator::Schedule (t, &BinaryMobilityHelperTestCase::Sample, this, waypoint, &waypointSamples);
+      Simulator::Schedule (t, &BinaryMobilityHelperTestCase::Sample, this, seekVelocity, &seekVelocitySamples);
+      Simulator::Schedule (t, &BinaryMobilityHelperTestCase::Sample, this, seekWaypoint, &seekWaypointSamples);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t offset = start.GetInteger () / interval.GetInteger ();
+  Compare ("constant velocity", velocitySamples, referenceSamples, 0, -1);
+  Compare ("constant velocity from 2.5 s", seekVelocitySamples, referenceSamples, offset, -1);
+  // Waypoints can't jump, so only node 1 follows the trace exactly
+  Compare ("waypoints", waypointSamples, referenceSamples, 0, 1);
+  Compare ("waypoints from 2.5 s", seekWaypointSamples, referenceSamples, offset, 1);
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Binary mobility helper test suite
+ */
+class BinaryMobilityHelperTestSuite : public TestSuite
+{
+public:
+  BinaryMobilityHelperTestSuite () : TestSuite ("mobility-binary-trace-helper", UNIT)
+  {
+    AddTestCase (new BinaryMobilityHelperTestCase, TestCase::QUICK);
+  }
+} g_binaryMobilityHelperTestSuite; ///< the test suite
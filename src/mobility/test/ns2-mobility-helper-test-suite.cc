@@ -253,16 +253,30 @@ private:
       {
         return;
       }
-    Ns2MobilityHelper mobility (m_traceFile);
-    mobility.Install ();
-    if (CheckInitialPositions ())
+
+    // Check the same reference with all events scheduled at install time
+    // and with the trace streamed into the simulation
+    for (bool streaming : {false, true})
       {
-        return;
+        if (streaming)
+          {
+            Names::Clear ();
+            Simulator::Destroy ();
+            CreateNodes ();
+            m_nextRefPoint = 0;
+          }
+        Ns2MobilityHelper mobility (m_traceFile);
+        mobility.SetStreaming (streaming);
+        mobility.Install ();
+        if (CheckInitialPositions ())
+          {
+            return;
+          }
+        Config::Connect ("/NodeList/*/$ns3::MobilityModel/CourseChange",
+                         MakeCallback (&Ns2MobilityHelperTest::CourseChange, this));
+        Simulator::Stop (m_timeLimit);
+        Simulator::Run ();
       }
-    Config::Connect ("/NodeList/*/$ns3::MobilityModel/CourseChange",
-                     MakeCallback (&Ns2MobilityHelperTest::CourseChange, this));
-    Simulator::Stop (m_timeLimit);
-    Simulator::Run ();
   }
 };
 
@@ -32,6 +32,7 @@
 #include "ns3/log.h"
 
 #include <cmath>
+#include <set>
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -178,6 +179,7 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
         }
       // else it was already set by SetLookAhead
 
+      std::set<uint32_t> sharedChannels;
       NodeContainer c = NodeContainer::GetGlobal ();
       for (NodeContainer::Iterator iter = c.Begin (); iter != c.End (); ++iter)
         {
@@ -189,14 +191,22 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
           for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
             {
               Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
-              // only works for p2p links currently
-              if (!localNetDevice->IsPointToPoint ())
+              Ptr<Channel> channel = localNetDevice->GetChannel ();
+              if (channel == 0)
                 {
                   continue;
                 }
-              Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
+              // shared channels spanning several tasks, such as
+              // MultiModelSpectrumRemoteChannel, report their own bound
+              if (!localNetDevice->IsPointToPoint ())
                 {
+                  TimeValue delay;
+                  if (sharedChannels.insert (channel->GetId ()).second
+                      && channel->GetAttributeFailSafe ("LookAhead", delay)
+                      && delay.Get () < m_lookAhead)
+                    {
+                      m_lookAhead = delay.Get ();
+                    }
                   continue;
                 }
 
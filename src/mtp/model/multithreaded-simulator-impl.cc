@@ -0,0 +1,922 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/system-thread.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+
+#include <algorithm>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions, and because
+// they run concurrently in the partition threads.
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::g_currentPartition = 0;
+
+/** The largest timestamp, marking an empty event list. */
+static const uint64_t MAX_TS = 0x7fffffffffffffffULL;
+
+/**
+ * Lower an atomic timestamp.
+ * \param [in,out] value The timestamp.
+ * \param [in] ts The new timestamp, kept if lower.
+ */
+static void
+AtomicMin (std::atomic<uint64_t> &value, uint64_t ts)
+{
+  uint64_t current = value.load (std::memory_order_relaxed);
+  while (ts < current
+         && !value.compare_exchange_weak (current, ts, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * Find the representative of a group of nodes, compressing the path.
+ * \param [in,out] group The parent of each node.
+ * \param [in] node The node id.
+ * \returns The lowest node id of the group.
+ */
+static uint32_t
+FindGroup (std::vector<uint32_t> &group, uint32_t node)
+{
+  while (group[node] != node)
+    {
+      group[node] = group[group[node]];
+      node = group[node];
+    }
+  return node;
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mtp")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "The number of partitions, each run by its own thread. "
+                   "Zero selects the number of hardware threads.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LookAhead",
+                   "The smallest delay of the events scheduled into another "
+                   "partition.  A negative value computes it from the "
+                   "channels joining the partitions when Run () starts.",
+                   TimeValue (Seconds (-1)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookAheadAttribute),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::Barrier::Barrier (uint32_t count)
+  : m_count (count),
+    m_waiting (0),
+    m_generation (0)
+{
+}
+
+void
+MultithreadedSimulatorImpl::Barrier::Wait (void)
+{
+  uint32_t generation = m_generation.load (std::memory_order_acquire);
+  if (m_waiting.fetch_add (1, std::memory_order_acq_rel) + 1 == m_count)
+    {
+      m_waiting.store (0, std::memory_order_relaxed);
+      m_generation.fetch_add (1, std::memory_order_release);
+      return;
+    }
+  uint32_t spins = 0;
+  while (m_generation.load (std::memory_order_acquire) == generation)
+    {
+      if (++spins > 1024)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_maxThreads (0),
+    m_lookAheadAttribute (Seconds (-1)),
+    m_lookAhead (0),
+    m_uidStride (1),
+    m_barrier (0),
+    m_running (false),
+    m_stop (false),
+    m_stopTs (MAX_TS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  if (!m_partitions.empty ())
+    {
+      return;
+    }
+  uint32_t count = m_maxThreads;
+  if (count == 0)
+    {
+      count = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  NS_LOG_LOGIC ("creating " << count << " partitions");
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      Partition *partition = new Partition;
+      // uids are allocated from 4.
+      // uid 0 is "invalid" events
+      // uid 1 is "now" events
+      // uid 2 is "destroy" events
+      partition->uid = 4;
+      // before ::Run is entered, the currentUid will be zero
+      partition->currentUid = 0;
+      partition->currentTs = 0;
+      partition->currentContext = Simulator::NO_CONTEXT;
+      partition->unscheduledEvents = 0;
+      partition->nextTs = MAX_TS;
+      partition->stop = false;
+      m_partitions.push_back (partition);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      EventWithContext event;
+      while (partition->inbound.Pop (event))
+        {
+          event.event->Unref ();
+        }
+      while (partition->events != 0 && !partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "Cannot change the scheduler while running");
+  CreatePartitions ();
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*i)->events != 0)
+        {
+          while (!(*i)->events->IsEmpty ())
+            {
+              scheduler->Insert ((*i)->events->RemoveNext ());
+            }
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t nodeId, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << nodeId << partition);
+  NS_ASSERT_MSG (!m_running, "Cannot move a node to another partition while running");
+  m_nodePartition[nodeId] = partition;
+  // Assigned again at the next Run ().
+  m_partitionOf.clear ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t nodeId) const
+{
+  if (nodeId == Simulator::NO_CONTEXT)
+    {
+      return 0;
+    }
+  if (nodeId < m_partitionOf.size ())
+    {
+      return m_partitionOf[nodeId];
+    }
+  return GetRequestedPartition (nodeId);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetRequestedPartition (uint32_t nodeId) const
+{
+  uint32_t count = GetPartitionCount ();
+  std::map<uint32_t, uint32_t>::const_iterator i = m_nodePartition.find (nodeId);
+  if (i != m_nodePartition.end ())
+    {
+      return i->second % count;
+    }
+  return nodeId % count;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  const_cast<MultithreadedSimulatorImpl *> (this)->CreatePartitions ();
+  return m_partitions.size ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  if (g_currentPartition != 0)
+    {
+      return g_currentPartition;
+    }
+  NS_ASSERT_MSG (!m_running, "Simulator function called from a thread outside of the simulation!");
+  return m_partitions[0];
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartitionOf (uint32_t context) const
+{
+  if (!m_running)
+    {
+      // all the events are kept in the first partition between runs.
+      return m_partitions[0];
+    }
+  return m_partitions[GetPartition (context)];
+}
+
+bool
+MultithreadedSimulatorImpl::IsSplittable (Ptr<Channel> channel, Time *delay)
+{
+  for (std::size_t i = 0; i < channel->GetNDevices (); ++i)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      if (device != 0 && !device->IsPointToPoint ())
+        {
+          return false;
+        }
+    }
+  TimeValue delayValue;
+  BooleanValue deepCopy;
+  if (!channel->GetAttributeFailSafe ("Delay", delayValue)
+      || !channel->GetAttributeFailSafe ("DeepCopy", deepCopy)
+      || !delayValue.Get ().IsStrictlyPositive ())
+    {
+      return false;
+    }
+  *delay = delayValue.Get ();
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::AssignPartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> group (nodes);
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      group[i] = i;
+    }
+  // Nodes which share any channel but a point-to-point link with a
+  // propagation delay are merged into one group.
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<Channel> channel = (*node)->GetDevice (i)->GetChannel ();
+          Time delay;
+          if (channel == 0 || IsSplittable (channel, &delay))
+            {
+              continue;
+            }
+          for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              Ptr<NetDevice> remote = channel->GetDevice (j);
+              if (remote == 0 || remote->GetNode () == 0)
+                {
+                  continue;
+                }
+              uint32_t a = FindGroup (group, (*node)->GetId ());
+              uint32_t b = FindGroup (group, remote->GetNode ()->GetId ());
+              group[std::max (a, b)] = std::min (a, b);
+            }
+        }
+    }
+
+  // A group goes to the partition requested for any of its nodes, or
+  // else to the default partition of its lowest node id.
+  std::map<uint32_t, std::pair<uint32_t, uint32_t> > requested;
+  for (std::map<uint32_t, uint32_t>::const_iterator i = m_nodePartition.begin ();
+       i != m_nodePartition.end () && i->first < nodes; ++i)
+    {
+      uint32_t root = FindGroup (group, i->first);
+      uint32_t partition = GetRequestedPartition (i->first);
+      std::map<uint32_t, std::pair<uint32_t, uint32_t> >::const_iterator j = requested.find (root);
+      if (j == requested.end ())
+        {
+          requested[root] = std::make_pair (i->first, partition);
+        }
+      else if (j->second.second != partition)
+        {
+          NS_FATAL_ERROR ("Nodes " << j->second.first << " and " << i->first
+                          << " share a channel which cannot span partitions,"
+                          << " but were assigned to partitions "
+                          << j->second.second << " and " << partition);
+        }
+    }
+  m_partitionOf.resize (nodes);
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      uint32_t root = FindGroup (group, i);
+      std::map<uint32_t, std::pair<uint32_t, uint32_t> >::const_iterator j = requested.find (root);
+      m_partitionOf[i] = j != requested.end () ? j->second.second : GetRequestedPartition (root);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t lookAhead = MAX_TS;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      uint32_t local = GetPartition ((*node)->GetId ());
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<Channel> channel = (*node)->GetDevice (i)->GetChannel ();
+          Time delay;
+          if (channel == 0 || !IsSplittable (channel, &delay))
+            {
+              continue;
+            }
+          // Only the links joining two partitions bound the delay of the
+          // events crossing partitions, and carry deep copies of the
+          // packets.
+          bool crossing = false;
+          for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              Ptr<NetDevice> remote = channel->GetDevice (j);
+              if (remote != 0 && remote->GetNode () != 0
+                  && GetPartition (remote->GetNode ()->GetId ()) != local)
+                {
+                  crossing = true;
+                }
+            }
+          channel->SetAttribute ("DeepCopy", BooleanValue (crossing));
+          if (crossing)
+            {
+              lookAhead = std::min<uint64_t> (lookAhead, delay.GetTimeStep ());
+            }
+        }
+    }
+  m_lookAhead = lookAhead;
+  if (m_lookAheadAttribute.IsPositive ())
+    {
+      m_lookAhead = m_lookAheadAttribute.GetTimeStep ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Redistribute (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *first = m_partitions[0];
+  std::vector<Scheduler::Event> moved;
+  while (!first->events->IsEmpty ())
+    {
+      moved.push_back (first->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = moved.begin ();
+       i != moved.end (); ++i)
+    {
+      Partition *owner = m_partitions[GetPartition (i->key.m_context)];
+      owner->events->Insert (*i);
+      first->unscheduledEvents--;
+      owner->unscheduledEvents++;
+    }
+
+  // Interleave the uids of the partitions so that they stay unique
+  // without any synchronization.
+  m_uidStride = m_partitions.size ();
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *partition = m_partitions[i];
+      partition->uid = first->uid + i;
+      partition->currentUid = first->currentUid;
+      partition->currentTs = first->currentTs;
+      partition->currentContext = Simulator::NO_CONTEXT;
+      partition->stop = false;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessInbound (Partition *partition)
+{
+  if (partition->inbound.IsEmpty ())
+    {
+      return;
+    }
+
+  EventWithContext event;
+  while (partition->inbound.Pop (event))
+    {
+      Scheduler::Event ev;
+      ev.impl = event.event;
+      ev.key.m_context = event.context;
+      if (event.uid == 0)
+        {
+          ev.key.m_ts = partition->currentTs + event.timestamp;
+          ev.key.m_uid = partition->uid;
+          partition->uid += m_uidStride;
+        }
+      else
+        {
+          ev.key.m_ts = event.timestamp;
+          ev.key.m_uid = event.uid;
+        }
+      NS_ASSERT (ev.key.m_ts >= partition->currentTs);
+      partition->unscheduledEvents++;
+      partition->events->Insert (ev);
+    }
+}
+
+Scheduler::Event
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint32_t context,
+                                    uint64_t ts, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid += m_uidStride;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev;
+}
+
+void
+MultithreadedSimulatorImpl::PartitionThread (std::pair<MultithreadedSimulatorImpl *, uint32_t> context)
+{
+  context.first->RunPartition (context.second);
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (uint32_t index)
+{
+  Partition *partition = m_partitions[index];
+  g_currentPartition = partition;
+  uint64_t window = std::max<uint64_t> (m_lookAhead, 1);
+
+  while (true)
+    {
+      // Everything written here is only read by the other partitions
+      // between the two barriers, while nobody runs events.
+      ProcessInbound (partition);
+      partition->nextTs = partition->events->IsEmpty () ?
+        MAX_TS : partition->events->PeekNext ().key.m_ts;
+      bool stop = m_stop.load (std::memory_order_relaxed);
+      uint64_t stopTs = m_stopTs.load (std::memory_order_relaxed);
+      m_barrier->Wait ();
+
+      uint64_t next = MAX_TS;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+           i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, (*i)->nextTs);
+        }
+      if (stop || next == MAX_TS || next > stopTs)
+        {
+          break;
+        }
+      uint64_t windowEnd = next < MAX_TS - window ? next + window : MAX_TS;
+      // Do not run past the earliest requested stop time: the events of
+      // the other partitions at that time still run, as their order
+      // with the Stop event is undefined.
+      windowEnd = std::min (windowEnd, stopTs + 1);
+
+      while (!partition->stop && !partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts < windowEnd
+             && partition->events->PeekNext ().key.m_ts
+             <= m_stopTs.load (std::memory_order_relaxed))
+        {
+          Scheduler::Event ev = partition->events->RemoveNext ();
+
+          NS_ASSERT (ev.key.m_ts >= partition->currentTs);
+          partition->unscheduledEvents--;
+
+          partition->currentTs = ev.key.m_ts;
+          partition->currentContext = ev.key.m_context;
+          partition->currentUid = ev.key.m_uid;
+          ev.impl->Invoke ();
+          ev.impl->Unref ();
+
+          ProcessInbound (partition);
+        }
+      m_barrier->Wait ();
+    }
+
+  g_currentPartition = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_running, "Simulator::Run () is not reentrant");
+  CreatePartitions ();
+  Partition *first = m_partitions[0];
+  ProcessInbound (first);
+
+  AssignPartitions ();
+  CalculateLookAhead ();
+  Redistribute ();
+  NS_LOG_LOGIC ("running " << m_partitions.size () << " partitions, lookahead "
+                << m_lookAhead);
+
+  m_stop = false;
+  UpdateStopTs (first->currentTs);
+  m_barrier = new Barrier (m_partitions.size ());
+  m_running = true;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread =
+        Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::PartitionThread,
+                                                 std::make_pair (this, i)));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  RunPartition (0);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin ();
+       i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_running = false;
+  delete m_barrier;
+  m_barrier = 0;
+
+  // Gather the events left, if stopped, back into the first partition,
+  // which holds them until the next Run ().
+  uint64_t lastTs = first->currentTs;
+  uint32_t uid = first->uid;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      Partition *partition = m_partitions[i];
+      ProcessInbound (partition);
+      while (!partition->events->IsEmpty ())
+        {
+          first->events->Insert (partition->events->RemoveNext ());
+        }
+      first->unscheduledEvents += partition->unscheduledEvents;
+      partition->unscheduledEvents = 0;
+      lastTs = std::max (lastTs, partition->currentTs);
+      uid = std::max (uid, partition->uid);
+    }
+  ProcessInbound (first);
+  first->uid = uid;
+  m_uidStride = 1;
+  first->currentContext = Simulator::NO_CONTEXT;
+  if (m_stop)
+    {
+      // Every partition ran up to the stop time, but not beyond unless
+      // Stop () was called within their window.
+      first->currentTs = m_stopTs;
+    }
+  else if (first->events->IsEmpty ())
+    {
+      // Finished naturally: the simulation ended with the last event
+      // of any partition.
+      first->currentTs = lastTs;
+    }
+  UpdateStopTs (first->currentTs + 1);
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!first->events->IsEmpty () || first->unscheduledEvents == 0);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return m_stop;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *partition = GetCurrentPartition ();
+  partition->stop = true;
+  AtomicMin (m_stopTs, partition->currentTs);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint64_t ts = (uint64_t) (delay + TimeStep (GetCurrentPartition ()->currentTs)).GetTimeStep ();
+  {
+    CriticalSection cs (m_stopMutex);
+    m_stopTimes.insert (ts);
+  }
+  AtomicMin (m_stopTs, ts);
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+void
+MultithreadedSimulatorImpl::UpdateStopTs (uint64_t from)
+{
+  CriticalSection cs (m_stopMutex);
+  m_stopTimes.erase (m_stopTimes.begin (), m_stopTimes.lower_bound (from));
+  m_stopTs = m_stopTimes.empty () ? MAX_TS : *m_stopTimes.begin ();
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+  Partition *partition = GetCurrentPartition ();
+  uint64_t ts = (uint64_t) (delay + TimeStep (partition->currentTs)).GetTimeStep ();
+  Scheduler::Event ev = Insert (partition, partition->currentContext, ts, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::ScheduleWithContext(): Negative delay");
+
+  Partition *target = GetPartitionOf (context);
+  Partition *source = g_currentPartition;
+  if (!m_running || source == target)
+    {
+      Partition *partition = m_running ? source : m_partitions[0];
+      uint64_t ts = (uint64_t) (delay + TimeStep (partition->currentTs)).GetTimeStep ();
+      Insert (partition, context, ts, event);
+      return;
+    }
+
+  EventWithContext ev;
+  ev.context = context;
+  ev.event = event;
+  if (source == 0)
+    {
+      // Injected by a thread outside of the simulation: the current
+      // time of the target is added in ProcessInbound ().
+      ev.timestamp = delay.GetTimeStep ();
+      ev.uid = 0;
+    }
+  else
+    {
+      if ((uint64_t) delay.GetTimeStep () < m_lookAhead)
+        {
+          NS_FATAL_ERROR ("Event scheduled into the partition of node " << context
+                          << " within the lookahead (" << delay.GetTimeStep ()
+                          << " < " << m_lookAhead << ")");
+        }
+      ev.timestamp = source->currentTs + delay.GetTimeStep ();
+      ev.uid = source->uid;
+      source->uid += m_uidStride;
+    }
+  target->inbound.Push (ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *partition = GetCurrentPartition ();
+  Scheduler::Event ev = Insert (partition, partition->currentContext,
+                                partition->currentTs, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  CriticalSection cs (m_destroyEventsMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentPartition ()->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrentPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *owner = GetPartitionOf (id.GetContext ());
+  if (m_running && owner != g_currentPartition)
+    {
+      // The event list of another partition cannot be touched while
+      // it runs: leave the event there, cancelled.
+      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  owner->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  owner->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  // The progress of another running partition cannot be read: judge
+  // from the caller's own time, which is within a window of it.
+  Partition *partition = GetPartitionOf (id.GetContext ());
+  if (m_running && partition != g_currentPartition)
+    {
+      partition = GetCurrentPartition ();
+    }
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+} // namespace ns3
@@ -0,0 +1,316 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/system-mutex.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+/**
+ * \defgroup mtp Multithreaded Simulation
+ */
+
+namespace ns3 {
+
+class Channel;
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Conservative, shared-memory parallel simulator implementation.
+ *
+ * Nodes are partitioned over a pool of threads, and each partition has
+ * its own event list.  The partition of an event is that of its context,
+ * which for model events is the id of the node they belong to; events
+ * without a node context (Simulator::NO_CONTEXT) belong to partition 0.
+ * Simulator::Schedule () keeps the caller's context and hence stays in
+ * the calling partition, while Simulator::ScheduleWithContext () towards
+ * a node of another partition hands the event over to that partition.
+ *
+ * Partitions advance through the simulation in windows, in lock step:
+ * between two barriers, every partition runs its events with timestamps
+ * below the window end, which is the earliest pending timestamp of all
+ * partitions plus the lookahead.  The lookahead is the smallest delay an
+ * event scheduled into another partition can have; by default it is
+ * computed when Run () starts as the smallest Delay of the
+ * point-to-point channels joining two partitions.  Scheduling an event
+ * into another partition with a shorter delay is a fatal error.  A
+ * lookahead can also be forced through the LookAhead attribute.
+ *
+ * Models run concurrently in different partitions, so they must not
+ * share state across partitions.  When Run () starts, the nodes which
+ * share any channel (wireless or otherwise) are therefore kept in the
+ * same partition, so that a channel and the packets it copies are only
+ * touched by one thread.  The only channels which may join two
+ * partitions are point-to-point links with a positive Delay and a
+ * DeepCopy attribute, such as ns3::PointToPointChannel: they then hand
+ * deep copies of the packets (Packet::DeepCopy ()) to the receiving
+ * partition.  Models which share state by other means must be kept in
+ * one partition with SetPartition ().
+ *
+ * A group of nodes sharing a channel goes to the partition requested
+ * with SetPartition () for any of them; by default node \c n goes to
+ * partition \c n % \c MaxThreads, and a group to the partition of its
+ * lowest node id.
+ *
+ * Simulator::Remove () of an event owned by another partition cancels
+ * it instead.  The windows do not extend beyond the time requested by
+ * Simulator::Stop (delay); the events of the other partitions at that
+ * very time still run.  Simulator::Stop () called within a window
+ * takes effect at the first event after the current time for the other
+ * partitions, which may already have run ahead within the window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Assign a node to a partition.  Must be called before Run ().
+   *
+   * The nodes sharing a channel with this node go to the same
+   * partition; assigning two of them to different partitions is a
+   * fatal error.
+   *
+   * \param [in] nodeId The node id (the event context).
+   * \param [in] partition The partition, modulo the number of threads.
+   */
+  void SetPartition (uint32_t nodeId, uint32_t partition);
+  /**
+   * \param [in] nodeId The node id (the event context).
+   * \returns The partition of the node, as assigned by the last Run (),
+   *          or as requested if SetPartition () was called since.
+   */
+  uint32_t GetPartition (uint32_t nodeId) const;
+  /** \returns The number of partitions (threads). */
+  uint32_t GetPartitionCount (void) const;
+  /** \returns The lookahead used by the last, or current, Run (). */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event handed over by another partition. */
+  struct EventWithContext
+  {
+    /** The event context. */
+    uint32_t context;
+    /** Absolute event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+    /**
+     * Unique id allocated by the sending partition, or zero for events
+     * injected by other threads, whose timestamp is then relative.
+     */
+    uint32_t uid;
+  };
+
+  /** The state of one partition. */
+  struct Partition
+  {
+    /** The event priority queue. */
+    Ptr<Scheduler> events;
+    /** Events handed over by other partitions during the current window. */
+    MpscQueue<EventWithContext> inbound;
+    /** Next event unique id. */
+    uint32_t uid;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** Events inserted but not yet run, for validation. */
+    int unscheduledEvents;
+    /** Earliest pending timestamp, published at each barrier. */
+    uint64_t nextTs;
+    /** Simulator::Stop () was called from this partition. */
+    bool stop;
+  };
+
+  /** The partition run by the calling thread. */
+  static thread_local Partition *g_currentPartition;
+
+  /** Spinning barrier for the partition threads. */
+  class Barrier
+  {
+  public:
+    /**
+     * Constructor.
+     * \param [in] count The number of threads to synchronize.
+     */
+    Barrier (uint32_t count);
+    /** Wait until all threads have called Wait (). */
+    void Wait (void);
+  private:
+    uint32_t m_count;                   //!< Number of threads.
+    std::atomic<uint32_t> m_waiting;    //!< Threads arrived this round.
+    std::atomic<uint32_t> m_generation; //!< Incremented at each round.
+  };
+
+  /** Create the partitions, if not yet done. */
+  void CreatePartitions (void);
+  /**
+   * \param [in] nodeId The node id.
+   * \returns The partition requested for the node alone.
+   */
+  uint32_t GetRequestedPartition (uint32_t nodeId) const;
+  /**
+   * Check whether a channel may join two partitions.
+   * \param [in] channel The channel.
+   * \param [out] delay The propagation delay of the channel.
+   * \returns \c true for point-to-point links with a positive Delay
+   *          and a DeepCopy attribute.
+   */
+  static bool IsSplittable (Ptr<Channel> channel, Time *delay);
+  /**
+   * Build the node to partition table, keeping the nodes which share a
+   * channel together.
+   */
+  void AssignPartitions (void);
+  /**
+   * Compute the lookahead from the channels joining partitions, and
+   * enable their deep copies.
+   */
+  void CalculateLookAhead (void);
+  /**
+   * Move the events scheduled before Run () to the partition of their
+   * context.
+   */
+  void Redistribute (void);
+  /**
+   * Forget the stop times already past and set the earliest one left.
+   * \param [in] from The earliest stop time to keep.
+   */
+  void UpdateStopTs (uint64_t from);
+  /**
+   * The thread body for one partition.
+   * \param [in] index The partition index.
+   */
+  void RunPartition (uint32_t index);
+  /**
+   * Thread entry point for the worker partitions.
+   * \param [in] context The simulator and the partition index.
+   */
+  static void PartitionThread (std::pair<MultithreadedSimulatorImpl *, uint32_t> context);
+  /**
+   * Move the events handed over by other partitions to the event list.
+   * \param [in] partition The partition, which must be the caller's
+   *             or not running.
+   */
+  void ProcessInbound (Partition *partition);
+  /**
+   * Insert an event in a partition's event list.
+   * \param [in] partition The partition, which must be the caller's
+   *             or not running.
+   * \param [in] context The event context.
+   * \param [in] ts The absolute timestamp.
+   * \param [in] event The event.
+   * \returns The scheduler event inserted.
+   */
+  Scheduler::Event Insert (Partition *partition, uint32_t context, uint64_t ts, EventImpl *event);
+  /**
+   * \returns The partition of the calling thread.
+   */
+  Partition *GetCurrentPartition (void) const;
+  /**
+   * \param [in] context The event context.
+   * \returns The partition owning a context.
+   */
+  Partition *GetPartitionOf (uint32_t context) const;
+
+  /** The partitions. */
+  std::vector<Partition *> m_partitions;
+  /** The scheduler type for the partition event lists. */
+  ObjectFactory m_schedulerFactory;
+  /** Explicit node to partition assignments. */
+  std::map<uint32_t, uint32_t> m_nodePartition;
+  /** Partition index of each node, assigned at Run (). */
+  std::vector<uint32_t> m_partitionOf;
+  /** The number of partition threads requested. */
+  uint32_t m_maxThreads;
+  /** The lookahead requested, or negative for automatic. */
+  Time m_lookAheadAttribute;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** Increment between the uids allocated by one partition. */
+  uint32_t m_uidStride;
+  /** Barrier between the windows. */
+  Barrier *m_barrier;
+  /** True while Run () is executing partitions. */
+  bool m_running;
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The earliest stop time requested, no partition runs beyond. */
+  std::atomic<uint64_t> m_stopTs;
+  /** The times of the pending Simulator::Stop (delay) events. */
+  std::multiset<uint64_t> m_stopTimes;
+  /** Mutex to control access to the stop times. */
+  SystemMutex m_stopMutex;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the list of destroy events. */
+  mutable SystemMutex m_destroyEventsMutex;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/boolean.h"
+
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests Multithreaded simulation tests
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Run a ring of contexts, each ticking locally and passing tokens to
+ * the next one, and check that the multithreaded simulator produces
+ * exactly the same events as the default one.
+ */
+class MultithreadedSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] threads The number of partitions.
+   * \param [in] lookAhead The delay of the tokens between contexts.
+   * \param [in] stop The time of Simulator::Stop, or zero to run until
+   *             no events are left.
+   */
+  MultithreadedSimulatorRingTestCase (uint32_t threads, Time lookAhead, Time stop = Time (0));
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Run the ring with a simulator implementation.
+   * \param [in] simulatorType The SimulatorImplementationType.
+   */
+  void RunRing (const std::string &simulatorType);
+  /**
+   * A local tick of a context.
+   * \param [in] context The context.
+   */
+  void Tick (uint32_t context);
+  /**
+   * A token received from the previous context.
+   * \param [in] context The context.
+   * \param [in] hops The number of hops of the token so far.
+   */
+  void Token (uint32_t context, uint32_t hops);
+  /**
+   * Account an event of a context.
+   * \param [in] context The context.
+   */
+  void Record (uint32_t context);
+
+  /** Number of contexts in the ring. */
+  static const uint32_t CONTEXTS = 16;
+
+  uint32_t m_threads;               //!< Number of partitions.
+  Time m_lookAhead;                 //!< Token delay.
+  Time m_stop;                      //!< Stop time, or zero.
+  std::vector<uint64_t> m_events;   //!< Events per context.
+  std::vector<uint64_t> m_sum;      //!< Sum of event times per context.
+  std::vector<uint64_t> m_last;     //!< Last event time per context.
+  bool m_ordered;                   //!< Time never went back in a context.
+  bool m_context;                   //!< Events ran in their context.
+  Time m_end;                       //!< Time at the end of Run.
+};
+
+MultithreadedSimulatorRingTestCase::MultithreadedSimulatorRingTestCase (uint32_t threads, Time lookAhead,
+                                                                        Time stop)
+  : TestCase ("Check a ring of " + std::to_string (CONTEXTS) + " contexts on " +
+              std::to_string (threads) + " threads with a lookahead of " +
+              std::to_string (lookAhead.GetMicroSeconds ()) + "us" +
+              (stop.IsZero () ? "" : ", stopped at " + std::to_string (stop.GetNanoSeconds ()) + "ns")),
+    m_threads (threads),
+    m_lookAhead (lookAhead),
+    m_stop (stop)
+{
+}
+
+void
+MultithreadedSimulatorRingTestCase::Record (uint32_t context)
+{
+  // Each context belongs to a single partition, so its counters are
+  // only touched by one thread at a time.
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  if (Simulator::GetContext () != context)
+    {
+      m_context = false;
+    }
+  if (now < m_last[context])
+    {
+      m_ordered = false;
+    }
+  m_last[context] = now;
+  m_events[context]++;
+  m_sum[context] += now;
+}
+
+void
+MultithreadedSimulatorRingTestCase::Tick (uint32_t context)
+{
+  Record (context);
+  if (Simulator::Now () < MilliSeconds (20))
+    {
+      Simulator::Schedule (MicroSeconds (1 + context % 3),
+                           &MultithreadedSimulatorRingTestCase::Tick, this, context);
+    }
+}
+
+void
+MultithreadedSimulatorRingTestCase::Token (uint32_t context, uint32_t hops)
+{
+  Record (context);
+  if (Simulator::Now () < MilliSeconds (20))
+    {
+      uint32_t next = (context + 1) % CONTEXTS;
+      Simulator::ScheduleWithContext (next, m_lookAhead + MicroSeconds (hops % 5),
+                                      &MultithreadedSimulatorRingTestCase::Token, this,
+                                      next, hops + 1);
+    }
+}
+
+void
+MultithreadedSimulatorRingTestCase::RunRing (const std::string &simulatorType)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  m_events.assign (CONTEXTS, 0);
+  m_sum.assign (CONTEXTS, 0);
+  m_last.assign (CONTEXTS, 0);
+  m_ordered = true;
+  m_context = true;
+
+  for (uint32_t i = 0; i < CONTEXTS; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i),
+                                      &MultithreadedSimulatorRingTestCase::Tick, this, i);
+      if (i % 4 == 0)
+        {
+          Simulator::ScheduleWithContext (i, MicroSeconds (i),
+                                          &MultithreadedSimulatorRingTestCase::Token, this, i, 0);
+        }
+    }
+  if (!m_stop.IsZero ())
+    {
+      Simulator::Stop (m_stop);
+    }
+  Simulator::Run ();
+  m_end = Simulator::Now ();
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoRun (void)
+{
+  RunRing ("ns3::DefaultSimulatorImpl");
+  std::vector<uint64_t> events = m_events;
+  std::vector<uint64_t> sum = m_sum;
+  Time end = m_end;
+
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (m_threads));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::LookAhead", TimeValue (m_lookAhead));
+  RunRing ("ns3::MultithreadedSimulatorImpl");
+
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Time went back in a context");
+  NS_TEST_EXPECT_MSG_EQ (m_context, true, "Event ran in the wrong context");
+  NS_TEST_EXPECT_MSG_EQ (m_end, end, "Simulation ended at a different time");
+  for (uint32_t i = 0; i < CONTEXTS; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_events[i], events[i], "Wrong number of events in context " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_sum[i], sum[i], "Wrong event times in context " << i);
+    }
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (0));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::LookAhead", TimeValue (Seconds (-1)));
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Check that the nodes sharing a channel without a DeepCopy attribute
+ * are kept in one partition.
+ */
+class MultithreadedSimulatorSharedChannelTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] pointToPoint Whether the devices are point-to-point.
+   * \param [in] samePartition Whether both nodes are requested in the
+   *             same partition.
+   */
+  MultithreadedSimulatorSharedChannelTestCase (bool pointToPoint, bool samePartition);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  bool m_pointToPoint;   //!< Point-to-point devices.
+  bool m_samePartition;  //!< Both nodes requested in one partition.
+};
+
+MultithreadedSimulatorSharedChannelTestCase::MultithreadedSimulatorSharedChannelTestCase (bool pointToPoint,
+                                                                                          bool samePartition)
+  : TestCase (std::string ("Check that a ") +
+              (pointToPoint ? "point-to-point" : "shared") + " channel requested " +
+              (samePartition ? "inside" : "across") + " partitions stays in one"),
+    m_pointToPoint (pointToPoint),
+    m_samePartition (samePartition)
+{
+}
+
+void
+MultithreadedSimulatorSharedChannelTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (2));
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (3)));
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("PointToPointMode", BooleanValue (m_pointToPoint));
+      device->SetChannel (channel);
+      node->AddDevice (device);
+    }
+
+  Ptr<MultithreadedSimulatorImpl> impl =
+    DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not running the multithreaded simulator");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartitionCount (), 2, "Wrong number of partitions");
+  if (m_samePartition)
+    {
+      impl->SetPartition (1, 0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (1), (m_samePartition ? 0 : 1), "Wrong partition requested");
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (1), 0, "Nodes sharing a channel split");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookAhead (), TimeStep (0x7fffffffffffffffLL), "Wrong lookahead");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (1), "Wrong stop time");
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedSimulatorSharedChannelTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (0));
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * MultithreadedSimulatorImpl TestSuite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    uint32_t threadcounts[] = { 1, 2, 4, 7 };
+    for (uint32_t i = 0; i < (sizeof (threadcounts) / sizeof (threadcounts[0])); ++i)
+      {
+        AddTestCase (new MultithreadedSimulatorRingTestCase (threadcounts[i], MicroSeconds (10)), TestCase::QUICK);
+        // No lookahead: a global barrier at each timestamp.
+        AddTestCase (new MultithreadedSimulatorRingTestCase (threadcounts[i], Time (0)), TestCase::QUICK);
+        // The other partitions must not run past the stop time, which
+        // is inside a window.
+        AddTestCase (new MultithreadedSimulatorRingTestCase (threadcounts[i], MicroSeconds (10),
+                                                             NanoSeconds (10000500)), TestCase::QUICK);
+      }
+    AddTestCase (new MultithreadedSimulatorSharedChannelTestCase (true, false), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorSharedChannelTestCase (false, false), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorSharedChannelTestCase (false, true), TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization */
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite;
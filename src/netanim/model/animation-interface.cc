@@ -33,6 +33,7 @@
 #include <string>
 #include <iomanip>
 #include <map>
+#include <cmath>
 
 // ns3 includes
 #include "ns3/animation-interface.h"
@@ -59,6 +60,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/energy-source-container.h"
 #include "animation-interface.h"
+#include "animation-writer.h"
 
 namespace ns3 {
 
@@ -87,7 +89,10 @@ AnimationInterface::AnimationInterface (const std::string fn)
     m_routingStopTime (Seconds (0)), 
     m_routingFileName (""),
     m_routingPollInterval (Seconds (5)), 
-    m_trackPackets (true)
+    m_trackPackets (true),
+    m_writer (0),
+    m_positionSampling (false),
+    m_positionDeltas (false)
 {
   initialized = true;
   StartAnimation ();
@@ -104,6 +109,75 @@ AnimationInterface::SkipPacketTracing ()
   m_trackPackets = false;
 }
 
+void
+AnimationInterface::SetPacketTraceNodes (NodeContainer nc)
+{
+  m_packetTraceNodes.clear ();
+  for (NodeContainer::Iterator i = nc.Begin (); i != nc.End (); ++i)
+    {
+      m_packetTraceNodes.insert ((*i)->GetId ());
+    }
+}
+
+bool
+AnimationInterface::IsPacketTraceNode (uint32_t nodeId) const
+{
+  return m_packetTraceNodes.empty () || m_packetTraceNodes.find (nodeId) != m_packetTraceNodes.end ();
+}
+
+void
+AnimationInterface::EnableStreamingOutput (bool compress)
+{
+  NS_LOG_FUNCTION (this << compress);
+  if (!m_f || m_writer)
+    {
+      NS_FATAL_ERROR ("EnableStreamingOutput must be called once, right after the constructor");
+    }
+  if (compress && !IsCompressionSupported ())
+    {
+      NS_FATAL_ERROR ("Compressed animation traces need ns-3 to be built with zlib");
+    }
+  // The constructor has already written the start of the trace, so read it
+  // back and write it again through the writer
+  std::fclose (m_f);
+  m_f = 0;
+  std::ifstream in (m_outputFileName.c_str (), std::ios::binary);
+  std::ostringstream start;
+  start << in.rdbuf ();
+  in.close ();
+  SetOutputFile (m_outputFileName);
+  m_writer = new AnimationWriter (m_f, compress);
+  std::string startString = start.str ();
+  WriteN (startString.c_str (), startString.length (), m_f);
+}
+
+bool
+AnimationInterface::IsCompressionSupported (void)
+{
+  return AnimationWriter::IsCompressionSupported ();
+}
+
+void
+AnimationInterface::EnablePositionSampling (Time t, bool deltas)
+{
+  NS_LOG_FUNCTION (this << t << deltas);
+  NS_ASSERT (t.IsStrictlyPositive ());
+  m_positionSampleInterval = t;
+  m_positionDeltas = deltas;
+  if (m_positionSampling)
+    {
+      return;
+    }
+  m_positionSampling = true;
+  // The positions of the node elements are the first written positions
+  for (std::map <uint32_t, Vector>::const_iterator i = m_nodeLocation.begin (); i != m_nodeLocation.end (); ++i)
+    {
+      m_sampledPositions[i->first] = std::make_pair (static_cast<int64_t> (std::floor (i->second.x * 100 + 0.5)),
+                                                     static_cast<int64_t> (std::floor (i->second.y * 100 + 0.5)));
+    }
+  Simulator::Schedule (m_positionSampleInterval, &AnimationInterface::SamplePositions, this);
+}
+
 void
 AnimationInterface::EnableWifiPhyCounters (Time startTime, Time stopTime, Time pollInterval)
 {
@@ -420,6 +494,10 @@ AnimationInterface::MobilityCourseChangeTrace (Ptr <const MobilityModel> mobilit
       v = mobility->GetPosition ();
     }
   UpdatePosition (n, v);
+  if (m_positionSampling)
+    {
+      return;
+    }
   WriteXmlUpdateNodePosition (n->GetId (), v.x, v.y);
 }
 
@@ -444,7 +522,11 @@ void
 AnimationInterface::MobilityAutoCheck ()
 {
   CHECK_STARTED_INTIMEWINDOW;
-  std::vector <Ptr <Node> > MovedNodes = GetMovedNodes ();
+  std::vector <Ptr <Node> > MovedNodes;
+  if (!m_positionSampling)
+    {
+      MovedNodes = GetMovedNodes ();
+    }
   for (uint32_t i = 0; i < MovedNodes.size (); i++)
     {
       Ptr <Node> n = MovedNodes [i];
@@ -464,6 +546,49 @@ AnimationInterface::MobilityAutoCheck ()
     }
 }
 
+void
+AnimationInterface::SamplePositions ()
+{
+  if (m_started && IsInTimeWindow ())
+    {
+      std::ostringstream deltas;
+      for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+        {
+          Ptr <Node> n = *i;
+          Ptr <MobilityModel> mobility = n->GetObject <MobilityModel> ();
+          Vector v = mobility ? mobility->GetPosition () : GetPosition (n);
+          UpdatePosition (n, v);
+          // Positions are compared and offset in integer cm, so that adding
+          // up the offsets gives back the positions exactly
+          std::pair<int64_t, int64_t> position (static_cast<int64_t> (std::floor (v.x * 100 + 0.5)),
+                                                static_cast<int64_t> (std::floor (v.y * 100 + 0.5)));
+          std::pair<int64_t, int64_t> & last = m_sampledPositions[n->GetId ()];
+          if (position == last)
+            {
+              continue;
+            }
+          if (m_positionDeltas)
+            {
+              deltas << (deltas.tellp () > 0 ? ";" : "") << n->GetId () << " "
+                     << position.first - last.first << " " << position.second - last.second;
+            }
+          else
+            {
+              WriteXmlUpdateNodePosition (n->GetId (), v.x, v.y);
+            }
+          last = position;
+        }
+      if (deltas.tellp () > 0)
+        {
+          WriteXmlPositionDeltas (deltas.str ());
+        }
+    }
+  if (!Simulator::IsFinished ())
+    {
+      Simulator::Schedule (m_positionSampleInterval, &AnimationInterface::SamplePositions, this);
+    }
+}
+
 std::vector <Ptr <Node> >  
 AnimationInterface::GetMovedNodes ()
 {
@@ -516,6 +641,11 @@ AnimationInterface::WriteN (const char* data, uint32_t count, FILE * f)
     {
       return 0;
     }
+  if (m_writer && f == m_f)
+    {
+      m_writer->Write (data, count);
+      return count;
+    }
   // Write count bytes to h from data
   uint32_t    nLeft   = count;
   const char* p       = data;
@@ -791,6 +921,10 @@ AnimationInterface::DevTxTrace (std::string context,
   double lbTx = (now + txTime).GetSeconds ();
   double fbRx = (now + rxTime - txTime).GetSeconds ();
   double lbRx = (now + rxTime).GetSeconds ();
+  if (!IsPacketTraceNode (tx->GetNode ()->GetId ()) && !IsPacketTraceNode (rx->GetNode ()->GetId ()))
+    {
+      return;
+    }
   CheckMaxPktsPerTraceFile ();
   WriteXmlP ("p", 
              tx->GetNode ()->GetId (), 
@@ -1093,7 +1227,7 @@ AnimationInterface::LteSpectrumPhyTxStart (std::string context, Ptr<const Packet
       AnimPacketInfo pktInfo (ndev, Simulator::Now ());
       AddByteTag (gAnimUid, p);
       AddPendingPacket (AnimationInterface::LTE, gAnimUid, pktInfo);
-      OutputWirelessPacketTxInfo (p, pktInfo, gAnimUid);
+      OutputWirelessPacketTxInfo (p, m_pendingLtePackets[gAnimUid], gAnimUid);
     }
 }
 
@@ -1217,7 +1351,6 @@ AnimationInterface::CsmaMacRxTrace (std::string context,
 void
 AnimationInterface::OutputWirelessPacketTxInfo (Ptr<const Packet> p, AnimPacketInfo &pktInfo, uint64_t animUid)
 {
-  CheckMaxPktsPerTraceFile ();
   uint32_t nodeId = 0;
   if (pktInfo.m_txnd)
     {
@@ -1227,14 +1360,31 @@ AnimationInterface::OutputWirelessPacketTxInfo (Ptr<const Packet> p, AnimPacketI
     {
       nodeId = pktInfo.m_txNodeId;
     }
+  if (!IsPacketTraceNode (nodeId))
+    {
+      // Written with the first reception by a traced node, if any
+      return;
+    }
+  CheckMaxPktsPerTraceFile ();
+  pktInfo.m_txWritten = true;
   WriteXmlPRef (animUid, nodeId, pktInfo.m_fbTx, m_enablePacketMetadata? GetPacketMetadata (p):"");
 }
 
 void 
 AnimationInterface::OutputWirelessPacketRxInfo (Ptr<const Packet> p, AnimPacketInfo & pktInfo, uint64_t animUid)
 {
-  CheckMaxPktsPerTraceFile ();
   uint32_t rxId = pktInfo.m_rxnd->GetNode ()->GetId ();
+  if (!m_packetTraceNodes.empty () && !pktInfo.m_txWritten)
+    {
+      if (!IsPacketTraceNode (rxId))
+        {
+          return;
+        }
+      uint32_t nodeId = pktInfo.m_txnd ? pktInfo.m_txnd->GetNode ()->GetId () : pktInfo.m_txNodeId;
+      pktInfo.m_txWritten = true;
+      WriteXmlPRef (animUid, nodeId, pktInfo.m_fbTx, m_enablePacketMetadata? GetPacketMetadata (p):"");
+    }
+  CheckMaxPktsPerTraceFile ();
   WriteXmlP (animUid, "wpr", rxId, pktInfo.m_fbRx, pktInfo.m_lbRx);
 }
 
@@ -1245,6 +1395,10 @@ AnimationInterface::OutputCsmaPacket (Ptr<const Packet> p, AnimPacketInfo &pktIn
   NS_ASSERT (pktInfo.m_txnd);
   uint32_t nodeId = pktInfo.m_txnd->GetNode ()->GetId ();
   uint32_t rxId = pktInfo.m_rxnd->GetNode ()->GetId ();
+  if (!IsPacketTraceNode (nodeId) && !IsPacketTraceNode (rxId))
+    {
+      return;
+    }
 
   WriteXmlP ("p", 
              nodeId, 
@@ -1441,7 +1595,16 @@ AnimationInterface::StopAnimation (bool onlyAnimation)
     {
       // Terminate the anim element
       WriteXmlClose ("anim");
-      std::fclose (m_f);
+      if (m_writer)
+        {
+          m_writer->Close ();
+          delete m_writer;
+          m_writer = 0;
+        }
+      else
+        {
+          std::fclose (m_f);
+        }
       m_f = 0;
     }
   if (onlyAnimation)
@@ -2630,6 +2793,15 @@ AnimationInterface::WriteXmlUpdateNodePosition (uint32_t nodeId, double x, doubl
   WriteN (element.ToString (), m_f);
 }
 
+void
+AnimationInterface::WriteXmlPositionDeltas (std::string deltas)
+{
+  AnimXmlElement element ("pd");
+  element.AddAttribute ("t", Simulator::Now ().GetSeconds ());
+  element.AddAttribute ("d", deltas);
+  WriteN (element.ToString (), m_f);
+}
+
 void 
 AnimationInterface::WriteXmlUpdateNodeColor (uint32_t nodeId, uint8_t r, uint8_t g, uint8_t b)
 {
@@ -2870,7 +3042,8 @@ AnimationInterface::AnimPacketInfo::AnimPacketInfo ()
     m_txNodeId (0),
     m_fbTx (0), 
     m_lbTx (0), 
-    m_lbRx (0)
+    m_lbRx (0),
+    m_txWritten (false)
 {
 }
 
@@ -2881,6 +3054,7 @@ AnimationInterface::AnimPacketInfo::AnimPacketInfo (const AnimPacketInfo & pInfo
   m_fbTx = pInfo.m_fbTx;
   m_lbTx = pInfo.m_lbTx;
   m_lbRx = pInfo.m_lbRx;
+  m_txWritten = pInfo.m_txWritten;
 }
 
 AnimationInterface::AnimPacketInfo::AnimPacketInfo (Ptr <const NetDevice> txnd, 
@@ -2890,7 +3064,8 @@ AnimationInterface::AnimPacketInfo::AnimPacketInfo (Ptr <const NetDevice> txnd,
     m_txNodeId (0),
     m_fbTx (fbTx.GetSeconds ()), 
     m_lbTx (0), 
-    m_lbRx (0)
+    m_lbRx (0),
+    m_txWritten (false)
 {
   if (!m_txnd)
     m_txNodeId = txNodeId;
@@ -26,6 +26,7 @@
 #include <string>
 #include <cstdio>
 #include <map>
+#include <set>
 
 #include "ns3/ptr.h"
 #include "ns3/net-device.h"
@@ -54,6 +55,7 @@ namespace ns3 {
 
 
 struct NodeSize;
+class AnimationWriter;
 
 /**
  * \defgroup netanim Network Animation
@@ -376,6 +378,49 @@ public:
    */
   void SkipPacketTracing ();
 
+  /**
+   * \brief Only trace the packets sent or received by some nodes. This helps reduce
+   *        the trace file size when only part of a large network is of interest.
+   *        A wireless transmission from a node outside the set is written with its first
+   *        reception by a node of the set.
+   * \param nc The nodes whose packets are traced. If empty, all packets are traced (default)
+   * \returns none
+   */
+  void SetPacketTraceNodes (NodeContainer nc);
+
+  /**
+   * \brief Write the trace file through a buffered writer. When ns-3 is built with
+   *        threading support, the writes are done by a background thread while the
+   *        simulation goes on. The file content is unchanged, unless compressed.
+   *        Call right after the constructor, before the simulation starts.
+   * \param compress Write a gzip compressed file, which must be decompressed (e.g. with
+   *        gunzip) before loading it in NetAnim. Needs ns-3 built with zlib,
+   *        see IsCompressionSupported
+   * \returns none
+   */
+  void EnableStreamingOutput (bool compress = false);
+
+  /**
+   * \brief Check if compressed trace files are supported
+   * \returns true if ns-3 was built with zlib
+   */
+  static bool IsCompressionSupported (void);
+
+  /**
+   * \brief Write the node positions only every interval, instead of on every course change
+   *        and every mobility poll. A position is written when it changed by at least 1 cm
+   *        since the last written one.
+   *
+   * \param t Time interval between position samples
+   * \param deltas Write each sample as a single "pd" element, holding the offsets of the
+   *        moved nodes from their last written positions, instead of one "nu" element
+   *        per node. The "d" attribute of the element is a ';' separated list of
+   *        "id dx dy" offsets, in integer cm. This is much more compact, but is not
+   *        understood by NetAnim 3.108
+   * \returns none
+   */
+  void EnablePositionSampling (Time t, bool deltas = false);
+
   /**
    *
    * \brief Enable Packet metadata
@@ -453,6 +498,7 @@ private:
     double m_fbRx; ///< fb receive
     double m_lbRx; ///< lb receive
     Ptr <const NetDevice> m_rxnd; ///< receive device
+    bool m_txWritten; ///< whether the transmission was written
     /**
      * Process receive begin
      * \param nd the device
@@ -633,6 +679,12 @@ private:
   Time m_wifiPhyCountersPollInterval; ///< wifi Phy counters poll interval
   static Rectangle * userBoundary; ///< user boundary
   bool m_trackPackets; ///< track packets
+  std::set <uint32_t> m_packetTraceNodes; ///< nodes whose packets are traced, all if empty
+  AnimationWriter * m_writer; ///< buffered writer of m_f, 0 if not streaming
+  bool m_positionSampling; ///< write positions only when sampled
+  bool m_positionDeltas; ///< write the position samples as offsets
+  Time m_positionSampleInterval; ///< position sample interval
+  std::map <uint32_t, std::pair<int64_t, int64_t> > m_sampledPositions; ///< last written node positions, in cm
 
   // Counter ID
   uint32_t m_remainingEnergyCounterId; ///< remaining energy counter ID
@@ -806,6 +858,14 @@ private:
   std::string GetNetAnimVersion ();
   /// Mobility auto check function
   void MobilityAutoCheck ();
+  /// Write the sampled positions of the moved nodes, see EnablePositionSampling
+  void SamplePositions ();
+  /**
+   * Check if the packets of a node are traced, see SetPacketTraceNodes
+   * \param nodeId the node ID
+   * \returns true if the packets of the node are traced
+   */
+  bool IsPacketTraceNode (uint32_t nodeId) const;
   /**
    * Is packet pending function
    * \param animUid the UID
@@ -1322,6 +1382,11 @@ private:
    * \param y the Y position
    */
   void WriteXmlUpdateNodePosition (uint32_t nodeId, double x, double y);
+  /**
+   * Write XML node position offsets function
+   * \param deltas the ';' separated "id dx dy" offsets
+   */
+  void WriteXmlPositionDeltas (std::string deltas);
   /**
    * Write XML update node color function
    * \param nodeId the node ID
@@ -0,0 +1,205 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "animation-writer.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AnimationWriter");
+
+AnimationWriter::AnimationWriter (FILE * f, bool compress)
+  : m_file (f)
+#ifdef NS3_ZLIB
+  , m_gzFile (0)
+#endif
+#ifdef HAVE_PTHREAD_H
+  , m_pending (0),
+  m_stop (false)
+#endif
+{
+  NS_LOG_FUNCTION (this << f << compress);
+  NS_ASSERT (f);
+  if (compress)
+    {
+#ifdef NS3_ZLIB
+      // The compressed stream gets its own descriptor, so that closing it
+      // does not close the descriptor of m_file
+      std::fflush (m_file);
+      int fd = dup (fileno (m_file));
+      m_gzFile = fd < 0 ? 0 : gzdopen (fd, "wb");
+      if (!m_gzFile)
+        {
+          NS_FATAL_ERROR ("Unable to open a compressed stream on the animation trace file");
+        }
+#else
+      NS_FATAL_ERROR ("Compressed animation traces need ns-3 to be built with zlib");
+#endif
+    }
+  m_chunk.reserve (CHUNK_SIZE);
+#ifdef HAVE_PTHREAD_H
+  m_thread = Create<SystemThread> (MakeCallback (&AnimationWriter::Run, this));
+  m_thread->Start ();
+#endif
+}
+
+AnimationWriter::~AnimationWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+AnimationWriter::IsCompressionSupported (void)
+{
+#ifdef NS3_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool
+AnimationWriter::IsBackgroundWriteSupported (void)
+{
+#ifdef HAVE_PTHREAD_H
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+AnimationWriter::Write (const char * data, uint32_t count)
+{
+  NS_ASSERT (m_file);
+  m_chunk.append (data, count);
+  if (m_chunk.size () >= CHUNK_SIZE)
+    {
+      Flush ();
+    }
+}
+
+void
+AnimationWriter::Flush (void)
+{
+  if (m_chunk.empty ())
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  while (m_pending.load () >= MAX_PENDING_CHUNKS)
+    {
+      // The condition is cleared before checking again, so that a chunk
+      // written in between wakes this wait up
+      m_written.SetCondition (false);
+      if (m_pending.load () >= MAX_PENDING_CHUNKS)
+        {
+          m_written.TimedWait (1000000);
+        }
+    }
+  std::string * chunk = new std::string;
+  chunk->swap (m_chunk);
+  m_chunk.reserve (CHUNK_SIZE);
+  ++m_pending;
+  m_chunks.Push (chunk);
+  m_queued.SetCondition (true);
+  m_queued.Signal ();
+#else
+  WriteChunk (m_chunk);
+  m_chunk.clear ();
+#endif
+}
+
+void
+AnimationWriter::WriteChunk (const std::string & chunk)
+{
+#ifdef NS3_ZLIB
+  if (m_gzFile)
+    {
+      if (gzwrite (m_gzFile, chunk.data (), chunk.size ()) != static_cast<int> (chunk.size ()))
+        {
+          NS_LOG_WARN ("Unable to write to the compressed animation trace file");
+        }
+      return;
+    }
+#endif
+  if (std::fwrite (chunk.data (), 1, chunk.size (), m_file) != chunk.size ())
+    {
+      NS_LOG_WARN ("Unable to write to the animation trace file");
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+AnimationWriter::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      m_queued.SetCondition (false);
+      // Close queues the last chunk before setting m_stop, so the chunks
+      // are all visible once m_stop is seen
+      bool stop = m_stop.load ();
+      std::string * chunk;
+      while (m_chunks.Pop (chunk))
+        {
+          WriteChunk (*chunk);
+          delete chunk;
+          --m_pending;
+          m_written.SetCondition (true);
+          m_written.Signal ();
+        }
+      if (stop)
+        {
+          return;
+        }
+      m_queued.TimedWait (10000000);
+    }
+}
+#endif
+
+void
+AnimationWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_file)
+    {
+      return;
+    }
+  Flush ();
+#ifdef HAVE_PTHREAD_H
+  m_stop.store (true);
+  m_queued.SetCondition (true);
+  m_queued.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+#endif
+#ifdef NS3_ZLIB
+  if (m_gzFile)
+    {
+      gzclose (m_gzFile);
+      m_gzFile = 0;
+    }
+#endif
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+} // namespace ns3
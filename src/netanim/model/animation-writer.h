@@ -0,0 +1,116 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ANIMATION_WRITER_H
+#define ANIMATION_WRITER_H
+
+#include "ns3/core-config.h"
+#include "ns3/ptr.h"
+#include "ns3/mpsc-queue.h"
+#include <cstdio>
+#include <string>
+#include <atomic>
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-condition.h"
+#endif
+#ifdef NS3_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup netanim
+ *
+ * \brief Buffered writer of an animation trace file, used by
+ * AnimationInterface::EnableStreamingOutput. This header is internal to
+ * the netanim module.
+ *
+ * Writes are gathered in memory into chunks of CHUNK_SIZE bytes. With
+ * threading support, full chunks are handed to a background thread which
+ * writes (and compresses) them while the simulation goes on; the caller
+ * only waits when the thread falls MAX_PENDING_CHUNKS behind. Without
+ * threading support, full chunks are written by the caller.
+ */
+class AnimationWriter
+{
+public:
+  /**
+   * \brief Constructor
+   * \param f the open file to write to, closed by Close
+   * \param compress whether to write gzip compressed data
+   */
+  AnimationWriter (FILE * f, bool compress);
+  /// Destructor, closes the file if still open
+  ~AnimationWriter ();
+
+  /**
+   * \brief Write data
+   * \param data the data
+   * \param count the number of bytes
+   */
+  void Write (const char * data, uint32_t count);
+
+  /// Write the buffered data, wait for the background thread and close the file
+  void Close (void);
+
+  /**
+   * \brief Check if the module was built with zlib
+   * \return true if compressed output is supported
+   */
+  static bool IsCompressionSupported (void);
+
+  /**
+   * \brief Check if the data are written by a background thread
+   * \return true if built with threading support
+   */
+  static bool IsBackgroundWriteSupported (void);
+
+private:
+  /// Hand the current chunk to the background thread, or write it
+  void Flush (void);
+  /**
+   * \brief Write a chunk to the file
+   * \param chunk the chunk
+   */
+  void WriteChunk (const std::string & chunk);
+
+  static const uint32_t CHUNK_SIZE = 64 * 1024; ///< chunk size, in bytes
+  static const uint32_t MAX_PENDING_CHUNKS = 64; ///< chunks queued for the thread before Write waits
+
+  FILE * m_file; ///< the file
+#ifdef NS3_ZLIB
+  gzFile m_gzFile; ///< the compressed stream on the file, or 0 if not compressing
+#endif
+  std::string m_chunk; ///< the chunk being filled
+
+#ifdef HAVE_PTHREAD_H
+  /// Background thread loop, writing the queued chunks until Close
+  void Run (void);
+
+  Ptr<SystemThread> m_thread; ///< the background thread
+  MpscQueue<std::string *> m_chunks; ///< full chunks, for the background thread
+  std::atomic<uint32_t> m_pending; ///< number of chunks queued and not yet written
+  std::atomic<bool> m_stop; ///< whether Close has queued the last chunk
+  SystemCondition m_queued; ///< set when a chunk is queued, or on Close
+  SystemCondition m_written; ///< set when a chunk is written
+#endif
+};
+
+} // namespace ns3
+
+#endif /* ANIMATION_WRITER_H */
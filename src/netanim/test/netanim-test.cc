@@ -18,6 +18,8 @@
  */
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include "unistd.h"
 
 #include "ns3/core-module.h"
@@ -27,6 +29,7 @@
 #include "ns3/netanim-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-layout-module.h"
+#include "ns3/mobility-module.h"
 #include "ns3/basic-energy-source.h"
 #include "ns3/simple-device-energy-model.h"
 
@@ -253,6 +256,172 @@ AnimationRemainingEnergyTestCase::CheckLogic (void)
                             "Wrong remaining energy value was traced");
 }
 
+/**
+ * \ingroup netanim-test
+ * \ingroup tests
+ *
+ * \brief Check that the streaming output gives the same trace as the default
+ * output, and check the packet trace node set and the position offsets
+ */
+class AnimationStreamingTestCase : public TestCase
+{
+public:
+  AnimationStreamingTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run two pairs of nodes exchanging packets, with node 0 moving.
+   * \param fileName the trace file name
+   * \param streaming whether to enable the streaming output
+   * \param compress whether to compress the streaming output
+   * \param traceNode0 whether to trace the packets of node 0 only
+   * \param deltas whether to sample the positions as offsets
+   * \returns the number of packets traced
+   */
+  uint64_t Run (std::string fileName, bool streaming, bool compress, bool traceNode0, bool deltas);
+
+  /**
+   * Read a file.
+   * \param fileName the file name
+   * \returns the file content
+   */
+  static std::string ReadFile (std::string fileName);
+};
+
+AnimationStreamingTestCase::AnimationStreamingTestCase ()
+  : TestCase ("Verify streaming output, packet trace nodes and position offsets")
+{
+}
+
+std::string
+AnimationStreamingTestCase::ReadFile (std::string fileName)
+{
+  std::ifstream in (fileName.c_str (), std::ios::binary);
+  std::ostringstream content;
+  content << in.rdbuf ();
+  return content.str ();
+}
+
+uint64_t
+AnimationStreamingTestCase::Run (std::string fileName, bool streaming, bool compress, bool traceNode0, bool deltas)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->GetObject<MobilityModel> ()->SetPosition (Vector (10 + 5 * i, 20, 0));
+    }
+  nodes.Get (0)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (1.5, 0.5, 0));
+
+  PointToPointHelper pointToPoint;
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  for (uint32_t i = 0; i < nodes.GetN (); i += 2)
+    {
+      NetDeviceContainer devices = pointToPoint.Install (nodes.Get (i), nodes.Get (i + 1));
+      // The same addresses in every run, as they are written in the trace
+      for (uint32_t j = 0; j < devices.GetN (); j++)
+        {
+          uint8_t buffer[6] = {0, 0, 0, 0, 0, static_cast<uint8_t> (i + j + 1)};
+          Mac48Address mac;
+          mac.CopyFrom (buffer);
+          devices.Get (j)->SetAddress (mac);
+        }
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      UdpEchoServerHelper echoServer (9);
+      echoServer.Install (nodes.Get (i + 1)).Start (Seconds (1.0));
+      UdpEchoClientHelper echoClient (interfaces.GetAddress (1), 9);
+      echoClient.SetAttribute ("MaxPackets", UintegerValue (100));
+      echoClient.SetAttribute ("Interval", TimeValue (Seconds (0.5)));
+      echoClient.Install (nodes.Get (i)).Start (Seconds (2.0));
+    }
+
+  uint64_t count;
+  {
+    AnimationInterface anim (fileName);
+    if (streaming)
+      {
+        anim.EnableStreamingOutput (compress);
+      }
+    if (traceNode0)
+      {
+        anim.SetPacketTraceNodes (NodeContainer (nodes.Get (0)));
+      }
+    if (deltas)
+      {
+        anim.EnablePositionSampling (Seconds (0.3), true);
+      }
+    Simulator::Stop (Seconds (10));
+    Simulator::Run ();
+    count = anim.GetTracePktCount ();
+  }
+  Simulator::Destroy ();
+  return count;
+}
+
+void
+AnimationStreamingTestCase::DoRun (void)
+{
+  std::string defaultFile = CreateTempDirFilename ("netanim-default.xml");
+  std::string streamingFile = CreateTempDirFilename ("netanim-streaming.xml");
+  uint64_t count = Run (defaultFile, false, false, false, false);
+  NS_TEST_ASSERT_MSG_GT (count, 0, "No packets traced");
+  NS_TEST_ASSERT_MSG_EQ (Run (streamingFile, true, false, false, false), count, "Wrong packet count");
+  std::string trace = ReadFile (defaultFile);
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (streamingFile) == trace), true, "Streaming output differs from default output");
+  NS_TEST_ASSERT_MSG_NE (trace.find ("<nu p=\"p\""), std::string::npos, "No position updates");
+
+  // Only the pair of node 0 is traced
+  std::string filteredFile = CreateTempDirFilename ("netanim-filtered.xml");
+  NS_TEST_ASSERT_MSG_EQ (Run (filteredFile, false, false, true, false) * 2, count, "Wrong filtered packet count");
+
+  // The offsets add up to the last sampled position, at 9.9 s
+  std::string deltasFile = CreateTempDirFilename ("netanim-deltas.xml");
+  Run (deltasFile, false, false, false, true);
+  trace = ReadFile (deltasFile);
+  NS_TEST_ASSERT_MSG_EQ (trace.find ("<nu p=\"p\""), std::string::npos, "Unexpected position update");
+  int64_t x = 1000;
+  int64_t y = 2000;
+  uint32_t samples = 0;
+  for (std::size_t pos = trace.find ("<pd "); pos != std::string::npos; pos = trace.find ("<pd ", pos + 1))
+    {
+      std::size_t start = trace.find (" d=\"", pos) + 4;
+      std::istringstream deltas (trace.substr (start, trace.find ('"', start) - start));
+      std::string delta;
+      while (std::getline (deltas, delta, ';'))
+        {
+          uint32_t id;
+          int64_t dx, dy;
+          std::istringstream (delta) >> id >> dx >> dy;
+          NS_TEST_ASSERT_MSG_EQ (id, 0, "Only node 0 moves");
+          x += dx;
+          y += dy;
+        }
+      samples++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (samples, 33, "Wrong number of position samples");
+  NS_TEST_ASSERT_MSG_EQ (x, 2485, "Wrong x position");
+  NS_TEST_ASSERT_MSG_EQ (y, 2495, "Wrong y position");
+
+  if (AnimationInterface::IsCompressionSupported ())
+    {
+      std::string compressedFile = CreateTempDirFilename ("netanim-streaming.xml.gz");
+      Run (compressedFile, true, true, false, false);
+      std::string compressed = ReadFile (compressedFile);
+      NS_TEST_ASSERT_MSG_EQ ((compressed.size () > 2 && compressed[0] == '\x1f' && compressed[1] == '\x8b'), true,
+                             "Not a gzip file");
+      NS_TEST_ASSERT_MSG_LT (compressed.size (), ReadFile (defaultFile).size (), "Compressed file is not smaller");
+    }
+}
+
 /**
  * \ingroup netanim-test
  * \ingroup tests
@@ -267,5 +436,6 @@ public:
   {
     AddTestCase (new AnimationInterfaceTestCase (), TestCase::QUICK);
     AddTestCase (new AnimationRemainingEnergyTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationStreamingTestCase (), TestCase::QUICK);
   }
 } g_animationInterfaceTestSuite; ///< the test suite
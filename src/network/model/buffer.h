@@ -25,8 +25,6 @@
 #include <ostream>
 #include "ns3/assert.h"
 
-#define BUFFER_FREE_LIST 1
-
 namespace ns3 {
 
 /**
@@ -527,6 +525,11 @@ private:
    * Add bytes at the end of the Buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
+   *
+   * Appending the fragment of a buffer which follows this one
+   * (see CreateFragment) references the bytes in place rather than
+   * copying them, and a zero area at the start of \p o is merged
+   * into a zero area at the end of this buffer.
    */
   void AddAtEnd (const Buffer &o);
   /**
@@ -726,6 +729,14 @@ private:
    */
   uint32_t GetInternalEnd (void) const;
 
+  /**
+   * \brief Move the bytes of this buffer to new data storage of its own
+   * \param end the number of bytes to reserve after the end of the buffer
+   *
+   * The zero area stays virtual: only the bytes around it are copied.
+   */
+  void Reallocate (uint32_t end);
+
   /**
    * \brief Recycle the buffer memory
    * \param data the buffer data storage
@@ -767,7 +778,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -789,19 +800,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
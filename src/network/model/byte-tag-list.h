@@ -194,6 +194,12 @@ private:
    */ 
   void RemoveAll (void);
 
+  /**
+   * Copy the tags if they are shared with another ByteTagList, so that
+   * this list owns its data.
+   */
+  void Unshare (void);
+
   /**
    * \param offsetStart the offset which uniquely identifies the first data byte 
    *        present in the byte buffer associated to this ByteTagList.
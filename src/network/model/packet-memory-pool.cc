@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-memory-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketMemoryPool implementation.
+ */
+
+namespace ns3 {
+
+/*
+ * Each size class has a singly-linked free list per thread.  The batch
+ * size of a class is the number of its blocks which fit in
+ * g_poolSlabSize bytes (at least one).  A thread keeps at most
+ * g_poolThreadBatches batches of free blocks per class and moves the
+ * excess, a batch at a time, to a shared depot; its whole free lists go
+ * to the depot when it exits.  An empty free list is refilled with a
+ * batch from the depot or, if there is none, by carving a batch out of
+ * one heap allocation (a slab).  Packets created by one thread and
+ * released by another thus do not make the pool grow without bound.
+ *
+ * Slabs are never returned to the system, since the blocks of a slab
+ * are spread over many threads.  Every slab is kept reachable from
+ * g_poolSlabs so leak checkers stay quiet.
+ *
+ * Logging is avoided here: these functions run for every packet.
+ */
+namespace {
+
+#ifdef PACKET_MEMORY_POOL
+/** Block size of each size class, in bytes; all multiples of 16. */
+const std::size_t g_poolClassSizes[] = {
+  32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072,
+  4096, 6144, 8192, 12288, 16384, 24576, 32768, 49152, 65536
+};
+/** Number of size classes; larger sizes use the global heap. */
+const std::size_t g_poolClasses = sizeof (g_poolClassSizes) / sizeof (g_poolClassSizes[0]);
+/** Size of the slabs, in bytes, unless a single block is larger. */
+const std::size_t g_poolSlabSize = 16384;
+/** Number of batches of free blocks per size class a thread keeps for itself. */
+const std::size_t g_poolThreadBatches = 2;
+
+/** An unused block, linked in a free list. */
+struct PoolBlock
+{
+  PoolBlock *next;       //!< Next free block of the same size class.
+  PoolBlock *nextBatch;  //!< Next batch in the depot, set on the first block of a batch.
+};
+
+/** The free list of one size class in one thread. */
+struct PoolFreeList
+{
+  PoolBlock *head;    //!< First free block.
+  std::size_t count;  //!< Number of blocks in the list.
+  std::size_t limit;  //!< Largest count kept, or 0 until the first PoolSpill.
+};
+
+/** Batches of free blocks given up by threads, one stack per size class. */
+PoolBlock *g_poolDepot[g_poolClasses];
+
+/** Protects g_poolDepot; only taken once per batch. */
+std::atomic_flag g_poolDepotLock = ATOMIC_FLAG_INIT;
+
+/** Slab header, padded so the blocks which follow are suitably aligned. */
+union PoolSlab
+{
+  PoolSlab *next;          //!< Next slab in g_poolSlabs.
+  std::max_align_t align;  //!< Alignment padding.
+};
+
+/** All slabs ever allocated, by any thread. */
+std::atomic<PoolSlab *> g_poolSlabs (0);
+#endif /* PACKET_MEMORY_POOL */
+
+/**
+ * Per-thread state of the pool, in a single structure so that each call
+ * looks up the thread-local storage once.
+ */
+struct PoolCache
+{
+  uint64_t allocations;      //!< Number of calls to Allocate.
+  uint64_t heapAllocations;  //!< Number of global heap allocations.
+#ifdef PACKET_MEMORY_POOL
+  bool hooked;                            //!< PoolExitHook armed in this thread.
+  PoolFreeList freeLists[g_poolClasses];  //!< Free lists, one per size class.
+#endif /* PACKET_MEMORY_POOL */
+};
+
+/** The pool of the current thread. */
+thread_local PoolCache g_poolCache;
+
+#ifdef PACKET_MEMORY_POOL
+/**
+ * \param [in] index The size class index.
+ * \returns The number of blocks moved at once to or from the depot,
+ *          and carved from each slab.
+ */
+inline std::size_t
+PoolGetBatch (std::size_t index)
+{
+  return std::max<std::size_t> (1, g_poolSlabSize / g_poolClassSizes[index]);
+}
+
+/**
+ * Push a chain of free blocks onto the depot.
+ * \param [in] index The size class index.
+ * \param [in] batch The first block of a null-terminated chain.
+ */
+void
+PoolDepotPush (std::size_t index, PoolBlock *batch)
+{
+  while (g_poolDepotLock.test_and_set (std::memory_order_acquire))
+    {
+    }
+  batch->nextBatch = g_poolDepot[index];
+  g_poolDepot[index] = batch;
+  g_poolDepotLock.clear (std::memory_order_release);
+}
+
+/**
+ * Pop a chain of free blocks from the depot.
+ * \param [in] index The size class index.
+ * \returns The first block of the chain, or 0 if the depot is empty.
+ */
+PoolBlock *
+PoolDepotPop (std::size_t index)
+{
+  while (g_poolDepotLock.test_and_set (std::memory_order_acquire))
+    {
+    }
+  PoolBlock *batch = g_poolDepot[index];
+  if (batch != 0)
+    {
+      g_poolDepot[index] = batch->nextBatch;
+    }
+  g_poolDepotLock.clear (std::memory_order_release);
+  return batch;
+}
+
+/** Returns the free blocks of a thread to the depot when the thread exits. */
+struct PoolExitHook
+{
+  ~PoolExitHook ()
+  {
+    for (std::size_t index = 0; index < g_poolClasses; ++index)
+      {
+        PoolFreeList &list = g_poolCache.freeLists[index];
+        if (list.head != 0)
+          {
+            PoolDepotPush (index, list.head);
+          }
+        list.head = 0;
+        list.count = 0;
+      }
+  }
+};
+
+/** Armed on the first slow path taken by each thread. */
+thread_local PoolExitHook g_poolExitHook;
+
+/**
+ * Make sure the free lists of this thread go to the depot on thread exit.
+ *
+ * Blocks released after the hook ran (by destructors of other thread
+ * locals or statics) stay in the thread's lists and are lost with it.
+ *
+ * \param [in,out] cache The pool of the current thread.
+ */
+void
+PoolHook (PoolCache &cache)
+{
+  if (!cache.hooked)
+    {
+      cache.hooked = true;
+      // Odr-use the thread_local so its destructor is registered.
+      static_cast<void> (&g_poolExitHook);
+    }
+}
+
+/**
+ * \param [in] size A size, in bytes.
+ * \returns The index of the smallest size class which holds \p size,
+ *          or g_poolClasses if there is none.
+ */
+inline std::size_t
+PoolGetClass (std::size_t size)
+{
+  return std::lower_bound (g_poolClassSizes, g_poolClassSizes + g_poolClasses, size)
+         - g_poolClassSizes;
+}
+
+/**
+ * Refill an empty free list, from the depot if it has a batch and
+ * otherwise from a new slab.
+ * \param [in,out] cache The pool of the current thread.
+ * \param [in] index The size class index.
+ */
+void
+PoolRefill (PoolCache &cache, std::size_t index)
+{
+  PoolHook (cache);
+  PoolFreeList &list = cache.freeLists[index];
+
+  PoolBlock *batch = PoolDepotPop (index);
+  if (batch != 0)
+    {
+      std::size_t count = 0;
+      for (PoolBlock *block = batch; block != 0; block = block->next)
+        {
+          ++count;
+        }
+      list.head = batch;
+      list.count = count;
+      return;
+    }
+
+  std::size_t blockSize = g_poolClassSizes[index];
+  std::size_t nBlocks = PoolGetBatch (index);
+  char *raw = static_cast<char *> (::operator new (sizeof (PoolSlab) + blockSize * nBlocks));
+  cache.heapAllocations++;
+
+  PoolSlab *slab = reinterpret_cast<PoolSlab *> (raw);
+  slab->next = g_poolSlabs.load (std::memory_order_relaxed);
+  while (!g_poolSlabs.compare_exchange_weak (slab->next, slab, std::memory_order_release,
+                                             std::memory_order_relaxed))
+    {
+    }
+
+  char *blocks = raw + sizeof (PoolSlab);
+  for (std::size_t i = 0; i < nBlocks - 1; ++i)
+    {
+      reinterpret_cast<PoolBlock *> (blocks + i * blockSize)->next =
+        reinterpret_cast<PoolBlock *> (blocks + (i + 1) * blockSize);
+    }
+  reinterpret_cast<PoolBlock *> (blocks + (nBlocks - 1) * blockSize)->next = 0;
+  list.head = reinterpret_cast<PoolBlock *> (blocks);
+  list.count = nBlocks;
+}
+
+/**
+ * Move one batch from a free list over its limit to the depot.
+ *
+ * The limit is only set here, so that Deallocate need not compute it:
+ * the first call merely sets it.
+ *
+ * \param [in,out] cache The pool of the current thread.
+ * \param [in] index The size class index.
+ */
+void
+PoolSpill (PoolCache &cache, std::size_t index)
+{
+  PoolHook (cache);
+  PoolFreeList &list = cache.freeLists[index];
+  std::size_t nBlocks = PoolGetBatch (index);
+  if (list.limit == 0)
+    {
+      list.limit = g_poolThreadBatches * nBlocks;
+      if (list.count <= list.limit)
+        {
+          return;
+        }
+    }
+
+  PoolBlock *batch = list.head;
+  PoolBlock *last = batch;
+  for (std::size_t i = 1; i < nBlocks; ++i)
+    {
+      last = last->next;
+    }
+  list.head = last->next;
+  list.count -= nBlocks;
+  last->next = 0;
+  PoolDepotPush (index, batch);
+}
+#endif /* PACKET_MEMORY_POOL */
+
+} // unnamed namespace
+
+void *
+PacketMemoryPool::Allocate (std::size_t size)
+{
+  PoolCache &cache = g_poolCache;
+  cache.allocations++;
+#ifdef PACKET_MEMORY_POOL
+  std::size_t index = PoolGetClass (size);
+  if (index < g_poolClasses)
+    {
+      PoolFreeList &list = cache.freeLists[index];
+      if (list.head == 0)
+        {
+          PoolRefill (cache, index);
+        }
+      PoolBlock *block = list.head;
+      list.head = block->next;
+      --list.count;
+      return block;
+    }
+#endif /* PACKET_MEMORY_POOL */
+  cache.heapAllocations++;
+  return ::operator new (size);
+}
+
+void
+PacketMemoryPool::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+#ifdef PACKET_MEMORY_POOL
+  std::size_t index = PoolGetClass (size);
+  if (index < g_poolClasses)
+    {
+      PoolCache &cache = g_poolCache;
+      PoolFreeList &list = cache.freeLists[index];
+      PoolBlock *block = static_cast<PoolBlock *> (p);
+      block->next = list.head;
+      list.head = block;
+      if (++list.count > list.limit)
+        {
+          PoolSpill (cache, index);
+        }
+      return;
+    }
+#endif /* PACKET_MEMORY_POOL */
+  ::operator delete (p);
+}
+
+std::size_t
+PacketMemoryPool::GetBlockSize (std::size_t size)
+{
+#ifdef PACKET_MEMORY_POOL
+  std::size_t index = PoolGetClass (size);
+  if (index < g_poolClasses)
+    {
+      return g_poolClassSizes[index];
+    }
+#endif /* PACKET_MEMORY_POOL */
+  return size;
+}
+
+uint64_t
+PacketMemoryPool::GetNAllocations (void)
+{
+  return g_poolCache.allocations;
+}
+
+uint64_t
+PacketMemoryPool::GetNHeapAllocations (void)
+{
+  return g_poolCache.heapAllocations;
+}
+
+} // namespace ns3
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_MEMORY_POOL_H
+#define PACKET_MEMORY_POOL_H
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketMemoryPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Size-class allocator for the storage of packets: the
+ * PacketTagList::TagData nodes and the Buffer::Data byte buffers.
+ *
+ * Sizes are rounded up to a size class: 32 bytes, then alternately
+ * 1.5 and 2 times the previous class, up to 64 KiB.  Each size class has
+ * its own free list per thread, so Allocate and Deallocate take no lock
+ * and never reach the global heap once the pool is warm.  Empty free
+ * lists are refilled from slabs, and larger sizes use the global heap.
+ * Configuring ns-3 with --disable-packet-pool sends every request to
+ * the global heap, for example to check memory with valgrind.
+ *
+ * Storage may be released by a thread other than the one which
+ * allocated it.  A thread keeps a bounded number of free blocks per size
+ * class and hands any excess back to a shared depot, as it does with all
+ * of its blocks when it exits; empty free lists take from the depot
+ * before cutting new slabs.  The slabs are never returned to the system.
+ */
+class PacketMemoryPool
+{
+public:
+  /**
+   * Allocate storage from the calling thread's pool.
+   * \param [in] size The size of the storage, in bytes.
+   * \returns The storage, aligned for any type.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release storage to the calling thread's pool.
+   * \param [in] p The storage, from Allocate, or 0.
+   * \param [in] size The size passed to Allocate, or any other size with
+   *             the same GetBlockSize.
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * \param [in] size A size, in bytes.
+   * \returns The size of the storage returned by Allocate for \pname{size},
+   *          which can all be used.
+   */
+  static std::size_t GetBlockSize (std::size_t size);
+  /**
+   * \returns The number of calls to Allocate made by the calling thread.
+   */
+  static uint64_t GetNAllocations (void);
+  /**
+   * \returns The number of global heap allocations made by the calling
+   *          thread for Allocate, for slabs and for sizes too large to be
+   *          pooled.
+   */
+  static uint64_t GetNHeapAllocations (void);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_MEMORY_POOL_H */
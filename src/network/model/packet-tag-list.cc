@@ -43,8 +43,8 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p = PacketMemoryPool::Allocate (sizeof (TagData) + dataSize - 1);
+  // The matching deallocations are in RemoveAll and RemoveWriter
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
@@ -172,6 +172,26 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 
 }
 
+void
+PacketTagList::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct TagData * head = 0;
+  struct TagData ** prevNext = &head;
+  for (struct TagData * cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData * copy = CreateTagData (cur->size);
+      copy->tid = cur->tid;
+      copy->count = 1;
+      memcpy (copy->data, cur->data, copy->size);
+      *prevNext = copy;
+      prevNext = &copy->next;
+    }
+  *prevNext = 0;
+  RemoveAll ();
+  m_next = head;
+}
+
 bool
 PacketTagList::Remove (Tag & tag)
 {
@@ -195,7 +215,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
     {
       // found tid before first merge, so delete cur
       cur->~TagData ();
-      std::free (cur);
+      PacketMemoryPool::Deallocate (cur, sizeof (TagData) + cur->size - 1);
     }
   else
     {
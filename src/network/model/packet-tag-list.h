@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "packet-memory-pool.h"
 
 namespace ns3 {
 
@@ -136,7 +137,7 @@ public:
    *
    * We use placement new so we can allocate enough room for the Tag
    * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
+   * for a similar construction.  The storage comes from PacketMemoryPool.
    */
   struct TagData
   {
@@ -213,6 +214,11 @@ public:
    * Remove all tags from this list (up to the first merge).
    */
   inline void RemoveAll (void);
+  /**
+   * Copy the tags shared with other lists, so that this list owns all
+   * of its \ref TagData.
+   */
+  void Unshare (void);
   /**
    * \returns pointer to head of tag list
    */
@@ -342,14 +348,14 @@ PacketTagList::RemoveAll (void)
       if (prev != 0) 
         {
           prev->~TagData ();
-          std::free (prev);
+          PacketMemoryPool::Deallocate (prev, sizeof (TagData) + prev->size - 1);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
       prev->~TagData ();
-      std::free (prev);
+      PacketMemoryPool::Deallocate (prev, sizeof (TagData) + prev->size - 1);
     }
   m_next = 0;
 }
@@ -376,6 +376,65 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // Segment and reassemble, as done by RLC
+  uint8_t data[1000];
+  for (uint32_t j = 0; j < sizeof (data); j++)
+    {
+      data[j] = j * 7;
+    }
+  uint8_t got[1000];
+  buffer = Buffer ();
+  buffer.AddAtStart (sizeof (data));
+  buffer.Begin ().Write (data, sizeof (data));
+  Buffer reassembled;
+  for (uint32_t start = 0; start < sizeof (data); start += 30)
+    {
+      // adjacent fragments are joined in place
+      reassembled.AddAtEnd (buffer.CreateFragment (start, std::min<uint32_t> (30, sizeof (data) - start)));
+    }
+  NS_TEST_ASSERT_MSG_EQ (reassembled.GetSize (), sizeof (data), "Bad reassembled size");
+  reassembled.CopyData (got, sizeof (got));
+  NS_TEST_ASSERT_MSG_EQ (memcmp (got, data, sizeof (data)), 0, "Bad reassembled data");
+  reassembled = Buffer ();
+  for (uint32_t start = 0; start < sizeof (data); start += 30)
+    {
+      Buffer fragment = buffer.CreateFragment (start, std::min<uint32_t> (30, sizeof (data) - start));
+      fragment.AddAtStart (2);
+      fragment.Begin ().WriteU16 (0xffff);
+      fragment.RemoveAtStart (2);
+      reassembled.AddAtEnd (fragment);
+    }
+  NS_TEST_ASSERT_MSG_EQ (reassembled.GetSize (), sizeof (data), "Bad reassembled size");
+  reassembled.CopyData (got, sizeof (got));
+  NS_TEST_ASSERT_MSG_EQ (memcmp (got, data, sizeof (data)), 0, "Bad reassembled data");
+  reassembled = buffer.CreateFragment (500, 500);
+  reassembled.AddAtEnd (buffer.CreateFragment (0, 500));
+  reassembled.CopyData (got, sizeof (got));
+  NS_TEST_ASSERT_MSG_EQ (memcmp (got, data + 500, 500), 0, "Bad swapped fragments");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (got + 500, data, 500), 0, "Bad swapped fragments");
+
+  // Reassemble fragments of a zero area, which stays virtual
+  buffer = Buffer (sizeof (data) - 10);
+  buffer.AddAtStart (10);
+  buffer.Begin ().Write (data, 10);
+  reassembled = buffer.CreateFragment (0, 30);
+  for (uint32_t start = 30; start < sizeof (data); start += 30)
+    {
+      Buffer fragment = buffer.CreateFragment (start, std::min<uint32_t> (30, sizeof (data) - start));
+      fragment.AddAtStart (2);
+      fragment.Begin ().WriteU16 (0xffff);
+      fragment.RemoveAtStart (2);
+      reassembled.AddAtEnd (fragment);
+    }
+  NS_TEST_ASSERT_MSG_EQ (reassembled.GetSize (), sizeof (data), "Bad reassembled size");
+  NS_TEST_ASSERT_MSG_LT (reassembled.GetSerializedSize (), 100, "Zero area copied");
+  reassembled.CopyData (got, sizeof (got));
+  NS_TEST_ASSERT_MSG_EQ (memcmp (got, data, 10), 0, "Bad reassembled data");
+  for (uint32_t j = 10; j < sizeof (got); j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (got[j], 0, "Bad reassembled zero area");
+    }
 }
 
 /**
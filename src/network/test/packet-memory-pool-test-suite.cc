@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet-memory-pool.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+#endif /* HAVE_PTHREAD_H */
+#include <cstring>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketMemoryPool unit tests.
+ */
+class PacketMemoryPoolTestCase : public TestCase
+{
+public:
+  PacketMemoryPoolTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketMemoryPoolTestCase::PacketMemoryPoolTestCase ()
+  : TestCase ("Check the size classes and the reuse of pooled storage")
+{
+}
+
+void
+PacketMemoryPoolTestCase::DoRun (void)
+{
+  for (std::size_t size = 1; size <= 70000; size += 7)
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (PacketMemoryPool::GetBlockSize (size), size,
+                                   "Block smaller than the size " << size);
+    }
+
+#ifdef PACKET_MEMORY_POOL
+  NS_TEST_ASSERT_MSG_EQ (PacketMemoryPool::GetBlockSize (1), 32, "Smallest size class");
+  NS_TEST_ASSERT_MSG_EQ (PacketMemoryPool::GetBlockSize (33), 48, "Size rounded up");
+  NS_TEST_ASSERT_MSG_EQ (PacketMemoryPool::GetBlockSize (1500), 1536, "Size rounded up");
+  NS_TEST_ASSERT_MSG_EQ (PacketMemoryPool::GetBlockSize (65536), 65536, "Largest size class");
+  NS_TEST_ASSERT_MSG_EQ (PacketMemoryPool::GetBlockSize (65537), 65537, "Size not pooled");
+
+  // Released storage is handed out again for any size of its class
+  void *p = PacketMemoryPool::Allocate (100);
+  std::memset (p, 0xa5, PacketMemoryPool::GetBlockSize (100));
+  PacketMemoryPool::Deallocate (p, 100);
+  void *q = PacketMemoryPool::Allocate (128);
+  NS_TEST_ASSERT_MSG_EQ (q, p, "Storage of the same size class not reused");
+  PacketMemoryPool::Deallocate (q, 128);
+
+  // Once warm, the pool serves fragmented packets without the global heap
+  uint64_t allocations = 0;
+  uint64_t heapAllocations = 0;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      if (i == 1)
+        {
+          allocations = PacketMemoryPool::GetNAllocations ();
+          heapAllocations = PacketMemoryPool::GetNHeapAllocations ();
+        }
+      Ptr<Packet> packet = Create<Packet> (1000);
+      Ptr<Packet> fragment = packet->CreateFragment (0, 500);
+      fragment->AddAtEnd (packet->CreateFragment (500, 500));
+    }
+  NS_TEST_ASSERT_MSG_GT (PacketMemoryPool::GetNAllocations (), allocations,
+                         "Packet storage not allocated from the pool");
+  NS_TEST_ASSERT_MSG_EQ (PacketMemoryPool::GetNHeapAllocations (), heapAllocations,
+                         "Warm pool used the global heap");
+#endif /* PACKET_MEMORY_POOL */
+}
+
+#if defined (PACKET_MEMORY_POOL) && defined (HAVE_PTHREAD_H)
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketMemoryPool tests with storage released by other threads.
+ */
+class PacketMemoryPoolThreadsTestCase : public TestCase
+{
+public:
+  PacketMemoryPoolThreadsTestCase ();
+private:
+  virtual void DoRun (void);
+
+  /** Storage handed between threads. */
+  typedef std::vector<void *> Blocks;
+  /** Thread results. */
+  struct Context
+  {
+    uint32_t count;            //!< Number of blocks to allocate.
+    Blocks blocks;             //!< Allocated storage.
+    uint64_t heapAllocations;  //!< Heap allocations made by the thread.
+  };
+  /**
+   * Thread body: allocate blocks.
+   * \param [in,out] context The thread results.
+   */
+  static void Allocate (Context *context);
+  /**
+   * Thread body: allocate then release blocks.
+   * \param [in,out] context The thread results.
+   */
+  static void AllocateAndRelease (Context *context);
+  /**
+   * Release storage.
+   * \param [in,out] blocks The storage to release; cleared.
+   */
+  static void Release (Blocks *blocks);
+  /**
+   * Run a thread body to completion in a new thread.
+   * \param [in] f The thread body.
+   * \param [in,out] context The thread results.
+   */
+  static void Run (void (*f)(Context *), Context *context);
+
+  /** Size of the blocks, in a class with 10 blocks per batch. */
+  static const std::size_t g_size = 1500;
+  /** Number of blocks; well above those a thread keeps per class. */
+  static const uint32_t g_blocks = 1000;
+  /** Number of free blocks of the class a thread keeps at most. */
+  static const uint32_t g_kept = 20;
+};
+
+PacketMemoryPoolThreadsTestCase::PacketMemoryPoolThreadsTestCase ()
+  : TestCase ("Check the reuse of storage released by other threads")
+{
+}
+
+void
+PacketMemoryPoolThreadsTestCase::Allocate (Context *context)
+{
+  uint64_t heapAllocations = PacketMemoryPool::GetNHeapAllocations ();
+  for (uint32_t i = 0; i < context->count; ++i)
+    {
+      context->blocks.push_back (PacketMemoryPool::Allocate (g_size));
+    }
+  context->heapAllocations = PacketMemoryPool::GetNHeapAllocations () - heapAllocations;
+}
+
+void
+PacketMemoryPoolThreadsTestCase::AllocateAndRelease (Context *context)
+{
+  Allocate (context);
+  Release (&context->blocks);
+}
+
+void
+PacketMemoryPoolThreadsTestCase::Release (Blocks *blocks)
+{
+  for (Blocks::iterator it = blocks->begin (); it != blocks->end (); ++it)
+    {
+      PacketMemoryPool::Deallocate (*it, g_size);
+    }
+  blocks->clear ();
+}
+
+void
+PacketMemoryPoolThreadsTestCase::Run (void (*f)(Context *), Context *context)
+{
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (f, context));
+  thread->Start ();
+  thread->Join ();
+}
+
+void
+PacketMemoryPoolThreadsTestCase::DoRun (void)
+{
+  // Storage released here, by another thread than the one which
+  // allocated it, is not kept by this thread.
+  Context producer;
+  producer.count = g_blocks;
+  Run (&Allocate, &producer);
+  Release (&producer.blocks);
+  Context consumer;
+  consumer.count = g_blocks - g_kept;
+  Run (&Allocate, &consumer);
+  Release (&consumer.blocks);
+  NS_TEST_ASSERT_MSG_EQ (consumer.heapAllocations, 0,
+                         "Storage released by the main thread not reused");
+
+  // Nor is the storage a thread still holds when it exits.
+  Context exited;
+  exited.count = g_blocks;
+  Run (&AllocateAndRelease, &exited);
+  consumer.count = g_blocks;
+  Run (&Allocate, &consumer);
+  Release (&consumer.blocks);
+  NS_TEST_ASSERT_MSG_EQ (consumer.heapAllocations, 0,
+                         "Storage held by an exited thread not reused");
+}
+#endif /* PACKET_MEMORY_POOL && HAVE_PTHREAD_H */
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PacketMemoryPool TestSuite
+ */
+class PacketMemoryPoolTestSuite : public TestSuite
+{
+public:
+  PacketMemoryPoolTestSuite ()
+    : TestSuite ("packet-memory-pool", UNIT)
+  {
+    AddTestCase (new PacketMemoryPoolTestCase (), TestCase::QUICK);
+#if defined (PACKET_MEMORY_POOL) && defined (HAVE_PTHREAD_H)
+    AddTestCase (new PacketMemoryPoolThreadsTestCase (), TestCase::QUICK);
+#endif /* PACKET_MEMORY_POOL && HAVE_PTHREAD_H */
+  }
+};
+
+static PacketMemoryPoolTestSuite g_packetMemoryPoolTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,201 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Pipeline load benchmark for the OpenFlow switch device.
+ *
+ * Host 0 sends a constant bit rate UDP flow to host 1 through a single
+ * OpenFlow switch, whose pipeline is modeled with a number of lookup engines
+ * and stages (see the OFSwitch13Device PipelineEngines and PipelineStages
+ * attributes). The offered load is swept from minLoad to maxLoad packets per
+ * second, and for each load the pipeline latency (mean, 99th percentile and
+ * maximum) and the number of packets dropped by the switch are reported,
+ * e.g.:
+ *   ./waf --run "ofswitch13-pipeline-load-bench --engines=2 --stages=4"
+ *
+ *                       Learning Controller
+ *                                |
+ *                       +-----------------+
+ *            Host 0 === | OpenFlow switch | === Host 1
+ *                       +-----------------+
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/csma-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/applications-module.h>
+#include <ns3/ofswitch13-module.h>
+#include <algorithm>
+
+using namespace ns3;
+
+/** Pipeline latency samples for the current load. */
+static std::vector<Time> g_latency;
+
+/** Number of packets dropped by the switch for the current load. */
+static uint32_t g_drops = 0;
+
+/**
+ * Save the pipeline latency of a packet.
+ * \param packet The packet.
+ * \param latency The pipeline latency.
+ */
+void
+PipelineLatency (Ptr<const Packet> packet, Time latency)
+{
+  g_latency.push_back (latency);
+}
+
+/**
+ * Count a packet dropped by the switch.
+ * \param packet The packet.
+ */
+void
+OverloadDrop (Ptr<const Packet> packet)
+{
+  g_drops++;
+}
+
+/**
+ * Simulate the topology for an offered load and print the results.
+ * \param load The offered load (packets per second).
+ * \param pktSize The UDP payload size (bytes).
+ * \param duration The traffic duration.
+ */
+void
+RunLoad (uint32_t load, uint32_t pktSize, Time duration)
+{
+  g_latency.clear ();
+  g_drops = 0;
+
+  // Create two host nodes and the switch node
+  NodeContainer hosts;
+  hosts.Create (2);
+  Ptr<Node> switchNode = CreateObject<Node> ();
+
+  // Use the CsmaHelper to connect host nodes to the switch node, with links
+  // fast enough to make the pipeline the bottleneck
+  CsmaHelper csmaHelper;
+  csmaHelper.SetChannelAttribute ("DataRate", DataRateValue (DataRate ("100Gbps")));
+  NetDeviceContainer hostDevices;
+  NetDeviceContainer switchPorts;
+  for (size_t i = 0; i < hosts.GetN (); i++)
+    {
+      NodeContainer pair (hosts.Get (i), switchNode);
+      NetDeviceContainer link = csmaHelper.Install (pair);
+      hostDevices.Add (link.Get (0));
+      switchPorts.Add (link.Get (1));
+    }
+
+  // Configure the OpenFlow network domain
+  Ptr<Node> controllerNode = CreateObject<Node> ();
+  Ptr<OFSwitch13InternalHelper> of13Helper =
+    CreateObject<OFSwitch13InternalHelper> ();
+  of13Helper->InstallController (controllerNode);
+  Ptr<OFSwitch13Device> switchDevice =
+    of13Helper->InstallSwitch (switchNode, switchPorts);
+  of13Helper->CreateOpenFlowChannels ();
+  switchDevice->TraceConnectWithoutContext (
+    "PipelineLatency", MakeCallback (&PipelineLatency));
+  switchDevice->TraceConnectWithoutContext (
+    "OverloadDrop", MakeCallback (&OverloadDrop));
+
+  // Install the TCP/IP stack and set IPv4 host addresses
+  InternetStackHelper internet;
+  internet.Install (hosts);
+  Ipv4AddressHelper ipv4helpr;
+  ipv4helpr.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer hostIpIfaces = ipv4helpr.Assign (hostDevices);
+
+  // Configure the constant bit rate UDP flow
+  UdpServerHelper serverHelper (9);
+  ApplicationContainer serverApps = serverHelper.Install (hosts.Get (1));
+  UdpClientHelper clientHelper (hostIpIfaces.GetAddress (1), 9);
+  clientHelper.SetAttribute ("MaxPackets", UintegerValue (UINT32_MAX));
+  clientHelper.SetAttribute ("Interval", TimeValue (Seconds (1.0 / load)));
+  clientHelper.SetAttribute ("PacketSize", UintegerValue (pktSize));
+  ApplicationContainer clientApps = clientHelper.Install (hosts.Get (0));
+  clientApps.Start (Seconds (1));
+  clientApps.Stop (Seconds (1) + duration);
+
+  Simulator::Stop (Seconds (2) + duration);
+  Simulator::Run ();
+
+  Time mean, p99, max;
+  if (!g_latency.empty ())
+    {
+      std::sort (g_latency.begin (), g_latency.end ());
+      Time sum;
+      for (auto const &latency : g_latency)
+        {
+          sum += latency;
+        }
+      mean = sum / static_cast<int64_t> (g_latency.size ());
+      p99 = g_latency.at ((g_latency.size () - 1) * 99 / 100);
+      max = g_latency.back ();
+    }
+  std::cout << load << "\t" << g_latency.size ()
+            << "\t" << DynamicCast<UdpServer> (serverApps.Get (0))->GetReceived ()
+            << "\t" << g_drops
+            << "\t" << mean.GetMicroSeconds ()
+            << "\t" << p99.GetMicroSeconds ()
+            << "\t" << max.GetMicroSeconds () << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t engines = 1;
+  uint32_t stages = 1;
+  uint32_t queueSize = 1000;
+  uint32_t minLoad = 10000;
+  uint32_t maxLoad = 100000;
+  uint32_t step = 10000;
+  uint32_t pktSize = 1000;
+  double duration = 1;
+
+  // Configure command line parameters
+  CommandLine cmd;
+  cmd.AddValue ("engines", "Number of pipeline lookup engines", engines);
+  cmd.AddValue ("stages", "Number of stages per lookup engine", stages);
+  cmd.AddValue ("queueSize", "Pipeline queue size (packets)", queueSize);
+  cmd.AddValue ("minLoad", "Minimum offered load (packets/s)", minLoad);
+  cmd.AddValue ("maxLoad", "Maximum offered load (packets/s)", maxLoad);
+  cmd.AddValue ("step", "Offered load step (packets/s)", step);
+  cmd.AddValue ("pktSize", "UDP payload size (bytes)", pktSize);
+  cmd.AddValue ("duration", "Traffic duration for each load (s)", duration);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (minLoad == 0 || step == 0, "Invalid offered load.");
+  Config::SetDefault ("ns3::OFSwitch13Device::PipelineEngines",
+                      UintegerValue (engines));
+  Config::SetDefault ("ns3::OFSwitch13Device::PipelineStages",
+                      UintegerValue (stages));
+  Config::SetDefault ("ns3::OFSwitch13Device::PipelineQueueSize",
+                      UintegerValue (queueSize));
+
+  // Enable checksum computations (required by OFSwitch13 module)
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (true));
+
+  std::cout << "engines: " << engines << ", stages: " << stages
+            << ", queue size: " << queueSize << std::endl;
+  std::cout << "load(pkt/s)\tpipeline\treceived\tdrops"
+            << "\tmean(us)\tp99(us)\tmax(us)" << std::endl;
+  for (uint32_t load = minLoad; load <= maxLoad; load += step)
+    {
+      RunLoad (load, pktSize, Seconds (duration));
+    }
+}
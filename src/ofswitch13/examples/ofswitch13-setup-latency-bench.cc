@@ -0,0 +1,181 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Switch setup latency benchmark for the OpenFlow channel.
+ *
+ * A number of OpenFlow switches connect to the same controller at the same
+ * time. After the handshake with each switch, the controller sends a
+ * configuration made of one group-mod and a number of flow-mods, followed by a
+ * barrier request. The setup latency is the simulated time between the
+ * handshake and the barrier reply. The mode parameter selects how the
+ * configuration is written to the OpenFlow channel:
+ *
+ *  - single: one socket write (and usually one TCP segment) per message;
+ *  - coalesce: messages sent within the same event share socket writes;
+ *  - batch: messages are sent within a controller batch (StartBatch and
+ *    CommitBatch), in addition to socket write coalescing.
+ *
+ * Run it for increasing number of switches to get the setup latency versus
+ * number of switches, e.g.:
+ *   for n in 1 2 4 8 16 32; do
+ *     ./waf --run "ofswitch13-setup-latency-bench --switches=$n --mode=batch"
+ *   done
+ *
+ *                           Controller
+ *                               |
+ *                 +-------------+-------------+
+ *                 |             |             |
+ *             Switch 0      Switch 1  ...  Switch N-1
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/csma-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/ofswitch13-module.h>
+
+using namespace ns3;
+
+/**
+ * Controller installing the same configuration in every switch and measuring
+ * the time until the switch confirms it.
+ */
+class SetupBenchController : public OFSwitch13Controller
+{
+public:
+  /**
+   * Complete constructor.
+   * \param flows The number of flow entries installed in each switch.
+   * \param batch Use controller batches when true.
+   */
+  SetupBenchController (uint32_t flows, bool batch)
+    : m_flows (flows),
+      m_batch (batch),
+      m_sum (Seconds (0)),
+      m_max (Seconds (0)),
+      m_last (Seconds (0)),
+      m_done (0)
+  {
+  }
+
+  /** Print the setup latency statistics. */
+  void Report (void)
+  {
+    std::cout << "switches completed: " << m_done;
+    if (m_done)
+      {
+        std::cout << ", mean setup latency: "
+                  << Seconds (m_sum.GetSeconds () / m_done).As (Time::MS)
+                  << ", max setup latency: " << m_max.As (Time::MS)
+                  << ", last switch ready at: " << m_last.As (Time::MS);
+      }
+    std::cout << std::endl;
+  }
+
+protected:
+  // Inherited from OFSwitch13Controller
+  void HandshakeSuccessful (Ptr<const RemoteSwitch> swtch)
+  {
+    if (m_batch)
+      {
+        StartBatch (swtch);
+      }
+
+    ofs::GroupMod groupMod (OFPGC_ADD, OFPGT_INDIRECT, 1);
+    groupMod.AddBucket ().Output (1);
+    ExecuteMessage (swtch, groupMod);
+
+    for (uint32_t i = 0; i < m_flows; i++)
+      {
+        ofs::FlowMod flowMod (OFPFC_ADD);
+        flowMod.SetTable (0).SetPriority (1000);
+        flowMod.GetMatch ().EthType (0x0800).IpProto (17)
+          .Ipv4Dst (Ipv4Address ("10.1.1.2")).UdpDst (1000 + i);
+        flowMod.ApplyActions ().Group (1);
+        ExecuteMessage (swtch, flowMod);
+      }
+
+    // Without a batch, committing an empty one sends only the barrier request
+    // after the messages already written, which measures the same latency.
+    if (!m_batch)
+      {
+        StartBatch (swtch);
+      }
+    CommitBatch (swtch);
+  }
+
+  // Inherited from OFSwitch13Controller
+  void BatchCompleted (Ptr<const RemoteSwitch> swtch, Time latency)
+  {
+    m_sum += latency;
+    m_max = Max (m_max, latency);
+    m_last = Simulator::Now ();
+    m_done++;
+  }
+
+private:
+  uint32_t  m_flows;  //!< Number of flow entries per switch.
+  bool      m_batch;  //!< Use controller batches.
+  Time      m_sum;    //!< Sum of setup latencies.
+  Time      m_max;    //!< Maximum setup latency.
+  Time      m_last;   //!< Time of the last completion.
+  uint32_t  m_done;   //!< Number of configured switches.
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t switches = 8;
+  uint32_t flows = 50;
+  std::string mode = "batch";
+
+  // Configure command line parameters
+  CommandLine cmd;
+  cmd.AddValue ("switches", "Number of OpenFlow switches", switches);
+  cmd.AddValue ("flows", "Number of flow-mods per switch", flows);
+  cmd.AddValue ("mode", "Channel write mode: single, coalesce or batch", mode);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (mode != "single" && mode != "coalesce" && mode != "batch",
+                   "Invalid mode " << mode);
+  Config::SetDefault ("ns3::OFSwitch13SocketHandler::CoalesceMessages",
+                      BooleanValue (mode != "single"));
+
+  // Enable checksum computations (required by OFSwitch13 module)
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (true));
+
+  // Create the switch nodes, without any switch ports
+  NodeContainer switchNodes;
+  switchNodes.Create (switches);
+
+  // Configure the OpenFlow network domain, with all switches sharing the
+  // same OpenFlow channel
+  Ptr<Node> controllerNode = CreateObject<Node> ();
+  Ptr<SetupBenchController> controller =
+    CreateObject<SetupBenchController> (flows, mode == "batch");
+  Ptr<OFSwitch13InternalHelper> of13Helper =
+    CreateObject<OFSwitch13InternalHelper> ();
+  of13Helper->InstallController (controllerNode, controller);
+  of13Helper->InstallSwitch (switchNodes);
+  of13Helper->CreateOpenFlowChannels ();
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  std::cout << "mode: " << mode << ", switches: " << switches
+            << ", flow-mods per switch: " << flows << std::endl;
+  controller->Report ();
+  Simulator::Destroy ();
+}
@@ -44,6 +44,8 @@ OFSwitch13StatsCalculator::OFSwitch13StatsCalculator ()
   m_ewmaPipelineDelay (0.0),
   m_ewmaSumFlowEntries (0.0),
   m_bytes (0),
+  m_cacheHits (0),
+  m_cacheMisses (0),
   m_lastFlowMods (0),
   m_lastGroupMods (0),
   m_lastMeterMods (0),
@@ -123,7 +125,9 @@ OFSwitch13StatsCalculator::HookSinks (Ptr<OFSwitch13Device> device)
     << " " << setw (7)  << "GroEntr"
     << " " << setw (7)  << "GroUsag"
     << " " << setw (7)  << "BufPkts"
-    << " " << setw (7)  << "BufUsag";
+    << " " << setw (7)  << "BufUsag"
+    << " " << setw (7)  << "CacHits"
+    << " " << setw (7)  << "CacMiss";
 
   if (m_details)
     {
@@ -156,6 +160,14 @@ OFSwitch13StatsCalculator::HookSinks (Ptr<OFSwitch13Device> device)
     "PipelinePacket", MakeCallback (
       &OFSwitch13StatsCalculator::NotifyPipelinePacket,
       Ptr<OFSwitch13StatsCalculator> (this)));
+  device->TraceConnectWithoutContext (
+    "MicroflowCacheHit", MakeCallback (
+      &OFSwitch13StatsCalculator::NotifyCacheHit,
+      Ptr<OFSwitch13StatsCalculator> (this)));
+  device->TraceConnectWithoutContext (
+    "MicroflowCacheMiss", MakeCallback (
+      &OFSwitch13StatsCalculator::NotifyCacheMiss,
+      Ptr<OFSwitch13StatsCalculator> (this)));
 
   m_ewmaFlowEntries.resize (device->GetNPipelineTables (), 0.0);
 }
@@ -357,6 +369,22 @@ OFSwitch13StatsCalculator::NotifyPipelinePacket (Ptr<const Packet> packet)
   m_packets++;
 }
 
+void
+OFSwitch13StatsCalculator::NotifyCacheHit (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  m_cacheHits++;
+}
+
+void
+OFSwitch13StatsCalculator::NotifyCacheMiss (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  m_cacheMisses++;
+}
+
 void
 OFSwitch13StatsCalculator::DumpStatistics (void)
 {
@@ -403,7 +431,9 @@ OFSwitch13StatsCalculator::DumpStatistics (void)
     << " " << setw (7)  << GetEwmaGroupTableEntries ()
     << " " << setw (7)  << GetAvgGroupTableUsage ()
     << " " << setw (7)  << GetEwmaBufferEntries ()
-    << " " << setw (7)  << GetAvgBufferUsage ();
+    << " " << setw (7)  << GetAvgBufferUsage ()
+    << " " << setw (7)  << m_cacheHits
+    << " " << setw (7)  << m_cacheMisses;
 
   if (m_details)
     {
@@ -419,6 +449,8 @@ OFSwitch13StatsCalculator::DumpStatistics (void)
 
   // Update internal counters.
   m_bytes = 0;
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
   m_lastFlowMods   = flowMods;
   m_lastGroupMods  = groupMods;
   m_lastMeterMods  = meterMods;
@@ -53,6 +53,8 @@ namespace ns3 {
  * -# [GroUsag] Average group table usage (percent);
  * -# [BufPkts] EWMA number of packets in switch buffer;
  * -# [BufUsag] Average switch buffer usage (percent);
+ * -# [CacHits] Packets that hit the microflow cache in the last interval;
+ * -# [CacMiss] Packets that missed the microflow cache in the last interval;
  *
  * When the FlowTableDetails attribute is set to 'true', the EWMA number of
  * entries and the average flow table usage for each pipeline flow table is
@@ -144,6 +146,18 @@ private:
    */
   void NotifyPipelinePacket (Ptr<const Packet> packet);
 
+  /**
+   * Notify when a packet hits the microflow cache.
+   * \param packet The packet.
+   */
+  void NotifyCacheHit (Ptr<const Packet> packet);
+
+  /**
+   * Notify when a packet misses the microflow cache.
+   * \param packet The packet.
+   */
+  void NotifyCacheMiss (Ptr<const Packet> packet);
+
   /**
    * Read statistics from switch, update internal counters,
    * and dump data into output file.
@@ -170,6 +184,8 @@ private:
   std::vector<double> m_ewmaFlowEntries;
 
   uint64_t  m_bytes;
+  uint64_t  m_cacheHits;
+  uint64_t  m_cacheMisses;
   uint64_t  m_lastFlowMods;
   uint64_t  m_lastGroupMods;
   uint64_t  m_lastMeterMods;
@@ -18,7 +18,6 @@
  * Author: Luciano Chaves <luciano@lrc.ic.unicamp.br>
  */
 
-#include <wordexp.h>
 #include <ns3/uinteger.h>
 #include <ns3/tcp-socket-factory.h>
 #include "ofswitch13-controller.h"
@@ -66,6 +65,7 @@ OFSwitch13Controller::DoDispose ()
   m_switchesMap.clear ();
   m_echoMap.clear ();
   m_barrierMap.clear ();
+  m_batchMap.clear ();
   m_schedCommands.clear ();
 
   Application::DoDispose ();
@@ -77,10 +77,21 @@ OFSwitch13Controller::DpctlExecute (Ptr<const RemoteSwitch> swtch,
 {
   NS_LOG_FUNCTION (this << swtch << textCmd);
 
-  wordexp_t cmd;
-  wordexp (textCmd.c_str (), &cmd, 0);
-  char **argv = cmd.we_wordv;
-  size_t argc = cmd.we_wordc;
+  // Split the command into white-space separated words. Dpctl commands have
+  // no quoting or shell expansions, so wordexp () is not necessary here.
+  std::string words (textCmd);
+  std::vector<char*> argv;
+  char *saveptr = 0;
+  for (char *word = strtok_r (&words [0], " \t\n", &saveptr); word;
+       word = strtok_r (0, " \t\n", &saveptr))
+    {
+      argv.push_back (word);
+    }
+  if (argv.empty ())
+    {
+      NS_LOG_ERROR ("Empty dpctl command.");
+      return EXIT_FAILURE;
+    }
 
   if ((strcmp (argv[0], "ping") == 0)
       || (strcmp (argv[0], "monitor") == 0)
@@ -89,13 +100,12 @@ OFSwitch13Controller::DpctlExecute (Ptr<const RemoteSwitch> swtch,
       || (strcmp (argv[0], "queue-del") == 0))
     {
       NS_LOG_ERROR ("Dpctl experimenter command currently not supported.");
-      wordfree (&cmd);
       return EXIT_FAILURE;
     }
 
-  int ret = dpctl_exec_ns3_command ((void*)PeekPointer (swtch), argc, argv);
-  wordfree (&cmd);
-  return ret;
+  argv.push_back (0);
+  return dpctl_exec_ns3_command ((void*)PeekPointer (swtch), argv.size () - 1,
+                                 &argv [0]);
 }
 
 int
@@ -121,6 +131,62 @@ OFSwitch13Controller::DpctlSchedule (uint64_t dpId, const std::string textCmd)
   return 0;
 }
 
+int
+OFSwitch13Controller::ExecuteMessage (Ptr<const RemoteSwitch> swtch,
+                                      ofs::MessageBuilder &msg)
+{
+  NS_LOG_FUNCTION (this << swtch);
+
+  return SendToSwitch (swtch, msg.GetMessage (), 0);
+}
+
+int
+OFSwitch13Controller::ExecuteMessage (uint64_t dpId, ofs::MessageBuilder &msg)
+{
+  NS_LOG_FUNCTION (this << dpId);
+
+  Ptr<const RemoteSwitch> swtch = GetRemoteSwitch (dpId);
+  NS_ASSERT_MSG (swtch, "Can't execute message for an unregistered switch.");
+  return ExecuteMessage (swtch, msg);
+}
+
+void
+OFSwitch13Controller::StartBatch (Ptr<const RemoteSwitch> swtch)
+{
+  NS_LOG_FUNCTION (this << swtch);
+
+  std::pair <Address, Ptr<Packet> > entry (swtch->m_address, Create<Packet> ());
+  auto ret = m_batchMap.insert (entry);
+  if (ret.second == false)
+    {
+      NS_LOG_WARN ("Batch already open for switch " << swtch->GetIpv4 ());
+    }
+}
+
+int
+OFSwitch13Controller::CommitBatch (Ptr<const RemoteSwitch> swtch)
+{
+  NS_LOG_FUNCTION (this << swtch);
+
+  if (m_batchMap.find (swtch->m_address) == m_batchMap.end ())
+    {
+      NS_LOG_ERROR ("No open batch for switch " << swtch->GetIpv4 ());
+      return EXIT_FAILURE;
+    }
+
+  // Close the batch with a barrier request, so we know when it is done.
+  uint32_t xid = SendBarrierRequest (swtch);
+  m_barrierMap.find (xid)->second.m_batch = true;
+
+  // Write all messages to the switch at once.
+  auto it = m_batchMap.find (swtch->m_address);
+  Ptr<Packet> batch = it->second;
+  m_batchMap.erase (it);
+  NS_LOG_DEBUG ("Committing batch of " << batch->GetSize () <<
+                " bytes to switch " << swtch->GetIpv4 ());
+  return swtch->m_handler->SendMessage (batch);
+}
+
 void
 OFSwitch13Controller::DpctlSendAndPrint (struct vconn *vconn,
                                          struct ofl_msg_header *msg)
@@ -164,6 +230,7 @@ OFSwitch13Controller::StopApplication ()
       swtch->m_handler = 0;
     }
   m_switchesMap.clear ();
+  m_batchMap.clear ();
 
   if (m_serverSocket)
     {
@@ -185,6 +252,13 @@ OFSwitch13Controller::HandshakeSuccessful (Ptr<const RemoteSwitch> swtch)
   NS_LOG_FUNCTION (this << swtch << Simulator::Now());
 }
 
+void
+OFSwitch13Controller::BatchCompleted (Ptr<const RemoteSwitch> swtch,
+                                      Time latency)
+{
+  NS_LOG_FUNCTION (this << swtch << latency);
+}
+
 Ptr<const OFSwitch13Controller::RemoteSwitch>
 OFSwitch13Controller::GetRemoteSwitch (uint64_t dpId) const
 {
@@ -207,10 +281,14 @@ OFSwitch13Controller::SendToSwitch (Ptr<const RemoteSwitch> swtch,
 {
   NS_LOG_FUNCTION (this << swtch << Simulator::Now());
 
-  char *msgStr = ofl_msg_to_string (msg, 0);
-  NS_LOG_DEBUG ("TX to switch " << swtch->GetIpv4 () <<
-                " [dp " << swtch->GetDpId () << "]: " << msgStr);
-  free (msgStr);
+  // Converting the message to string is expensive, so only do it for logs.
+  if (g_log.IsEnabled (LOG_DEBUG))
+    {
+      char *msgStr = ofl_msg_to_string (msg, 0);
+      NS_LOG_DEBUG ("TX to switch " << swtch->GetIpv4 () <<
+                    " [dp " << swtch->GetDpId () << "]: " << msgStr);
+      free (msgStr);
+    }
 
   // Set the transaction ID only for unknown values
   if (!xid)
@@ -218,8 +296,16 @@ OFSwitch13Controller::SendToSwitch (Ptr<const RemoteSwitch> swtch,
       xid = GetNextXid ();
     }
 
-  // Create the packet from the OpenFlow message and send it to the switch.
-  return swtch->m_handler->SendMessage (ofs::PacketFromMsg (msg, xid));
+  // Create the packet from the OpenFlow message and send it to the switch,
+  // unless there is an open batch for this switch.
+  Ptr<Packet> packet = ofs::PacketFromMsg (msg, xid);
+  auto it = m_batchMap.find (swtch->m_address);
+  if (it != m_batchMap.end ())
+    {
+      it->second->AddAtEnd (packet);
+      return 0;
+    }
+  return swtch->m_handler->SendMessage (packet);
 }
 
 void
@@ -260,7 +346,7 @@ OFSwitch13Controller::SendEchoRequest (Ptr<const RemoteSwitch> swtch,
     }
 }
 
-void
+uint32_t
 OFSwitch13Controller::SendBarrierRequest (Ptr<const RemoteSwitch> swtch)
 {
   NS_LOG_FUNCTION (this << swtch);
@@ -280,6 +366,7 @@ OFSwitch13Controller::SendBarrierRequest (Ptr<const RemoteSwitch> swtch)
 
   // Send the message to the switch
   SendToSwitch (swtch, &msg, xid);
+  return xid;
 }
 
 // --- BEGIN: Handlers functions -------
@@ -340,7 +427,12 @@ OFSwitch13Controller::HandleBarrierReply (
   else
     {
       NS_LOG_INFO ("Barrier reply from " << it->second.m_swtch->GetIpv4 ());
+      BarrierInfo info = it->second;
       m_barrierMap.erase (it);
+      if (info.m_batch)
+        {
+          BatchCompleted (swtch, Simulator::Now () - info.m_send);
+        }
     }
 
   ofl_msg_free (msg, 0);
@@ -740,6 +832,8 @@ OFSwitch13Controller::EchoInfo::GetRtt (void) const
 
 OFSwitch13Controller::BarrierInfo::BarrierInfo (Ptr<const RemoteSwitch> swtch)
   : m_waiting (true),
+  m_batch (false),
+  m_send (Simulator::Now ()),
   m_swtch (swtch)
 {
 }
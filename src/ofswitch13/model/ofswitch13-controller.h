@@ -24,6 +24,7 @@
 #include <ns3/application.h>
 #include <ns3/socket.h>
 #include "ofswitch13-interface.h"
+#include "ofswitch13-message-builder.h"
 #include "ofswitch13-socket-handler.h"
 #include <string>
 
@@ -34,8 +35,11 @@ namespace ns3 {
  * OpenFlow 1.3 controller base class that can handle a collection of OpenFlow
  * switches and provides the basic functionalities for controller
  * implementation. For constructing OpenFlow configuration messages and sending
- * them to the switches, this class uses the DpctlCommand function, which
- * relies on command-line syntax from the dpctl utility. For OpenFlow messages
+ * them to the switches, this class provides the DpctlExecute function, which
+ * relies on command-line syntax from the dpctl utility, and the ExecuteMessage
+ * function, which sends typed messages built with the ofs::FlowMod,
+ * ofs::GroupMod, ofs::MeterMod and ofs::SetConfig classes without any text
+ * parsing. For OpenFlow messages
  * coming from the switches, this class provides a collection of internal
  * handlers to deal with the different types of messages.
  */
@@ -137,6 +141,8 @@ public:
 
 private:
     bool                    m_waiting;    //!< True when waiting for reply.
+    bool                    m_batch;      //!< True when closing a batch.
+    Time                    m_send;       //!< Send time.
     Ptr<const RemoteSwitch> m_swtch;      //!< Remote switch.
   };
 
@@ -180,6 +186,46 @@ public:
    */
   int DpctlSchedule (uint64_t dpId, const std::string textCmd);
 
+  /**
+   * Send a typed OpenFlow message to the remote switch. This is equivalent to
+   * the corresponding DpctlExecute command, but the message is built directly
+   * from typed fields, without parsing any text.
+   * \param swtch The target remote switch.
+   * \param msg The message to send.
+   * \return 0 if everything's ok, otherwise an error number.
+   */
+  int ExecuteMessage (Ptr<const RemoteSwitch> swtch, ofs::MessageBuilder &msg);
+
+  /**
+   * Send a typed OpenFlow message to the remote switch.
+   * \param dpId The OpenFlow datapath ID.
+   * \param msg The message to send.
+   * \return 0 if everything's ok, otherwise an error number.
+   */
+  int ExecuteMessage (uint64_t dpId, ofs::MessageBuilder &msg);
+
+  /**
+   * Start a batch of messages to the remote switch. Until the batch is
+   * committed, all messages sent to this switch (including those from
+   * DpctlExecute and ExecuteMessage) are held by the controller instead of
+   * being individually written to the OpenFlow channel.
+   * \param swtch The target remote switch.
+   */
+  void StartBatch (Ptr<const RemoteSwitch> swtch);
+
+  /**
+   * Commit the open batch of messages to the remote switch. The held messages
+   * are followed by a barrier request and written to the OpenFlow channel at
+   * once, so they travel in as few TCP segments as possible and the switch
+   * applies the messages received in each segment within the same simulation
+   * event. The BatchCompleted function is invoked when the barrier reply is
+   * received. Note that OpenFlow 1.3 has no bundles, so messages already
+   * applied by the switch are not rolled back if a later one fails.
+   * \param swtch The target remote switch.
+   * eturn 0 if everything's ok, otherwise an error number.
+   */
+  int CommitBatch (Ptr<const RemoteSwitch> swtch);
+
   /**
    * Overriding ofsoftswitch13 dpctl_send_and_print  and
    * dpctl_transact_and_print weak functions from utilities/dpctl.c. Send a
@@ -211,6 +257,16 @@ protected:
    */
   virtual void HandshakeSuccessful (Ptr<const RemoteSwitch> swtch);
 
+  /**
+   * Function invoked when the switch replies to the barrier request closing a
+   * batch of messages, which means that all messages in the batch were
+   * processed. Derived classes can override this function to start using the
+   * configured switch.
+   * \param swtch The remote switch.
+   * \param latency The time between committing the batch and its completion.
+   */
+  virtual void BatchCompleted (Ptr<const RemoteSwitch> swtch, Time latency);
+
   /**
    * Get the remote switch for this OpenFlow datapath ID.
    * \param dpId The OpenFlow datapath ID.
@@ -241,8 +297,9 @@ protected:
    * and messages are processed in the same order that are received from the
    * controller, so a barrier request will simply be replied by the switch.
    * \param swtch The remote switch to receive the message.
+   * \return The transaction ID of the barrier request.
    */
-  void SendBarrierRequest (Ptr<const RemoteSwitch> swtch);
+  uint32_t SendBarrierRequest (Ptr<const RemoteSwitch> swtch);
 
   /**
    * \name OpenFlow message handlers
@@ -379,6 +436,9 @@ private:
   /** Map to store switch info by Address */
   typedef std::map <Address, Ptr<RemoteSwitch> > SwitchsMap_t;
 
+  /** Map to store the open batch of messages by switch Address */
+  typedef std::map <Address, Ptr<Packet> > BatchMap_t;
+
   uint32_t        m_xid;              //!< Global transaction idx.
   uint16_t        m_port;             //!< Local controller tcp port.
   Ptr<Socket>     m_serverSocket;     //!< Listening server socket.
@@ -387,6 +447,7 @@ private:
   BarrierMsgMap_t m_barrierMap;       //!< Metadata for barrier requests.
   DpIdCmdMap_t    m_schedCommands;    //!< Scheduled commands for execution.
   SwitchsMap_t    m_switchesMap;      //!< Registered switches metadata's.
+  BatchMap_t      m_batchMap;         //!< Open batches of messages.
 };
 
 } // namespace ns3
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/simulator.h>
+#include "ofswitch13-coverage-tracker.h"
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OFSwitch13CoverageTracker");
+NS_OBJECT_ENSURE_REGISTERED (OFSwitch13CoverageTracker);
+
+// Crossings closer than this (in seconds) are considered to happen now. This
+// absorbs the rounding of crossing times to the simulator time resolution.
+static const double g_crossingTolerance = 1e-6;
+
+TypeId
+OFSwitch13CoverageTracker::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::OFSwitch13CoverageTracker")
+    .SetParent<Object> ()
+    .SetGroupName ("OFSwitch13")
+    .AddConstructor<OFSwitch13CoverageTracker> ()
+    .AddAttribute ("Range",
+                   "The coverage range of each cell (in meters).",
+                   DoubleValue (110),
+                   MakeDoubleAccessor (&OFSwitch13CoverageTracker::m_range),
+                   MakeDoubleChecker<double> (0))
+    .AddTraceSource ("CoverageChanged",
+                     "Trace source indicating the node has entered or left "
+                     "the coverage of all cells.",
+                     MakeTraceSourceAccessor (
+                       &OFSwitch13CoverageTracker::m_coverageTrace),
+                     "ns3::OFSwitch13CoverageTracker::CoverageTracedCallback")
+  ;
+  return tid;
+}
+
+OFSwitch13CoverageTracker::OFSwitch13CoverageTracker ()
+  : m_mobility (0),
+  m_inCoverage (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+OFSwitch13CoverageTracker::~OFSwitch13CoverageTracker ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+OFSwitch13CoverageTracker::AddCellLocation (Vector location)
+{
+  NS_LOG_FUNCTION (this << location);
+
+  m_cells.push_back (location);
+}
+
+void
+OFSwitch13CoverageTracker::Start (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+
+  NS_ASSERT_MSG (!m_mobility, "Coverage tracking already started.");
+  m_mobility = mobility;
+  m_mobility->TraceConnectWithoutContext (
+    "CourseChange", MakeCallback (&OFSwitch13CoverageTracker::Update, this));
+  Update (m_mobility);
+}
+
+bool
+OFSwitch13CoverageTracker::IsInCoverage (void) const
+{
+  return m_inCoverage;
+}
+
+void
+OFSwitch13CoverageTracker::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_mobility)
+    {
+      m_mobility->TraceDisconnectWithoutContext (
+        "CourseChange",
+        MakeCallback (&OFSwitch13CoverageTracker::Update, this));
+    }
+  m_crossing.Cancel ();
+  m_mobility = 0;
+  m_cells.clear ();
+  Object::DoDispose ();
+}
+
+void
+OFSwitch13CoverageTracker::Update (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this);
+
+  Vector position = mobility->GetPosition ();
+  Vector velocity = mobility->GetVelocity ();
+  double speed2 = velocity.x * velocity.x + velocity.y * velocity.y
+    + velocity.z * velocity.z;
+
+  // Along the current segment, the position is p(t) = p + v.t and the node is
+  // inside the cell at c while |p + v.t - c|^2 <= r^2. This quadratic gives
+  // the interval [t1, t2] the node spends inside each cell.
+  bool inCoverage = false;
+  double nextCrossing = std::numeric_limits<double>::infinity ();
+  for (auto const &cell : m_cells)
+    {
+      Vector d = position - cell;
+      double b = d.x * velocity.x + d.y * velocity.y + d.z * velocity.z;
+      double c = d.x * d.x + d.y * d.y + d.z * d.z - m_range * m_range;
+      if (speed2 == 0)
+        {
+          inCoverage = inCoverage || c <= 0;
+          continue;
+        }
+
+      double disc = b * b - speed2 * c;
+      if (disc <= 0)
+        {
+          continue; // The segment line never enters this cell.
+        }
+      double t1 = (-b - std::sqrt (disc)) / speed2;
+      double t2 = (-b + std::sqrt (disc)) / speed2;
+      if (t1 <= g_crossingTolerance && t2 > g_crossingTolerance)
+        {
+          inCoverage = true;
+        }
+      if (t1 > g_crossingTolerance)
+        {
+          nextCrossing = std::min (nextCrossing, t1);
+        }
+      else if (t2 > g_crossingTolerance)
+        {
+          nextCrossing = std::min (nextCrossing, t2);
+        }
+    }
+
+  if (inCoverage != m_inCoverage)
+    {
+      NS_LOG_INFO ((inCoverage ? "Entered" : "Left") << " coverage at " <<
+                   position);
+      m_inCoverage = inCoverage;
+      m_coverageTrace (m_inCoverage);
+    }
+
+  // Schedule the next boundary crossing for the current segment. A course
+  // change before this time cancels it and computes a new one.
+  m_crossing.Cancel ();
+  if (nextCrossing != std::numeric_limits<double>::infinity ())
+    {
+      NS_LOG_DEBUG ("Next boundary crossing in " << nextCrossing << "s");
+      m_crossing = Simulator::Schedule (
+          Seconds (nextCrossing), &OFSwitch13CoverageTracker::Crossing, this);
+    }
+}
+
+void
+OFSwitch13CoverageTracker::Crossing (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Update (m_mobility);
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OFSWITCH13_COVERAGE_TRACKER_H
+#define OFSWITCH13_COVERAGE_TRACKER_H
+
+#include <ns3/object.h>
+#include <ns3/event-id.h>
+#include <ns3/traced-callback.h>
+#include <ns3/vector.h>
+#include <ns3/mobility-model.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ofswitch13
+ * Track whether a node is within the coverage range of any cell in a set of
+ * cell locations (e.g. mmWave eNBs). Instead of periodically checking the
+ * distance to every cell, the tracker uses the current position and velocity
+ * from the node mobility model to compute when the node will cross the
+ * boundary of each cell, and schedules a single event for the nearest
+ * crossing. Predictions are recomputed whenever the mobility model reports a
+ * course change, so the coverage state is exact for any piecewise
+ * constant-velocity mobility model (constant position and velocity, waypoint,
+ * ns-2 traces, random walk, etc.).
+ */
+class OFSwitch13CoverageTracker : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  OFSwitch13CoverageTracker ();           //!< Default constructor.
+  virtual ~OFSwitch13CoverageTracker ();  //!< Dummy destructor.
+
+  /**
+   * Add a cell location. Cells added after tracking has started are only
+   * considered after the next course change.
+   * \param location The cell position.
+   */
+  void AddCellLocation (Vector location);
+
+  /**
+   * Start tracking the coverage of the node with this mobility model.
+   * \param mobility The node mobility model.
+   */
+  void Start (Ptr<MobilityModel> mobility);
+
+  /**
+   * \return True if the node is within the coverage range of any cell.
+   */
+  bool IsInCoverage (void) const;
+
+  /**
+   * TracedCallback signature for coverage changes.
+   * \param inCoverage True if the node has entered the coverage, false if it
+   *        has left it.
+   */
+  typedef void (*CoverageTracedCallback)(bool inCoverage);
+
+protected:
+  /** Destructor implementation */
+  virtual void DoDispose ();
+
+private:
+  /**
+   * Update the coverage state and schedule the next boundary crossing.
+   * Connected to the mobility model CourseChange trace source.
+   * \param mobility The node mobility model.
+   */
+  void Update (Ptr<const MobilityModel> mobility);
+
+  /** Handle a boundary crossing event. */
+  void Crossing (void);
+
+  Ptr<MobilityModel>    m_mobility;     //!< Node mobility model.
+  std::vector<Vector>   m_cells;        //!< Cell locations.
+  double                m_range;        //!< Cell coverage range.
+  bool                  m_inCoverage;   //!< Current coverage state.
+  EventId               m_crossing;     //!< Next boundary crossing event.
+
+  /** Trace source fired when the coverage state changes. */
+  TracedCallback<bool>  m_coverageTrace;
+};
+
+} // namespace ns3
+#endif /* OFSWITCH13_COVERAGE_TRACKER_H */
@@ -22,6 +22,7 @@
 #include "ofswitch13-device.h"
 #include "ofswitch13-port.h"
 #include <ns3/mobility-model.h>
+#include <algorithm>
 
 #undef NS_LOG_APPEND_CONTEXT
 #define NS_LOG_APPEND_CONTEXT                 \
@@ -38,7 +39,7 @@ NS_OBJECT_ENSURE_REGISTERED (OFSwitch13Device);
 // Initializing OFSwitch13Device static members.
 uint64_t OFSwitch13Device::m_globalDpId = 0;
 uint64_t OFSwitch13Device::m_globalPktId = 0;
-OFSwitch13Device::DpIdDevMap_t OFSwitch13Device::m_globalSwitchMap;
+OFSwitch13Device::DpIdDevList_t OFSwitch13Device::m_globalSwitchList;
 
 /********** Public methods **********/
 OFSwitch13Device::OFSwitch13Device ()
@@ -51,12 +52,18 @@ OFSwitch13Device::OFSwitch13Device ()
   m_cMeterMod (0),
   m_cPacketIn (0),
   m_cPacketOut (0),
-  m_5gCoverage (false),
-  m_firstLocationFetch (true)
+  m_cCacheHit (0),
+  m_cCacheMiss (0),
+  m_mmWavePort (0)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO ("OpenFlow version: " << OFP_VERSION);
 
+  m_coverage = CreateObject<OFSwitch13CoverageTracker> ();
+  m_coverage->TraceConnectWithoutContext (
+    "CoverageChanged",
+    MakeCallback (&OFSwitch13Device::NotifyCoverageChanged, this));
+
   m_dpId = ++m_globalDpId;
   NS_LOG_DEBUG ("New datapath ID " << m_dpId);
   OFSwitch13Device::RegisterDatapath (m_dpId, Ptr<OFSwitch13Device> (this));
@@ -103,6 +110,46 @@ OFSwitch13Device::GetTypeId (void)
                    MakeUintegerAccessor (&OFSwitch13Device::SetMeterTableSize,
                                          &OFSwitch13Device::GetMeterTableSize),
                    MakeUintegerChecker<uint32_t> (0, METER_TABLE_MAX_ENTRIES))
+    .AddAttribute ("MicroflowCacheSize",
+                   "The maximum number of entries in the exact-match "
+                   "microflow cache (0 disables the cache).",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_cacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MmWavePort",
+                   "The number of the switch port attached to the mmWave "
+                   "interface, whose liveness follows the 5G coverage "
+                   "(0 for none).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_mmWavePort),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PipelineEngines",
+                   "The number of parallel pipeline lookup engines "
+                   "(0 for unlimited engines, with no queueing).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_pipeEngines),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PipelineHeaderBytes",
+                   "The number of bytes from the beginning of each packet "
+                   "that are copied into the OpenFlow pipeline buffer. The "
+                   "remaining payload is kept in the ns-3 packet "
+                   "(0 copies the entire packet).",
+                   UintegerValue (128),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_headerBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PipelineQueueSize",
+                   "The maximum number of packets waiting for a free "
+                   "pipeline lookup engine (ignored for unlimited engines).",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_pipeQueueSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PipelineStages",
+                   "The number of stages in each pipeline lookup engine. An "
+                   "engine accepts a new packet every pipeline delay / stages "
+                   "interval (ignored for unlimited engines).",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_pipeStages),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("PipelineTables",
                    "The number of pipeline flow tables.",
                    TypeId::ATTR_GET | TypeId::ATTR_CONSTRUCT,
@@ -145,6 +192,18 @@ OFSwitch13Device::GetTypeId (void)
                      MakeTraceSourceAccessor (
                        &OFSwitch13Device::m_meterDropTrace),
                      "ns3::OFSwitch13Device::MeterDropTracedCallback")
+    .AddTraceSource ("MicroflowCacheHit",
+                     "Trace source indicating a packet that hit the "
+                     "microflow cache.",
+                     MakeTraceSourceAccessor (
+                       &OFSwitch13Device::m_cacheHitTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("MicroflowCacheMiss",
+                     "Trace source indicating a packet that missed the "
+                     "microflow cache.",
+                     MakeTraceSourceAccessor (
+                       &OFSwitch13Device::m_cacheMissTrace),
+                     "ns3::Packet::TracedCallback")
     .AddTraceSource ("OverloadDrop",
                      "Trace source indicating a packet dropped by CPU "
                      "overloaded processing capacity.",
@@ -156,11 +215,24 @@ OFSwitch13Device::GetTypeId (void)
                      MakeTraceSourceAccessor (
                        &OFSwitch13Device::m_pipePacketTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PipelineLatency",
+                     "Trace source indicating a packet leaving the pipeline "
+                     "model, with the time since it was received from the "
+                     "switch port.",
+                     MakeTraceSourceAccessor (
+                       &OFSwitch13Device::m_pipeLatencyTrace),
+                     "ns3::OFSwitch13Device::PipelineLatencyTracedCallback")
     .AddTraceSource ("DatapathTimeout",
                      "Trace source indicating a datapath timeout operation.",
                      MakeTraceSourceAccessor (
                        &OFSwitch13Device::m_datapathTimeoutTrace),
                      "ns3::OFSwitch13Device::DeviceTracedCallback")
+    .AddTraceSource ("MmWaveCoverage",
+                     "Trace source indicating the switch node has entered or "
+                     "left the coverage of all mmWave eNBs.",
+                     MakeTraceSourceAccessor (
+                       &OFSwitch13Device::m_mmWaveCoverageTrace),
+                     "ns3::OFSwitch13CoverageTracker::CoverageTracedCallback")
 
     .AddTraceSource ("CpuLoad",
                      "Traced value indicating the avg CPU processing load"
@@ -238,6 +310,18 @@ OFSwitch13Device::GetPacketOutCounter (void) const
   return m_cPacketOut;
 }
 
+uint64_t
+OFSwitch13Device::GetCacheHitCounter (void) const
+{
+  return m_cCacheHit;
+}
+
+uint64_t
+OFSwitch13Device::GetCacheMissCounter (void) const
+{
+  return m_cCacheMiss;
+}
+
 uint32_t
 OFSwitch13Device::GetBufferEntries (void) const
 {
@@ -371,6 +455,18 @@ OFSwitch13Device::GetMeterTableUsage (void) const
          static_cast<double> (GetMeterTableSize ());
 }
 
+uint32_t
+OFSwitch13Device::GetMicroflowCacheEntries (void) const
+{
+  return m_cache.size ();
+}
+
+uint32_t
+OFSwitch13Device::GetMicroflowCacheSize (void) const
+{
+  return m_cacheSize;
+}
+
 uint32_t
 OFSwitch13Device::GetNControllers (void) const
 {
@@ -459,12 +555,21 @@ OFSwitch13Device::ReceiveFromSwitchPort (Ptr<Packet> packet, uint32_t portNo,
       return;
     }
 
+  // Check for a free lookup engine or space in the pipeline queue.
+  Time delay = PipelineAdmit (packet);
+  if (delay.IsStrictlyNegative ())
+    {
+      NS_LOG_DEBUG ("Drop packet due to full pipeline queue.");
+      m_loadDropTrace (packet);
+      return;
+    }
+
   // Consume tokens, fire trace source and schedule the packet to the pipeline.
   m_cpuTokens -= pktSizeBits;
   m_cpuConsumed += pktSizeBits;
   m_pipePacketTrace (packet);
-  Simulator::Schedule (m_pipeDelay, &OFSwitch13Device::SendToPipeline,
-                       this, packet, portNo, tunnelId);
+  Simulator::Schedule (delay, &OFSwitch13Device::PipelineCompleted,
+                       this, packet, portNo, tunnelId, Simulator::Now ());
 }
 
 void
@@ -640,10 +745,10 @@ OFSwitch13Device::BufferRetrieveCallback (struct packet *pkt)
 Ptr<OFSwitch13Device>
 OFSwitch13Device::GetDevice (uint64_t id)
 {
-  auto it = OFSwitch13Device::m_globalSwitchMap.find (id);
-  if (it != OFSwitch13Device::m_globalSwitchMap.end ())
+  if (id < OFSwitch13Device::m_globalSwitchList.size ()
+      && OFSwitch13Device::m_globalSwitchList [id])
     {
-      return it->second;
+      return OFSwitch13Device::m_globalSwitchList [id];
     }
   NS_ABORT_MSG ("Error when retrieving datapath.");
 }
@@ -661,6 +766,12 @@ OFSwitch13Device::DoDispose ()
     }
   m_ports.clear ();
   m_bufferPkts.clear ();
+  m_cache.clear ();
+  m_engineFree.clear ();
+  m_pipeStarts.clear ();
+  m_coverage->Dispose ();
+  m_coverage = 0;
+  m_node = 0;
 
   for (auto &ctrl : m_controllers)
     {
@@ -830,48 +941,28 @@ void
 OFSwitch13Device::DatapathTimeout (struct datapath *dp)
 {
   meter_table_add_tokens (dp->meters);
-  pipeline_timeout (dp->pipeline);
 
-  bool in5gRange;
-  if (!m_firstLocationFetch)
+  // Flow entries removed by idle or hard timeouts may be referenced by the
+  // microflow cache, which must be invalidated in this case.
+  uint32_t flowEntries = GetSumFlowEntries ();
+  pipeline_timeout (dp->pipeline);
+  if (GetSumFlowEntries () != flowEntries)
     {
-      int minDistance = -1;
-      Vector position = GetNode ()->GetObject<MobilityModel> ()->GetPosition ();
+      FlushMicroflowCache ();
+    }
 
-      for (std::vector<Vector>::iterator i = m_mmWaveEnbLocations.begin(); i != m_mmWaveEnbLocations.end(); i++)
-        {
-          uint32_t distance = CalculateDistance (position, *i);
-          if (minDistance >= 0)
-            {
-              minDistance = (distance < (uint32_t) minDistance) ? distance : minDistance;
-            }
-          else
-            {
-              minDistance = distance;
-            }
-        }
-      in5gRange = (minDistance <= 110) ? true : false;
-      std::cout << Simulator::Now() << " Min. distance= " << minDistance << std::endl;
-       if (m_5gCoverage && !in5gRange)
+  // Check for changes in links (port) status. The 5G coverage is tracked by
+  // events at boundary crossings, so here we only use its current state.
+  for (auto const &port : m_ports)
+    {
+      if (m_mmWavePort && port->GetPortNo () == m_mmWavePort)
         {
-          std::cout << "*** Car went out of 5G Coverage ***" << std::endl;
+          port->PortUpdateState (m_coverage->IsInCoverage ());
         }
-      else if (!m_5gCoverage && in5gRange)
+      else
         {
-          std::cout << "*** Car entered 5G Coverage ***" << std::endl;
+          port->PortUpdateState ();
         }
-      m_5gCoverage = in5gRange;
-    }
-  else
-    {
-      m_firstLocationFetch = false;
-    }
-
-  // Check for chan/s in links (port) status.
-  for (auto const &port : m_ports)
-    {
-      // port->PortUpdateState (in5gRange);
-      port->PortUpdateState ();
     }
 
   // Update traced values.
@@ -925,9 +1016,15 @@ OFSwitch13Device::SendPacketInMessage (struct packet *pkt, uint8_t tableId,
   // always save the packet into buffer to avoid losing ns-3 packet id
   // reference. This is not full compliant with OpenFlow specification, but
   // works very well here.
+  msg.data_length = MIN (maxLength, pkt->buffer->size);
+  if (msg.data_length > pkt->buffer->size - GetPipelinePayloadLength (pkt))
+    {
+      // The controller wants more than the packet headers. This must be done
+      // before saving the packet into buffer, which removes it from pipeline.
+      MaterializePayload (pkt);
+    }
   dp_buffers_save (pkt->dp->buffers, pkt);
   msg.buffer_id = pkt->buffer_id;
-  msg.data_length = MIN (maxLength, pkt->buffer->size);
 
   if (!pkt->handle_std->valid)
     {
@@ -957,10 +1054,9 @@ OFSwitch13Device::SendToSwitchPort (struct packet *pkt, uint32_t portNo,
   // ns3::Packet using the PipelinePacket structure. When the packet is
   // processed by the pipeline with no internal changes, we forward the
   // original ns3::Packet to the specified output port. When internal changes
-  // are necessary, we need to create a new packet with the modified content
-  // and copy all packet tags to this new one. This approach is more expensive
-  // than the previous one, but is far more simple than identifying which
-  // changes were performed in the packet to modify the original ns3::Packet.
+  // are necessary, we replace the headers of a copy of the original packet
+  // by the modified headers from the OpenFlow buffer. Only the header bytes
+  // were copied into the buffer, and the payload is still in the ns-3 packet.
   Ptr<Packet> packet;
   if (m_pipePkt.IsValid ())
     {
@@ -968,11 +1064,12 @@ OFSwitch13Device::SendToSwitchPort (struct packet *pkt, uint32_t portNo,
       if (pkt->changes)
         {
           // The original ns-3 packet was modified by OpenFlow switch.
-          // Create a new packet with modified data and copy tags from the
-          // original packet.
+          // Update the headers in place, keeping payload, uid and tags.
           NS_LOG_DEBUG ("Packet " << pkt->ns3_uid << " modified by switch.");
-          packet = ofs::PacketFromBuffer (pkt->buffer);
-          OFSwitch13Device::CopyTags (m_pipePkt.GetPacket (), packet);
+          packet = m_pipePkt.GetPacket ()->Copy ();
+          uint32_t payload = GetPipelinePayloadLength (pkt);
+          ofs::UpdatePacketFromBuffer (packet, GetPipelineHeaderLength (packet),
+                                       pkt->buffer, pkt->buffer->size - payload);
         }
       else
         {
@@ -993,6 +1090,60 @@ OFSwitch13Device::SendToSwitchPort (struct packet *pkt, uint32_t portNo,
   return port->Send (packet, queueNo, pkt->tunnel_id);
 }
 
+Time
+OFSwitch13Device::PipelineAdmit (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  if (m_pipeEngines == 0)
+    {
+      return m_pipeDelay;
+    }
+
+  // Discard the start times already reached, as these packets are not
+  // waiting anymore. Start times are non-decreasing, so the remaining ones
+  // are the packets waiting in the queue.
+  Time now = Simulator::Now ();
+  while (!m_pipeStarts.empty () && m_pipeStarts.front () <= now)
+    {
+      m_pipeStarts.pop_front ();
+    }
+  if (m_pipeStarts.size () >= m_pipeQueueSize)
+    {
+      return Time (-1);
+    }
+
+  // The packet starts at the first engine able to accept a new packet. The
+  // engine is busy until its first stage is free again, while the packet
+  // takes the whole pipeline delay to leave it. Completion times are kept in
+  // order, as a packet can not overtake another one in the FIFO queue.
+  if (m_engineFree.size () != m_pipeEngines)
+    {
+      m_engineFree.assign (m_pipeEngines, now);
+    }
+  auto engine = std::min_element (m_engineFree.begin (), m_engineFree.end ());
+  Time start = std::max (now, *engine);
+  *engine = start + m_pipeDelay / static_cast<int64_t> (m_pipeStages);
+  m_lastPipeDone = std::max (start + m_pipeDelay, m_lastPipeDone);
+  if (start > now)
+    {
+      m_pipeStarts.push_back (start);
+    }
+  NS_LOG_DEBUG ("Pipeline start in " << start - now << ", " <<
+                m_pipeStarts.size () << " packets waiting.");
+  return m_lastPipeDone - now;
+}
+
+void
+OFSwitch13Device::PipelineCompleted (Ptr<Packet> packet, uint32_t portNo,
+                                     uint64_t tunnelId, Time arrival)
+{
+  NS_LOG_FUNCTION (this << packet << portNo << tunnelId << arrival);
+
+  m_pipeLatencyTrace (packet, Simulator::Now () - arrival);
+  SendToPipeline (packet, portNo, tunnelId);
+}
+
 void
 OFSwitch13Device::SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
                                   uint64_t tunnelId)
@@ -1003,9 +1154,13 @@ OFSwitch13Device::SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
 
   // Creating the internal OpenFlow packet structure from ns-3 packet
   // Allocate buffer with some extra space for OpenFlow packet modifications.
+  // Only the packet headers are copied into the buffer, which is still sized
+  // for the entire packet so that the library accounts for the correct packet
+  // length on flow, group, and meter statistics.
   uint32_t headRoom = 128 + 2;
   uint32_t bodyRoom = packet->GetSize () + VLAN_ETH_HEADER_LEN;
-  struct ofpbuf *buffer = ofs::BufferFromPacket (packet, bodyRoom, headRoom);
+  struct ofpbuf *buffer = ofs::BufferFromPacketHeaders (
+      packet, GetPipelineHeaderLength (packet), bodyRoom, headRoom);
   struct packet *pkt = packet_create (m_datapath, portNo, buffer,
                                       tunnelId, false);
 
@@ -1015,7 +1170,270 @@ OFSwitch13Device::SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
   m_pipePkt.SetPacket (pkt->ns3_uid, packet);
 
   // Send the packet to pipeline.
-  pipeline_process_packet (m_datapath->pipeline, pkt);
+  PipelineProcessPacket (pkt, packet);
+}
+
+void
+OFSwitch13Device::PipelineProcessPacket (struct packet *pkt,
+                                         Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << pkt->ns3_uid);
+
+  struct pipeline *pl = m_datapath->pipeline;
+  if (!packet_handle_std_is_ttl_valid (pkt->handle_std))
+    {
+      if ((pl->dp->config.flags & OFPC_INVALID_TTL_TO_CONTROLLER) != 0)
+        {
+          send_packet_to_controller (pl, pkt, 0, OFPR_INVALID_TTL);
+        }
+      packet_destroy (pkt);
+      return;
+    }
+
+  // Look for this microflow in the cache. The flow entries matched by a
+  // packet only depend on its header fields and on the flow table contents,
+  // so all packets of a microflow match the same sequence of flow entries
+  // until the cache is invalidated by any table modification.
+  std::string key;
+  FlowEntryList_t *cached = 0;
+  FlowEntryList_t matched;
+  if (m_cacheSize)
+    {
+      key = GetMicroflowKey (pkt);
+      auto it = m_cache.find (key);
+      if (it != m_cache.end ())
+        {
+          cached = &it->second;
+          m_cCacheHit++;
+          m_cacheHitTrace (packet);
+        }
+      else
+        {
+          m_cCacheMiss++;
+          m_cacheMissTrace (packet);
+        }
+    }
+
+  struct flow_table *nextTable = pl->tables [0];
+  while (nextTable)
+    {
+      struct flow_table *table = nextTable;
+      struct flow_entry *entry = 0;
+      nextTable = 0;
+      pkt->table_id = table->stats->table_id;
+
+      if (cached && matched.size () < cached->size ())
+        {
+          // Reuse the cached flow entry, updating the same flow and table
+          // statistics that flow_table_lookup () would have updated.
+          entry = cached->at (matched.size ());
+          NS_ASSERT_MSG (entry->table == table, "Inconsistent microflow.");
+          table->stats->lookup_count++;
+          table->stats->matched_count++;
+          if (!entry->no_byt_count)
+            {
+              entry->stats->byte_count += pkt->buffer->size;
+            }
+          if (!entry->no_pkt_count)
+            {
+              entry->stats->packet_count++;
+            }
+          entry->last_used = time_msec ();
+        }
+      else
+        {
+          entry = flow_table_lookup (table, pkt);
+        }
+
+      if (!entry)
+        {
+          // OpenFlow 1.3 default behavior on a table miss.
+          NS_LOG_DEBUG ("No matching entry found. Dropping packet.");
+          packet_destroy (pkt);
+          return;
+        }
+      matched.push_back (entry);
+
+      // A table-miss flow entry wildcards all fields and has priority zero.
+      pkt->handle_std->table_miss =
+        entry->stats->priority == 0 && entry->match->length <= 4;
+      ExecuteFlowEntry (entry, &nextTable, &pkt);
+      if (!pkt)
+        {
+          // Packet destroyed by a meter instruction.
+          return;
+        }
+    }
+
+  // Only the complete sequence of matched entries is saved into the cache, as
+  // a packet dropped by a meter could have skipped some tables.
+  if (m_cacheSize && !cached)
+    {
+      if (m_cache.size () >= m_cacheSize)
+        {
+          FlushMicroflowCache ();
+        }
+      m_cache.insert (std::make_pair (key, matched));
+    }
+
+  // The cookie field is set to 0xffffffffffffffff because we cannot
+  // associate it to any particular flow.
+  action_set_execute (pkt->action_set, pkt, 0xffffffffffffffff);
+}
+
+void
+OFSwitch13Device::ExecuteFlowEntry (struct flow_entry *entry,
+                                    struct flow_table **nextTable,
+                                    struct packet **pkt)
+{
+  NS_LOG_FUNCTION (this << entry);
+
+  // Instructions are stored by the library in the order they must be
+  // executed: meter, apply-actions, clear-actions, write-actions,
+  // write-metadata, and goto-table.
+  for (size_t i = 0; i < entry->stats->instructions_num; i++)
+    {
+      if (!(*pkt))
+        {
+          // Packet was dropped by some instruction or action.
+          return;
+        }
+
+      struct ofl_instruction_header *inst = entry->stats->instructions [i];
+      switch (inst->type)
+        {
+        case (OFPIT_GOTO_TABLE):
+          {
+            struct ofl_instruction_goto_table *gi =
+              (struct ofl_instruction_goto_table*)inst;
+            *nextTable = m_datapath->pipeline->tables [gi->table_id];
+            break;
+          }
+        case (OFPIT_WRITE_METADATA):
+          {
+            struct ofl_instruction_write_metadata *wi =
+              (struct ofl_instruction_write_metadata*)inst;
+            struct ofl_match_tlv *f;
+            packet_handle_std_validate ((*pkt)->handle_std);
+            HMAP_FOR_EACH_WITH_HASH (f, struct ofl_match_tlv, hmap_node,
+                                     hash_int (OXM_OF_METADATA, 0),
+                                     &(*pkt)->handle_std->match.match_fields)
+            {
+              uint64_t *metadata = (uint64_t*)f->value;
+              *metadata = (*metadata & ~wi->metadata_mask)
+                | (wi->metadata & wi->metadata_mask);
+            }
+            break;
+          }
+        case (OFPIT_WRITE_ACTIONS):
+          {
+            struct ofl_instruction_actions *wa =
+              (struct ofl_instruction_actions*)inst;
+            action_set_write_actions ((*pkt)->action_set, wa->actions_num,
+                                      wa->actions);
+            break;
+          }
+        case (OFPIT_APPLY_ACTIONS):
+          {
+            struct ofl_instruction_actions *ia =
+              (struct ofl_instruction_actions*)inst;
+            dp_execute_action_list ((*pkt), ia->actions_num, ia->actions,
+                                    entry->stats->cookie);
+            break;
+          }
+        case (OFPIT_CLEAR_ACTIONS):
+          {
+            action_set_clear_actions ((*pkt)->action_set);
+            break;
+          }
+        case (OFPIT_METER):
+          {
+            struct ofl_instruction_meter *im =
+              (struct ofl_instruction_meter*)inst;
+            meter_table_apply (m_datapath->meters, pkt, im->meter_id);
+            break;
+          }
+        case (OFPIT_EXPERIMENTER):
+          {
+            dp_exp_inst ((*pkt), (struct ofl_instruction_experimenter*)inst);
+            break;
+          }
+        default:
+          {
+            NS_LOG_WARN ("Unknown instruction type " << inst->type);
+          }
+        }
+    }
+}
+
+std::string
+OFSwitch13Device::GetMicroflowKey (struct packet *pkt)
+{
+  if (!pkt->handle_std->valid)
+    {
+      packet_handle_std_validate (pkt->handle_std);
+    }
+
+  // The parsed OXM fields are always inserted in the same order for packets
+  // with the same headers, so the raw TLV sequence is an exact-match key.
+  std::string key;
+  key.append ((const char*)&pkt->in_port, sizeof (pkt->in_port));
+  key.append ((const char*)&pkt->tunnel_id, sizeof (pkt->tunnel_id));
+  struct ofl_match_tlv *f;
+  HMAP_FOR_EACH (f, struct ofl_match_tlv, hmap_node,
+                 &pkt->handle_std->match.match_fields)
+  {
+    key.append ((const char*)&f->header, sizeof (f->header));
+    key.append ((const char*)f->value, OXM_LENGTH (f->header));
+  }
+  return key;
+}
+
+void
+OFSwitch13Device::FlushMicroflowCache (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_cache.clear ();
+}
+
+uint32_t
+OFSwitch13Device::GetPipelineHeaderLength (Ptr<const Packet> packet) const
+{
+  if (m_headerBytes && m_headerBytes < packet->GetSize ())
+    {
+      return m_headerBytes;
+    }
+  return packet->GetSize ();
+}
+
+uint32_t
+OFSwitch13Device::GetPipelinePayloadLength (struct packet *pkt)
+{
+  // Packets created by the controller are entirely copied into the buffer.
+  if (!m_pipePkt.IsValid () || !m_pipePkt.HasId (pkt->ns3_uid))
+    {
+      return 0;
+    }
+  Ptr<Packet> packet = m_pipePkt.GetPacket ();
+  return packet->GetSize () - GetPipelineHeaderLength (packet);
+}
+
+void
+OFSwitch13Device::MaterializePayload (struct packet *pkt)
+{
+  NS_LOG_FUNCTION (this << pkt->ns3_uid);
+
+  // The payload is always at the end of the buffer, even after the pipeline
+  // pushed or popped some headers.
+  uint32_t payload = GetPipelinePayloadLength (pkt);
+  if (payload)
+    {
+      Ptr<Packet> packet = m_pipePkt.GetPacket ();
+      uint8_t *data = (uint8_t*)pkt->buffer->data + pkt->buffer->size - payload;
+      packet->CreateFragment (GetPipelineHeaderLength (packet), payload)
+        ->CopyData (data, payload);
+    }
 }
 
 int
@@ -1112,16 +1530,19 @@ OFSwitch13Device::ReceiveFromController (Ptr<Packet> packet, Address from)
     case (OFPT_FLOW_MOD):
       {
         m_cFlowMod++;
+        FlushMicroflowCache ();
         break;
       }
     case (OFPT_METER_MOD):
       {
         m_cMeterMod++;
+        FlushMicroflowCache ();
         break;
       }
     case (OFPT_GROUP_MOD):
       {
         m_cGroupMod++;
+        FlushMicroflowCache ();
         break;
       }
     default:
@@ -1439,18 +1860,22 @@ OFSwitch13Device::CopyTags (Ptr<const Packet> srcPkt, Ptr<const Packet> dstPkt)
 void
 OFSwitch13Device::RegisterDatapath (uint64_t id, Ptr<OFSwitch13Device> dev)
 {
-  std::pair<uint64_t, Ptr<OFSwitch13Device> > entry (id, dev);
-  auto ret = OFSwitch13Device::m_globalSwitchMap.insert (entry);
-  NS_ABORT_MSG_IF (ret.second == false, "Error when registering datapath.");
+  if (id >= OFSwitch13Device::m_globalSwitchList.size ())
+    {
+      OFSwitch13Device::m_globalSwitchList.resize (id + 1);
+    }
+  NS_ABORT_MSG_IF (OFSwitch13Device::m_globalSwitchList [id],
+                   "Error when registering datapath.");
+  OFSwitch13Device::m_globalSwitchList [id] = dev;
 }
 
 void
 OFSwitch13Device::UnregisterDatapath (uint64_t id)
 {
-  auto it = OFSwitch13Device::m_globalSwitchMap.find (id);
-  if (it != OFSwitch13Device::m_globalSwitchMap.end ())
+  if (id < OFSwitch13Device::m_globalSwitchList.size ()
+      && OFSwitch13Device::m_globalSwitchList [id])
     {
-      OFSwitch13Device::m_globalSwitchMap.erase (it);
+      OFSwitch13Device::m_globalSwitchList [id] = 0;
       return;
     }
   NS_ABORT_MSG ("Error when removing datapath.");
@@ -1466,7 +1891,8 @@ OFSwitch13Device::RemoteController::RemoteController ()
 
 OFSwitch13Device::PipelinePacket::PipelinePacket ()
   : m_valid (false),
-  m_packet (0)
+  m_packet (0),
+  m_nIds (0)
 {
 }
 
@@ -1476,7 +1902,7 @@ OFSwitch13Device::PipelinePacket::SetPacket (uint64_t id, Ptr<Packet> packet)
   NS_ASSERT_MSG (id && packet, "Invalid packet metadata values.");
   m_valid = true;
   m_packet = packet;
-  m_ids.push_back (id);
+  NewCopy (id);
 }
 
 Ptr<Packet>
@@ -1491,7 +1917,8 @@ OFSwitch13Device::PipelinePacket::Invalidate (void)
 {
   m_valid = false;
   m_packet = 0;
-  m_ids.clear ();
+  m_nIds = 0;
+  m_moreIds.clear ();
 }
 
 bool
@@ -1504,7 +1931,14 @@ void
 OFSwitch13Device::PipelinePacket::NewCopy (uint64_t id)
 {
   NS_ASSERT_MSG (m_valid, "Invalid packet metadata.");
-  m_ids.push_back (id);
+  if (m_nIds < m_inlineIds)
+    {
+      m_ids [m_nIds++] = id;
+    }
+  else
+    {
+      m_moreIds.push_back (id);
+    }
 }
 
 bool
@@ -1512,15 +1946,35 @@ OFSwitch13Device::PipelinePacket::DelCopy (uint64_t id)
 {
   NS_ASSERT_MSG (m_valid, "Invalid packet metadata.");
 
-  for (auto it = m_ids.begin (); it != m_ids.end (); it++)
+  // The order of IDs is not relevant, so the removed ID is replaced by the
+  // last one (moved from the vector to the inline array when necessary).
+  bool found = false;
+  for (uint32_t i = 0; i < m_nIds && !found; i++)
+    {
+      if (m_ids [i] == id)
+        {
+          found = true;
+          if (!m_moreIds.empty ())
+            {
+              m_ids [i] = m_moreIds.back ();
+              m_moreIds.pop_back ();
+            }
+          else
+            {
+              m_ids [i] = m_ids [--m_nIds];
+            }
+        }
+    }
+  for (auto it = m_moreIds.begin (); it != m_moreIds.end () && !found; it++)
     {
       if (*it == id)
         {
-          m_ids.erase (it);
-          break;
+          found = true;
+          *it = m_moreIds.back ();
+          m_moreIds.pop_back ();
         }
     }
-  if (m_ids.size () == 0)
+  if (m_nIds == 0)
     {
       Invalidate ();
     }
@@ -1532,9 +1986,16 @@ OFSwitch13Device::PipelinePacket::HasId (uint64_t id)
 {
   NS_ASSERT_MSG (m_valid, "Invalid packet metadata.");
 
-  for (auto it = m_ids.begin (); it != m_ids.end (); it++)
+  for (uint32_t i = 0; i < m_nIds; i++)
     {
-      if (*it == id)
+      if (m_ids [i] == id)
+        {
+          return true;
+        }
+    }
+  for (auto const &moreId : m_moreIds)
+    {
+      if (moreId == id)
         {
           return true;
         }
@@ -1546,6 +2007,10 @@ void
 OFSwitch13Device::SetNode (Ptr<Node> node)
 {
   m_node = node;
+
+  // The mobility model may be installed after the switch device, so let's
+  // wait for the simulation to start before looking for it.
+  Simulator::ScheduleNow (&OFSwitch13Device::StartCoverageTracking, this);
 }
 
 Ptr<Node>
@@ -1557,7 +2022,41 @@ OFSwitch13Device::GetNode ()
 void
 OFSwitch13Device::AddmmWaveEnbLocation (Vector location)
 {
-  m_mmWaveEnbLocations.push_back (location);
+  m_coverage->AddCellLocation (location);
+}
+
+Ptr<OFSwitch13CoverageTracker>
+OFSwitch13Device::GetCoverageTracker (void) const
+{
+  return m_coverage;
+}
+
+void
+OFSwitch13Device::StartCoverageTracking (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<MobilityModel> mobility = m_node->GetObject<MobilityModel> ();
+  if (mobility)
+    {
+      m_coverage->Start (mobility);
+    }
+}
+
+void
+OFSwitch13Device::NotifyCoverageChanged (bool inCoverage)
+{
+  NS_LOG_FUNCTION (this << inCoverage);
+
+  NS_LOG_INFO ("Switch node " << (inCoverage ? "entered" : "left") <<
+               " 5G coverage at " << Simulator::Now ().GetSeconds () << "s");
+  m_mmWaveCoverageTrace (inCoverage);
+
+  // Update the 5G port liveness right away, notifying the controller.
+  if (m_mmWavePort && m_mmWavePort <= m_ports.size ())
+    {
+      GetSwitchPort (m_mmWavePort)->PortUpdateState (inCoverage);
+    }
 }
 
 } // namespace ns3
@@ -29,7 +29,10 @@
 #include <ns3/traced-value.h>
 #include "ofswitch13-interface.h"
 #include "ofswitch13-socket-handler.h"
+#include "ofswitch13-coverage-tracker.h"
 #include "ns3/vector.h"
+#include <unordered_map>
+#include <deque>
 
 namespace ns3 {
 
@@ -80,7 +83,9 @@ private:
    * the ID for each packet copy (notified by the clone callback). Note that
    * only one packet can be in pipeline at a time, but the packet can have
    * multiple internal copies (each one will receive an unique packet ID), and
-   * can also be saved into buffer for latter usage.
+   * can also be saved into buffer for latter usage. As a packet rarely has
+   * more than a few copies alive at the same time, the first IDs are kept in
+   * an inline array, and only the remaining ones in a dynamic vector.
    */
   struct PipelinePacket
   {
@@ -128,9 +133,14 @@ public:
     bool HasId (uint64_t id);
 
 private:
+    /** Number of packet IDs kept in the inline array. */
+    static const uint32_t m_inlineIds = 4;
+
     bool                  m_valid;  //!< Valid flag.
     Ptr<Packet>           m_packet; //!< Packet pointer.
-    std::list<uint64_t>   m_ids;    //!< Internal list of IDs for this packet.
+    uint64_t              m_ids [m_inlineIds]; //!< First IDs for this packet.
+    uint32_t              m_nIds;   //!< Number of IDs in the inline array.
+    std::vector<uint64_t> m_moreIds; //!< Remaining IDs for this packet.
   }; // Struct PipelinePacket
 
 public:
@@ -165,6 +175,8 @@ public:
   uint64_t GetMeterModCounter     (void) const;
   uint64_t GetPacketInCounter     (void) const;
   uint64_t GetPacketOutCounter    (void) const;
+  uint64_t GetCacheHitCounter     (void) const;
+  uint64_t GetCacheMissCounter    (void) const;
   //\}
 
   /**
@@ -190,6 +202,8 @@ public:
   uint32_t GetMeterTableEntries   (void) const;
   uint32_t GetMeterTableSize      (void) const;
   double   GetMeterTableUsage     (void) const;
+  uint32_t GetMicroflowCacheEntries (void) const;
+  uint32_t GetMicroflowCacheSize  (void) const;
   uint32_t GetNControllers        (void) const;
   uint32_t GetNPipelineTables     (void) const;
   uint32_t GetNSwitchPorts        (void) const;
@@ -355,10 +369,30 @@ public:
    */
   typedef void (*DeviceTracedCallback)(Ptr<const OFSwitch13Device> dev);
 
+  /**
+   * TracedCallback signature for packets leaving the pipeline model.
+   * \param packet The packet.
+   * \param latency The time since the packet was received from the switch
+   *        port, including the time waiting for a lookup engine.
+   */
+  typedef void (*PipelineLatencyTracedCallback)(
+    Ptr<const Packet> packet, Time latency);
+
   void SetNode (Ptr<Node>);
   Ptr<Node> GetNode ();
+
+  /**
+   * Add the location of a mmWave eNB, used to track the 5G coverage of this
+   * switch node. See the OFSwitch13CoverageTracker class.
+   * \param location The eNB position.
+   */
   void AddmmWaveEnbLocation (Vector location);
 
+  /**
+   * \return The 5G coverage tracker of this switch node.
+   */
+  Ptr<OFSwitch13CoverageTracker> GetCoverageTracker (void) const;
+
 protected:
   // Inherited from Object
   virtual void DoDispose (void);
@@ -395,6 +429,19 @@ private:
    */
   void DatapathTimeout (struct datapath *dp);
 
+  /**
+   * Start tracking the 5G coverage of the switch node, when it has a mobility
+   * model and mmWave eNB locations.
+   */
+  void StartCoverageTracking (void);
+
+  /**
+   * Notify a change in the 5G coverage of the switch node, updating the state
+   * of the 5G port. Connected to the coverage tracker.
+   * \param inCoverage True if the node has entered the 5G coverage.
+   */
+  void NotifyCoverageChanged (bool inCoverage);
+
   /**
    * Create an OpenFlow packet in message and send the packet to all
    * controllers with open connections.
@@ -430,6 +477,95 @@ private:
   void SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
                        uint64_t tunnelId = 0);
 
+  /**
+   * Admit a packet received from a switch port into the pipeline lookup
+   * engines. With unlimited engines (the default), every packet is delayed by
+   * the current pipeline delay. Otherwise, the switch has a number of
+   * parallel lookup engines, each one split into a number of stages, so an
+   * engine can accept a new packet every pipeline delay / stages interval.
+   * Packets wait in a FIFO queue for the first engine able to accept them,
+   * and are dropped when this queue is full.
+   * \param packet The packet.
+   * \return The time until the packet leaves the pipeline model, or a
+   *         negative time if the packet must be dropped.
+   */
+  Time PipelineAdmit (Ptr<const Packet> packet);
+
+  /**
+   * Notify the end of the pipeline lookup and send the packet to the
+   * ofsoftswitch13 pipeline.
+   * \param packet The packet.
+   * \param portNo The switch input port number.
+   * \param tunnelId The metadata associated with a logical port.
+   * \param arrival The time the packet was received from the switch port.
+   */
+  void PipelineCompleted (Ptr<Packet> packet, uint32_t portNo,
+                          uint64_t tunnelId, Time arrival);
+
+  /**
+   * Process a packet received from a switch port through the pipeline flow
+   * tables. This method mirrors the ofsoftswitch13 pipeline_process_packet ()
+   * function, but looks up the exact-match microflow cache before searching
+   * the flow tables. On a cache hit, the flow entries matched by the first
+   * packet of this microflow are used again, skipping the flow table lookups.
+   * On a cache miss, the flow tables are searched as usual and the sequence of
+   * matched flow entries is saved into the cache for the next packets.
+   * \see ofsoftswitch13 function pipeline_process_packet () at
+   *      udatapath/pipeline.c
+   * \param pkt The internal packet to process.
+   * \param packet The ns-3 packet, for trace sources.
+   */
+  void PipelineProcessPacket (struct packet *pkt, Ptr<const Packet> packet);
+
+  /**
+   * Execute the instructions of a flow entry over a packet.
+   * \see ofsoftswitch13 function execute_entry () at udatapath/pipeline.c
+   * \param entry The flow entry.
+   * \param nextTable The next table to search, set by goto-table instruction.
+   * \param pkt The internal packet, set to 0 when dropped by a meter.
+   */
+  void ExecuteFlowEntry (struct flow_entry *entry,
+                         struct flow_table **nextTable, struct packet **pkt);
+
+  /**
+   * Build the microflow cache key for this packet. The key is the exact
+   * sequence of OXM fields parsed from the packet headers, including the
+   * input port and the tunnel ID.
+   * \param pkt The internal packet.
+   * \return The microflow key.
+   */
+  static std::string GetMicroflowKey (struct packet *pkt);
+
+  /**
+   * Invalidate all entries in the microflow cache. This must be called
+   * whenever flow, group or meter entries are added, modified, or removed.
+   */
+  void FlushMicroflowCache (void);
+
+  /**
+   * Get the number of bytes from the beginning of an ns-3 packet that are
+   * copied into the OpenFlow buffer when the packet enters the pipeline.
+   * \param packet The ns-3 packet.
+   * \return The number of header bytes.
+   */
+  uint32_t GetPipelineHeaderLength (Ptr<const Packet> packet) const;
+
+  /**
+   * Get the number of payload bytes of an internal packet that were not
+   * copied from its ns-3 packet into the OpenFlow buffer.
+   * \param pkt The internal packet.
+   * \return The number of payload bytes left in the ns-3 packet.
+   */
+  uint32_t GetPipelinePayloadLength (struct packet *pkt);
+
+  /**
+   * Copy the payload of the ns-3 packet into the OpenFlow buffer of an
+   * internal packet, for the few cases where the pipeline must expose the
+   * complete packet content (i.e., packet-in messages).
+   * \param pkt The internal packet.
+   */
+  void MaterializePayload (struct packet *pkt);
+
   /**
    * Send a packet to the controller node.
    * \see SendOpenflowBufferToRemote ().
@@ -570,14 +706,14 @@ private:
   static bool CopyTags (Ptr<const Packet> srcPkt, Ptr<const Packet> dstPkt);
 
   /**
-   * Insert a new OpenFlow device in global map. Called by device constructor.
+   * Insert a new OpenFlow device in global list. Called by device constructor.
    * \param id The datapath id.
    * \param dev The Ptr<OFSwitch13Device> pointer.
    */
   static void RegisterDatapath (uint64_t id, Ptr<OFSwitch13Device> dev);
 
   /**
-   * Remove an existing OpenFlow device from global map. Called by DoDispose.
+   * Remove an existing OpenFlow device from global list. Called by DoDispose.
    * \param id The datapath id.
    */
   static void UnregisterDatapath (uint64_t id);
@@ -588,11 +724,20 @@ private:
   /** Structure to save the list of active controllers. */
   typedef std::vector<Ptr<OFSwitch13Device::RemoteController> > CtrlList_t;
 
-  /** Structure to map datapath id to OpenFlow device. */
-  typedef std::map<uint64_t, Ptr<OFSwitch13Device> > DpIdDevMap_t;
+  /**
+   * Structure to map datapath id to OpenFlow device. Datapath ids are
+   * sequentially assigned, so they are used as indexes into this list.
+   */
+  typedef std::vector<Ptr<OFSwitch13Device> > DpIdDevList_t;
 
   /** Structure to save packets, indexed by its id. */
-  typedef std::map<uint64_t, Ptr<Packet> > IdPacketMap_t;
+  typedef std::unordered_map<uint64_t, Ptr<Packet> > IdPacketMap_t;
+
+  /** Sequence of flow entries matched by a microflow along the pipeline. */
+  typedef std::vector<struct flow_entry*> FlowEntryList_t;
+
+  /** Structure to map microflow keys to matched flow entries. */
+  typedef std::unordered_map<std::string, FlowEntryList_t> MicroflowCache_t;
 
   /** Trace source fired when a packet in buffer expires. */
   TracedCallback<Ptr<const Packet> > m_bufferExpireTrace;
@@ -612,9 +757,21 @@ private:
   /** Trace source fired when a packet is dropped by a meter band. */
   TracedCallback<Ptr<const Packet>, uint32_t> m_meterDropTrace;
 
+  /** Trace source fired when a packet hits the microflow cache. */
+  TracedCallback<Ptr<const Packet> > m_cacheHitTrace;
+
+  /** Trace source fired when a packet misses the microflow cache. */
+  TracedCallback<Ptr<const Packet> > m_cacheMissTrace;
+
   /** Trace source fired when a packet is sent to pipeline. */
   TracedCallback<Ptr<const Packet> > m_pipePacketTrace;
 
+  /** Trace source fired when a packet leaves the pipeline model. */
+  TracedCallback<Ptr<const Packet>, Time> m_pipeLatencyTrace;
+
+  /** Trace source fired when the switch node enters or leaves 5G coverage. */
+  TracedCallback<bool> m_mmWaveCoverageTrace;
+
   /** Number of entries in group table. */
   TracedValue<uint32_t> m_groupEntries;
 
@@ -645,6 +802,12 @@ private:
   IdPacketMap_t     m_bufferPkts;   //!< Packets saved in switch buffer.
   uint32_t          m_bufferSize;   //!< Buffer size in terms of packets.
   PipelinePacket    m_pipePkt;      //!< Packet under switch pipeline.
+  uint32_t          m_pipeEngines;  //!< Number of lookup engines.
+  uint32_t          m_pipeStages;   //!< Number of stages per engine.
+  uint32_t          m_pipeQueueSize; //!< Max packets waiting for an engine.
+  std::vector<Time> m_engineFree;   //!< Next start slot for each engine.
+  std::deque<Time>  m_pipeStarts;   //!< Start times of waiting packets.
+  Time              m_lastPipeDone; //!< Last pipeline completion time.
   DataRate          m_cpuCapacity;  //!< CPU processing capacity.
   uint64_t          m_cpuConsumed;  //!< CPU processing tokens consumed.
   uint64_t          m_cpuTokens;    //!< CPU processing tokens available.
@@ -653,23 +816,27 @@ private:
   uint64_t          m_cMeterMod;    //!< Pipeline meter mod counter.
   uint64_t          m_cPacketIn;    //!< Pipeline packet in counter.
   uint64_t          m_cPacketOut;   //!< Pipeline packet out counter.
+  uint64_t          m_cCacheHit;    //!< Microflow cache hit counter.
+  uint64_t          m_cCacheMiss;   //!< Microflow cache miss counter.
+  MicroflowCache_t  m_cache;        //!< Exact-match microflow cache.
+  uint32_t          m_cacheSize;    //!< Microflow cache maximum entries.
+  uint32_t          m_headerBytes;  //!< Header bytes copied to pipeline.
   Ptr<Node>         m_node;
-  std::vector<Vector> m_mmWaveEnbLocations;
-  bool              m_5gCoverage;
-  bool              m_firstLocationFetch;
+  Ptr<OFSwitch13CoverageTracker> m_coverage;  //!< 5G coverage tracker.
+  uint32_t          m_mmWavePort;   //!< Port number of the 5G interface.
 
   static uint64_t   m_globalDpId;   //!< Global counter for datapath IDs.
   static uint64_t   m_globalPktId;  //!< Global counter for packets IDs.
 
   /**
    * As the integration of ofsoftswitch13 and ns-3 involve overriding some C
-   * functions, we are using a global map to store a pointer to all
-   * OFSwitch13Device objects in simulation, and allow faster object retrieve
-   * by datapath id. In this way, static functions like
+   * functions, we are using a global list to store a pointer to all
+   * OFSwitch13Device objects in simulation, and allow constant time object
+   * retrieve by datapath id. In this way, static functions like
    * SendOpenflowBufferToRemote, DpActionsOutputPort, and other callbacks can
    * get the object pointer and call member functions.
    */
-  static DpIdDevMap_t m_globalSwitchMap;
+  static DpIdDevList_t m_globalSwitchList;
 
 }; // Class OFSwitch13Device
 
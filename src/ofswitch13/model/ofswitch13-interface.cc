@@ -27,6 +27,107 @@ NS_LOG_COMPONENT_DEFINE ("OFSwitch13Interface");
 namespace ns3 {
 namespace ofs {
 
+/**
+ * \ingroup ofswitch13
+ * Raw bytes written back by the OpenFlow pipeline in front of a packet
+ * payload, replacing the original packet headers.
+ */
+class RawHeader : public Header
+{
+public:
+  RawHeader ();
+  /**
+   * Complete constructor.
+   * \param data The header bytes.
+   * \param size The number of header bytes.
+   */
+  RawHeader (const uint8_t *data, uint32_t size);
+
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  // Inherited from Header
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t Deserialize (Buffer::Iterator start, Buffer::Iterator end);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  std::vector<uint8_t> m_data;  //!< The header bytes.
+};
+
+NS_OBJECT_ENSURE_REGISTERED (RawHeader);
+
+RawHeader::RawHeader ()
+{
+}
+
+RawHeader::RawHeader (const uint8_t *data, uint32_t size)
+  : m_data (data, data + size)
+{
+}
+
+TypeId
+RawHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ofs::RawHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("OFSwitch13")
+    .AddConstructor<RawHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RawHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RawHeader::GetSerializedSize (void) const
+{
+  return m_data.size ();
+}
+
+void
+RawHeader::Serialize (Buffer::Iterator start) const
+{
+  if (m_data.size ())
+    {
+      start.Write (&m_data [0], m_data.size ());
+    }
+}
+
+uint32_t
+RawHeader::Deserialize (Buffer::Iterator start)
+{
+  // The header size is unknown here, so no bytes are read.
+  return 0;
+}
+
+uint32_t
+RawHeader::Deserialize (Buffer::Iterator start, Buffer::Iterator end)
+{
+  m_data.resize (start.GetDistanceFrom (end));
+  if (m_data.size ())
+    {
+      start.Read (&m_data [0], m_data.size ());
+    }
+  return m_data.size ();
+}
+
+void
+RawHeader::Print (std::ostream &os) const
+{
+  os << "size=" << m_data.size ();
+}
+
 void
 EnableLibraryLog (bool printToFile, std::string prefix,
                   bool explicitFilename, std::string customLevels)
@@ -76,6 +177,36 @@ BufferFromPacket (Ptr<const Packet> packet, size_t bodyRoom, size_t headRoom)
   return buffer;
 }
 
+struct ofpbuf*
+BufferFromPacketHeaders (Ptr<const Packet> packet, size_t length,
+                         size_t bodyRoom, size_t headRoom)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NS_ASSERT (packet->GetSize () <= bodyRoom);
+  NS_ASSERT (length <= packet->GetSize ());
+  struct ofpbuf *buffer;
+  uint8_t *data;
+
+  buffer = ofpbuf_new_with_headroom (bodyRoom, headRoom);
+  data = (uint8_t*)ofpbuf_put_uninit (buffer, packet->GetSize ());
+  packet->CopyData (data, length);
+  return buffer;
+}
+
+void
+UpdatePacketFromBuffer (Ptr<Packet> packet, size_t length,
+                        struct ofpbuf *buffer, size_t headers)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NS_ASSERT (length <= packet->GetSize ());
+  NS_ASSERT (headers <= buffer->size);
+  packet->RemoveAtStart (length);
+  RawHeader header ((const uint8_t*)buffer->data, headers);
+  packet->AddHeader (header);
+}
+
 Ptr<Packet>
 PacketFromMsg (struct ofl_msg_header *msg, uint32_t xid)
 {
@@ -54,6 +54,7 @@ extern "C"
 #include "udatapath/dp_actions.h"
 #include "udatapath/dp_buffers.h"
 #include "udatapath/dp_control.h"
+#include "udatapath/dp_exp.h"
 #include "udatapath/dp_ports.h"
 #include "udatapath/flow_table.h"
 #include "udatapath/flow_entry.h"
@@ -72,6 +73,8 @@ extern "C"
 #include "oflib/ofl-structs.h"
 #include "oflib/oxm-match.h"
 
+#include "lib/hash.h"
+#include "lib/hmap.h"
 #include "lib/ofpbuf.h"
 #include "lib/timeval.h"
 #include "lib/vlog.h"
@@ -131,6 +134,35 @@ void EnableLibraryLog (bool printToFile = false, std::string prefix = "",
 struct ofpbuf* BufferFromPacket (Ptr<const Packet> packet, size_t bodyRoom,
                                  size_t headRoom = 0);
 
+/**
+ * \ingroup ofswitch13
+ * Create an internal ofsoftswitch13 buffer from ns3::Packet, loading only
+ * the first bytes of the packet. The buffer size is set to the packet size,
+ * but the data after the first \p length bytes is left unitialized. This
+ * way, the packet payload is never copied when only its headers are used.
+ * \param packet The ns-3 packet.
+ * \param length The number of bytes to load into the buffer.
+ * \param bodyRoom The size to allocate for data.
+ * \param headRoom The size to allocate for headers (left unitialized).
+ * \return The OpenFlow Buffer created from the packet.
+ */
+struct ofpbuf* BufferFromPacketHeaders (Ptr<const Packet> packet,
+                                        size_t length, size_t bodyRoom,
+                                        size_t headRoom = 0);
+
+/**
+ * \ingroup ofswitch13
+ * Update the headers of an ns3::Packet from internal ofsoftswitch13 buffer.
+ * Replaces the first \p length bytes of the packet by the first \p headers
+ * bytes of the buffer, keeping the packet payload, uid and tags.
+ * \param packet The ns-3 packet.
+ * \param length The number of bytes to remove from the packet.
+ * \param buffer The internal buffer.
+ * \param headers The number of bytes to copy from the buffer.
+ */
+void UpdatePacketFromBuffer (Ptr<Packet> packet, size_t length,
+                             struct ofpbuf *buffer, size_t headers);
+
 /**
  * \ingroup ofswitch13
  * Create a new ns3::Packet from internal OFLib message. Takes a ofl_msg_*
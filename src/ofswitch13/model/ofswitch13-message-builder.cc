@@ -0,0 +1,670 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ofswitch13-message-builder.h"
+
+NS_LOG_COMPONENT_DEFINE ("OFSwitch13MessageBuilder");
+
+namespace ns3 {
+namespace ofs {
+
+MessageBuilder::MessageBuilder ()
+{
+}
+
+MessageBuilder::~MessageBuilder ()
+{
+}
+
+Match::Match ()
+{
+  m_match = (struct ofl_match*)xmalloc (sizeof (struct ofl_match));
+  ofl_structs_match_init (m_match);
+}
+
+Match::~Match ()
+{
+  ofl_structs_free_match ((struct ofl_match_header*)m_match, 0);
+}
+
+Match&
+Match::InPort (uint32_t port)
+{
+  ofl_structs_match_put32 (m_match, OXM_OF_IN_PORT, port);
+  return *this;
+}
+
+Match&
+Match::TunnelId (uint64_t tunnelId)
+{
+  ofl_structs_match_put64 (m_match, OXM_OF_TUNNEL_ID, tunnelId);
+  return *this;
+}
+
+Match&
+Match::Metadata (uint64_t metadata, uint64_t mask)
+{
+  if (mask == ~0ULL)
+    {
+      ofl_structs_match_put64 (m_match, OXM_OF_METADATA, metadata);
+    }
+  else
+    {
+      ofl_structs_match_put64m (m_match, OXM_OF_METADATA_W, metadata, mask);
+    }
+  return *this;
+}
+
+Match&
+Match::EthType (uint16_t type)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_ETH_TYPE, type);
+  return *this;
+}
+
+Match&
+Match::EthSrc (Mac48Address address)
+{
+  uint8_t value[ETH_ADDR_LEN];
+  address.CopyTo (value);
+  ofl_structs_match_put_eth (m_match, OXM_OF_ETH_SRC, value);
+  return *this;
+}
+
+Match&
+Match::EthDst (Mac48Address address)
+{
+  uint8_t value[ETH_ADDR_LEN];
+  address.CopyTo (value);
+  ofl_structs_match_put_eth (m_match, OXM_OF_ETH_DST, value);
+  return *this;
+}
+
+Match&
+Match::VlanVid (uint16_t vid)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_VLAN_VID, vid | OFPVID_PRESENT);
+  return *this;
+}
+
+Match&
+Match::ArpOp (uint16_t op)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_ARP_OP, op);
+  return *this;
+}
+
+Match&
+Match::IpProto (uint8_t proto)
+{
+  ofl_structs_match_put8 (m_match, OXM_OF_IP_PROTO, proto);
+  return *this;
+}
+
+Match&
+Match::IpDscp (uint8_t dscp)
+{
+  ofl_structs_match_put8 (m_match, OXM_OF_IP_DSCP, dscp);
+  return *this;
+}
+
+// IPv4 addresses are kept in network byte order by the library.
+Match&
+Match::Ipv4Src (Ipv4Address address, Ipv4Mask mask)
+{
+  if (mask == Ipv4Mask::GetOnes ())
+    {
+      ofl_structs_match_put32 (m_match, OXM_OF_IPV4_SRC,
+                               htonl (address.Get ()));
+    }
+  else
+    {
+      ofl_structs_match_put32m (m_match, OXM_OF_IPV4_SRC_W,
+                                htonl (address.Get ()), htonl (mask.Get ()));
+    }
+  return *this;
+}
+
+Match&
+Match::Ipv4Dst (Ipv4Address address, Ipv4Mask mask)
+{
+  if (mask == Ipv4Mask::GetOnes ())
+    {
+      ofl_structs_match_put32 (m_match, OXM_OF_IPV4_DST,
+                               htonl (address.Get ()));
+    }
+  else
+    {
+      ofl_structs_match_put32m (m_match, OXM_OF_IPV4_DST_W,
+                                htonl (address.Get ()), htonl (mask.Get ()));
+    }
+  return *this;
+}
+
+Match&
+Match::TcpSrc (uint16_t port)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_TCP_SRC, port);
+  return *this;
+}
+
+Match&
+Match::TcpDst (uint16_t port)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_TCP_DST, port);
+  return *this;
+}
+
+Match&
+Match::UdpSrc (uint16_t port)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_UDP_SRC, port);
+  return *this;
+}
+
+Match&
+Match::UdpDst (uint16_t port)
+{
+  ofl_structs_match_put16 (m_match, OXM_OF_UDP_DST, port);
+  return *this;
+}
+
+struct ofl_match_header*
+Match::Get (void) const
+{
+  return (struct ofl_match_header*)m_match;
+}
+
+Actions::Actions ()
+{
+}
+
+Actions::~Actions ()
+{
+  for (auto &action : m_actions)
+    {
+      ofl_actions_free (action, 0);
+    }
+}
+
+struct ofl_action_header*
+Actions::Add (enum ofp_action_type type, size_t size)
+{
+  struct ofl_action_header *action =
+    (struct ofl_action_header*)xmalloc (size);
+  memset (action, 0, size);
+  action->type = type;
+  m_actions.push_back (action);
+  return action;
+}
+
+Actions&
+Actions::SetField (uint32_t header, const void *value)
+{
+  struct ofl_action_set_field *action =
+    (struct ofl_action_set_field*)Add (OFPAT_SET_FIELD,
+                                       sizeof (struct ofl_action_set_field));
+  action->field =
+    (struct ofl_match_tlv*)xmalloc (sizeof (struct ofl_match_tlv));
+  action->field->header = header;
+  action->field->value = (uint8_t*)xmalloc (OXM_LENGTH (header));
+  memcpy (action->field->value, value, OXM_LENGTH (header));
+  return *this;
+}
+
+Actions&
+Actions::Output (uint32_t port, uint16_t maxLen)
+{
+  struct ofl_action_output *action =
+    (struct ofl_action_output*)Add (OFPAT_OUTPUT,
+                                    sizeof (struct ofl_action_output));
+  action->port = port;
+  action->max_len = maxLen;
+  return *this;
+}
+
+Actions&
+Actions::Group (uint32_t groupId)
+{
+  struct ofl_action_group *action =
+    (struct ofl_action_group*)Add (OFPAT_GROUP,
+                                   sizeof (struct ofl_action_group));
+  action->group_id = groupId;
+  return *this;
+}
+
+Actions&
+Actions::SetQueue (uint32_t queueId)
+{
+  struct ofl_action_set_queue *action =
+    (struct ofl_action_set_queue*)Add (OFPAT_SET_QUEUE,
+                                       sizeof (struct ofl_action_set_queue));
+  action->queue_id = queueId;
+  return *this;
+}
+
+Actions&
+Actions::PushVlan (uint16_t ethType)
+{
+  struct ofl_action_push *action =
+    (struct ofl_action_push*)Add (OFPAT_PUSH_VLAN,
+                                  sizeof (struct ofl_action_push));
+  action->ethertype = ethType;
+  return *this;
+}
+
+Actions&
+Actions::PopVlan (void)
+{
+  Add (OFPAT_POP_VLAN, sizeof (struct ofl_action_header));
+  return *this;
+}
+
+Actions&
+Actions::DecIpTtl (void)
+{
+  Add (OFPAT_DEC_NW_TTL, sizeof (struct ofl_action_header));
+  return *this;
+}
+
+Actions&
+Actions::SetEthSrc (Mac48Address address)
+{
+  uint8_t value[ETH_ADDR_LEN];
+  address.CopyTo (value);
+  return SetField (OXM_OF_ETH_SRC, value);
+}
+
+Actions&
+Actions::SetEthDst (Mac48Address address)
+{
+  uint8_t value[ETH_ADDR_LEN];
+  address.CopyTo (value);
+  return SetField (OXM_OF_ETH_DST, value);
+}
+
+Actions&
+Actions::SetVlanVid (uint16_t vid)
+{
+  uint16_t value = vid | OFPVID_PRESENT;
+  return SetField (OXM_OF_VLAN_VID, &value);
+}
+
+Actions&
+Actions::SetIpDscp (uint8_t dscp)
+{
+  return SetField (OXM_OF_IP_DSCP, &dscp);
+}
+
+// IPv4 addresses are kept in network byte order by the library.
+Actions&
+Actions::SetIpv4Src (Ipv4Address address)
+{
+  uint32_t value = htonl (address.Get ());
+  return SetField (OXM_OF_IPV4_SRC, &value);
+}
+
+Actions&
+Actions::SetIpv4Dst (Ipv4Address address)
+{
+  uint32_t value = htonl (address.Get ());
+  return SetField (OXM_OF_IPV4_DST, &value);
+}
+
+Actions&
+Actions::SetTcpSrc (uint16_t port)
+{
+  return SetField (OXM_OF_TCP_SRC, &port);
+}
+
+Actions&
+Actions::SetTcpDst (uint16_t port)
+{
+  return SetField (OXM_OF_TCP_DST, &port);
+}
+
+Actions&
+Actions::SetUdpSrc (uint16_t port)
+{
+  return SetField (OXM_OF_UDP_SRC, &port);
+}
+
+Actions&
+Actions::SetUdpDst (uint16_t port)
+{
+  return SetField (OXM_OF_UDP_DST, &port);
+}
+
+Actions&
+Actions::SetTunnelId (uint64_t tunnelId)
+{
+  return SetField (OXM_OF_TUNNEL_ID, &tunnelId);
+}
+
+size_t
+Actions::GetN (void) const
+{
+  return m_actions.size ();
+}
+
+struct ofl_action_header**
+Actions::Get (void)
+{
+  return m_actions.empty () ? 0 : &m_actions [0];
+}
+
+FlowMod::FlowMod (enum ofp_flow_mod_command command)
+  : m_clear (false),
+    m_hasMeter (false),
+    m_hasMeta (false),
+    m_hasGoto (false)
+{
+  memset (&m_msg, 0, sizeof (m_msg));
+  m_msg.header.type = OFPT_FLOW_MOD;
+  m_msg.command = command;
+  m_msg.buffer_id = OFP_NO_BUFFER;
+  m_msg.out_port = OFPP_ANY;
+  m_msg.out_group = OFPG_ANY;
+  m_msg.priority = OFP_DEFAULT_PRIORITY;
+
+  m_meterInst.header.type = OFPIT_METER;
+  m_applyInst.header.type = OFPIT_APPLY_ACTIONS;
+  m_clearInst.type = OFPIT_CLEAR_ACTIONS;
+  m_writeInst.header.type = OFPIT_WRITE_ACTIONS;
+  m_metaInst.header.type = OFPIT_WRITE_METADATA;
+  m_gotoInst.header.type = OFPIT_GOTO_TABLE;
+}
+
+FlowMod::~FlowMod ()
+{
+}
+
+FlowMod&
+FlowMod::SetCommand (enum ofp_flow_mod_command command)
+{
+  m_msg.command = command;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetTable (uint8_t tableId)
+{
+  m_msg.table_id = tableId;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetPriority (uint16_t priority)
+{
+  m_msg.priority = priority;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetIdleTimeout (uint16_t timeout)
+{
+  m_msg.idle_timeout = timeout;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetHardTimeout (uint16_t timeout)
+{
+  m_msg.hard_timeout = timeout;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetCookie (uint64_t cookie, uint64_t mask)
+{
+  m_msg.cookie = cookie;
+  m_msg.cookie_mask = mask;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetFlags (uint16_t flags)
+{
+  m_msg.flags = flags;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetBufferId (uint32_t bufferId)
+{
+  m_msg.buffer_id = bufferId;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetOutPort (uint32_t port)
+{
+  m_msg.out_port = port;
+  return *this;
+}
+
+FlowMod&
+FlowMod::SetOutGroup (uint32_t groupId)
+{
+  m_msg.out_group = groupId;
+  return *this;
+}
+
+FlowMod&
+FlowMod::Meter (uint32_t meterId)
+{
+  m_hasMeter = true;
+  m_meterInst.meter_id = meterId;
+  return *this;
+}
+
+FlowMod&
+FlowMod::ClearActions (void)
+{
+  m_clear = true;
+  return *this;
+}
+
+FlowMod&
+FlowMod::WriteMetadata (uint64_t metadata, uint64_t mask)
+{
+  m_hasMeta = true;
+  m_metaInst.metadata = metadata;
+  m_metaInst.metadata_mask = mask;
+  return *this;
+}
+
+FlowMod&
+FlowMod::GotoTable (uint8_t tableId)
+{
+  m_hasGoto = true;
+  m_gotoInst.table_id = tableId;
+  return *this;
+}
+
+Match&
+FlowMod::GetMatch (void)
+{
+  return m_match;
+}
+
+Actions&
+FlowMod::ApplyActions (void)
+{
+  return m_apply;
+}
+
+Actions&
+FlowMod::WriteActions (void)
+{
+  return m_write;
+}
+
+struct ofl_msg_header*
+FlowMod::GetMessage (void)
+{
+  m_insts.clear ();
+  if (m_hasMeter)
+    {
+      m_insts.push_back ((struct ofl_instruction_header*)&m_meterInst);
+    }
+  if (m_apply.GetN ())
+    {
+      m_applyInst.actions_num = m_apply.GetN ();
+      m_applyInst.actions = m_apply.Get ();
+      m_insts.push_back ((struct ofl_instruction_header*)&m_applyInst);
+    }
+  if (m_clear)
+    {
+      m_insts.push_back (&m_clearInst);
+    }
+  if (m_write.GetN ())
+    {
+      m_writeInst.actions_num = m_write.GetN ();
+      m_writeInst.actions = m_write.Get ();
+      m_insts.push_back ((struct ofl_instruction_header*)&m_writeInst);
+    }
+  if (m_hasMeta)
+    {
+      m_insts.push_back ((struct ofl_instruction_header*)&m_metaInst);
+    }
+  if (m_hasGoto)
+    {
+      m_insts.push_back ((struct ofl_instruction_header*)&m_gotoInst);
+    }
+
+  m_msg.match = m_match.Get ();
+  m_msg.instructions_num = m_insts.size ();
+  m_msg.instructions = m_insts.empty () ? 0 : &m_insts [0];
+  return (struct ofl_msg_header*)&m_msg;
+}
+
+GroupMod::GroupMod (enum ofp_group_mod_command command,
+                    enum ofp_group_type type, uint32_t groupId)
+{
+  memset (&m_msg, 0, sizeof (m_msg));
+  m_msg.header.type = OFPT_GROUP_MOD;
+  m_msg.command = command;
+  m_msg.type = type;
+  m_msg.group_id = groupId;
+}
+
+GroupMod::~GroupMod ()
+{
+}
+
+Actions&
+GroupMod::AddBucket (uint16_t weight, uint32_t watchPort, uint32_t watchGroup)
+{
+  struct ofl_bucket bucket;
+  memset (&bucket, 0, sizeof (bucket));
+  bucket.weight = weight;
+  bucket.watch_port = watchPort;
+  bucket.watch_group = watchGroup;
+  m_buckets.push_back (bucket);
+  m_actions.emplace_back ();
+  return m_actions.back ();
+}
+
+struct ofl_msg_header*
+GroupMod::GetMessage (void)
+{
+  m_bucketPtrs.clear ();
+  auto actions = m_actions.begin ();
+  for (auto &bucket : m_buckets)
+    {
+      bucket.actions_num = actions->GetN ();
+      bucket.actions = actions->Get ();
+      m_bucketPtrs.push_back (&bucket);
+      ++actions;
+    }
+
+  m_msg.buckets_num = m_bucketPtrs.size ();
+  m_msg.buckets = m_bucketPtrs.empty () ? 0 : &m_bucketPtrs [0];
+  return (struct ofl_msg_header*)&m_msg;
+}
+
+MeterMod::MeterMod (enum ofp_meter_mod_command command, uint32_t meterId,
+                    uint16_t flags)
+{
+  memset (&m_msg, 0, sizeof (m_msg));
+  m_msg.header.type = OFPT_METER_MOD;
+  m_msg.command = command;
+  m_msg.flags = flags;
+  m_msg.meter_id = meterId;
+}
+
+MeterMod::~MeterMod ()
+{
+}
+
+MeterMod&
+MeterMod::AddDropBand (uint32_t rate, uint32_t burstSize)
+{
+  // The drop band is the common header of all band types.
+  struct ofl_meter_band_dscp_remark band;
+  memset (&band, 0, sizeof (band));
+  band.type = OFPMBT_DROP;
+  band.rate = rate;
+  band.burst_size = burstSize;
+  m_bands.push_back (band);
+  return *this;
+}
+
+MeterMod&
+MeterMod::AddDscpRemarkBand (uint32_t rate, uint8_t precLevel,
+                             uint32_t burstSize)
+{
+  struct ofl_meter_band_dscp_remark band;
+  memset (&band, 0, sizeof (band));
+  band.type = OFPMBT_DSCP_REMARK;
+  band.rate = rate;
+  band.burst_size = burstSize;
+  band.prec_level = precLevel;
+  m_bands.push_back (band);
+  return *this;
+}
+
+struct ofl_msg_header*
+MeterMod::GetMessage (void)
+{
+  m_bandPtrs.clear ();
+  for (auto &band : m_bands)
+    {
+      m_bandPtrs.push_back ((struct ofl_meter_band_header*)&band);
+    }
+
+  m_msg.meter_bands_num = m_bandPtrs.size ();
+  m_msg.bands = m_bandPtrs.empty () ? 0 : &m_bandPtrs [0];
+  return (struct ofl_msg_header*)&m_msg;
+}
+
+SetConfig::SetConfig (uint16_t missSendLen, uint16_t flags)
+{
+  m_msg.header.type = OFPT_SET_CONFIG;
+  m_msg.config = &m_config;
+  m_config.flags = flags;
+  m_config.miss_send_len = missSendLen;
+}
+
+struct ofl_msg_header*
+SetConfig::GetMessage (void)
+{
+  return (struct ofl_msg_header*)&m_msg;
+}
+
+} // namespace ofs
+} // namespace ns3
@@ -0,0 +1,364 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OFSWITCH13_MESSAGE_BUILDER_H
+#define OFSWITCH13_MESSAGE_BUILDER_H
+
+#include <ns3/ipv4-address.h>
+#include <ns3/mac48-address.h>
+#include "ofswitch13-interface.h"
+#include <list>
+#include <vector>
+
+namespace ns3 {
+namespace ofs {
+
+/**
+ * \ingroup ofswitch13
+ * Base class for the typed OpenFlow configuration messages built by the
+ * controller without going through the dpctl command-line syntax. Each
+ * builder owns all the OFLib structures it creates, which are released when
+ * the builder is destroyed. A builder can be sent several times, to one or
+ * more switches.
+ */
+class MessageBuilder
+{
+public:
+  MessageBuilder ();
+  virtual ~MessageBuilder ();
+
+  /**
+   * Get the OFLib message for this builder. The message remains owned by the
+   * builder and is only valid until the builder is modified or destroyed.
+   * \return The OFLib message.
+   */
+  virtual struct ofl_msg_header* GetMessage (void) = 0;
+
+private:
+  /** Copy constructor, disabled. */
+  MessageBuilder (const MessageBuilder &);
+  /** Assignment operator, disabled. \return This builder. */
+  MessageBuilder& operator= (const MessageBuilder &);
+};
+
+/**
+ * \ingroup ofswitch13
+ * The typed match fields of a flow entry. Addresses and ports are given in
+ * host byte order, as in the ns-3 classes.
+ */
+class Match
+{
+public:
+  Match ();
+  ~Match ();
+
+  /**
+   * \name Match fields
+   * Add an exact (or masked) match on the given field.
+   * \return This match, for chaining.
+   */
+  //\{
+  Match& InPort     (uint32_t port);
+  Match& TunnelId   (uint64_t tunnelId);
+  Match& Metadata   (uint64_t metadata, uint64_t mask = ~0ULL);
+  Match& EthType    (uint16_t type);
+  Match& EthSrc     (Mac48Address address);
+  Match& EthDst     (Mac48Address address);
+  Match& VlanVid    (uint16_t vid);
+  Match& ArpOp      (uint16_t op);
+  Match& IpProto    (uint8_t proto);
+  Match& IpDscp     (uint8_t dscp);
+  Match& Ipv4Src    (Ipv4Address address, Ipv4Mask mask = Ipv4Mask::GetOnes ());
+  Match& Ipv4Dst    (Ipv4Address address, Ipv4Mask mask = Ipv4Mask::GetOnes ());
+  Match& TcpSrc     (uint16_t port);
+  Match& TcpDst     (uint16_t port);
+  Match& UdpSrc     (uint16_t port);
+  Match& UdpDst     (uint16_t port);
+  //\}
+
+  /** \return The OFLib match structure, owned by this object. */
+  struct ofl_match_header* Get (void) const;
+
+private:
+  /** Copy constructor, disabled. */
+  Match (const Match &);
+  /** Assignment operator, disabled. \return This match. */
+  Match& operator= (const Match &);
+
+  struct ofl_match *m_match;  //!< OFLib match structure.
+};
+
+/**
+ * \ingroup ofswitch13
+ * A typed list of OpenFlow actions, used by flow entry instructions and group
+ * buckets. Actions are kept in the order they are added.
+ */
+class Actions
+{
+public:
+  Actions ();
+  ~Actions ();
+
+  /**
+   * \name Actions
+   * Append an action to this list.
+   * \return This action list, for chaining.
+   */
+  //\{
+  Actions& Output     (uint32_t port, uint16_t maxLen = OFPCML_NO_BUFFER);
+  Actions& Group      (uint32_t groupId);
+  Actions& SetQueue   (uint32_t queueId);
+  Actions& PushVlan   (uint16_t ethType = 0x8100);
+  Actions& PopVlan    (void);
+  Actions& DecIpTtl   (void);
+  Actions& SetEthSrc  (Mac48Address address);
+  Actions& SetEthDst  (Mac48Address address);
+  Actions& SetVlanVid (uint16_t vid);
+  Actions& SetIpDscp  (uint8_t dscp);
+  Actions& SetIpv4Src (Ipv4Address address);
+  Actions& SetIpv4Dst (Ipv4Address address);
+  Actions& SetTcpSrc  (uint16_t port);
+  Actions& SetTcpDst  (uint16_t port);
+  Actions& SetUdpSrc  (uint16_t port);
+  Actions& SetUdpDst  (uint16_t port);
+  Actions& SetTunnelId (uint64_t tunnelId);
+  //\}
+
+  /** \return The number of actions in this list. */
+  size_t GetN (void) const;
+
+  /**
+   * \return The array of OFLib actions, owned by this object, or 0 for an
+   * empty list.
+   */
+  struct ofl_action_header** Get (void);
+
+private:
+  /** Copy constructor, disabled. */
+  Actions (const Actions &);
+  /** Assignment operator, disabled. \return This action list. */
+  Actions& operator= (const Actions &);
+
+  /**
+   * Allocate a new action and append it to this list.
+   * \param type The action type.
+   * \param size The size of the OFLib action structure.
+   * \return The new action.
+   */
+  struct ofl_action_header* Add (enum ofp_action_type type, size_t size);
+
+  /**
+   * Append a set-field action to this list.
+   * \param header The OXM field header.
+   * \param value The field value, with OXM_LENGTH (header) bytes.
+   * \return This action list.
+   */
+  Actions& SetField (uint32_t header, const void *value);
+
+  std::vector<struct ofl_action_header*> m_actions;  //!< OFLib actions.
+};
+
+/**
+ * \ingroup ofswitch13
+ * A typed OpenFlow flow-mod message. Equivalent to the dpctl command
+ * "flow-mod cmd=add,table=0,prio=500 in_port=1,eth_type=0x0800
+ * apply:output=2", for instance, is:
+ * \code
+ *   ofs::FlowMod flowMod (OFPFC_ADD);
+ *   flowMod.SetTable (0).SetPriority (500);
+ *   flowMod.GetMatch ().InPort (1).EthType (0x0800);
+ *   flowMod.ApplyActions ().Output (2);
+ *   SendToSwitch (swtch, flowMod);
+ * \endcode
+ */
+class FlowMod : public MessageBuilder
+{
+public:
+  /**
+   * Complete constructor.
+   * \param command The flow-mod command.
+   */
+  FlowMod (enum ofp_flow_mod_command command = OFPFC_ADD);
+  virtual ~FlowMod ();
+
+  /**
+   * \name Flow-mod fields
+   * \return This flow-mod, for chaining.
+   */
+  //\{
+  FlowMod& SetCommand     (enum ofp_flow_mod_command command);
+  FlowMod& SetTable       (uint8_t tableId);
+  FlowMod& SetPriority    (uint16_t priority);
+  FlowMod& SetIdleTimeout (uint16_t timeout);
+  FlowMod& SetHardTimeout (uint16_t timeout);
+  FlowMod& SetCookie      (uint64_t cookie, uint64_t mask = 0);
+  FlowMod& SetFlags       (uint16_t flags);
+  FlowMod& SetBufferId    (uint32_t bufferId);
+  FlowMod& SetOutPort     (uint32_t port);
+  FlowMod& SetOutGroup    (uint32_t groupId);
+  //\}
+
+  /**
+   * \name Flow-mod instructions
+   * Instructions are sent in the order the switch executes them: meter,
+   * apply-actions, clear-actions, write-actions, write-metadata, and
+   * goto-table.
+   * \return This flow-mod, for chaining.
+   */
+  //\{
+  FlowMod& Meter          (uint32_t meterId);
+  FlowMod& ClearActions   (void);
+  FlowMod& WriteMetadata  (uint64_t metadata, uint64_t mask = ~0ULL);
+  FlowMod& GotoTable      (uint8_t tableId);
+  //\}
+
+  /** \return The match fields of this flow entry. */
+  Match& GetMatch (void);
+
+  /** \return The actions of the apply-actions instruction. */
+  Actions& ApplyActions (void);
+
+  /** \return The actions of the write-actions instruction. */
+  Actions& WriteActions (void);
+
+  // Inherited from MessageBuilder
+  struct ofl_msg_header* GetMessage (void);
+
+private:
+  struct ofl_msg_flow_mod                 m_msg;        //!< Message.
+  Match                                   m_match;      //!< Match fields.
+  Actions                                 m_apply;      //!< Apply actions.
+  Actions                                 m_write;      //!< Write actions.
+  bool                                    m_clear;      //!< Clear actions.
+  bool                                    m_hasMeter;   //!< Meter set.
+  bool                                    m_hasMeta;    //!< Metadata set.
+  bool                                    m_hasGoto;    //!< Goto set.
+  struct ofl_instruction_meter            m_meterInst;  //!< Meter.
+  struct ofl_instruction_actions          m_applyInst;  //!< Apply-actions.
+  struct ofl_instruction_header           m_clearInst;  //!< Clear-actions.
+  struct ofl_instruction_actions          m_writeInst;  //!< Write-actions.
+  struct ofl_instruction_write_metadata   m_metaInst;   //!< Write-metadata.
+  struct ofl_instruction_goto_table       m_gotoInst;   //!< Goto-table.
+  std::vector<struct ofl_instruction_header*> m_insts;  //!< Instructions.
+};
+
+/**
+ * \ingroup ofswitch13
+ * A typed OpenFlow group-mod message.
+ */
+class GroupMod : public MessageBuilder
+{
+public:
+  /**
+   * Complete constructor.
+   * \param command The group-mod command.
+   * \param type The group type.
+   * \param groupId The group ID.
+   */
+  GroupMod (enum ofp_group_mod_command command, enum ofp_group_type type,
+            uint32_t groupId);
+  virtual ~GroupMod ();
+
+  /**
+   * Add a bucket to this group.
+   * \param weight The bucket weight, for select groups.
+   * \param watchPort The port whose liveness is watched, for fast failover.
+   * \param watchGroup The group whose liveness is watched, for fast failover.
+   * \return The actions of the new bucket.
+   */
+  Actions& AddBucket (uint16_t weight = 0, uint32_t watchPort = OFPP_ANY,
+                      uint32_t watchGroup = OFPG_ANY);
+
+  // Inherited from MessageBuilder
+  struct ofl_msg_header* GetMessage (void);
+
+private:
+  struct ofl_msg_group_mod            m_msg;          //!< Message.
+  std::list<Actions>                  m_actions;      //!< Bucket actions.
+  std::vector<struct ofl_bucket>      m_buckets;      //!< Buckets.
+  std::vector<struct ofl_bucket*>     m_bucketPtrs;   //!< Bucket pointers.
+};
+
+/**
+ * \ingroup ofswitch13
+ * A typed OpenFlow meter-mod message.
+ */
+class MeterMod : public MessageBuilder
+{
+public:
+  /**
+   * Complete constructor.
+   * \param command The meter-mod command.
+   * \param meterId The meter ID.
+   * \param flags The meter flags (OFPMF_KBPS by default).
+   */
+  MeterMod (enum ofp_meter_mod_command command, uint32_t meterId,
+            uint16_t flags = OFPMF_KBPS);
+  virtual ~MeterMod ();
+
+  /**
+   * Add a drop band to this meter.
+   * \param rate The band rate, in kbps or pktps depending on flags.
+   * \param burstSize The band burst size.
+   * \return This meter-mod, for chaining.
+   */
+  MeterMod& AddDropBand (uint32_t rate, uint32_t burstSize = 0);
+
+  /**
+   * Add a DSCP remark band to this meter.
+   * \param rate The band rate, in kbps or pktps depending on flags.
+   * \param precLevel The number of drop precedence levels to add.
+   * \param burstSize The band burst size.
+   * \return This meter-mod, for chaining.
+   */
+  MeterMod& AddDscpRemarkBand (uint32_t rate, uint8_t precLevel,
+                               uint32_t burstSize = 0);
+
+  // Inherited from MessageBuilder
+  struct ofl_msg_header* GetMessage (void);
+
+private:
+  struct ofl_msg_meter_mod                        m_msg;      //!< Message.
+  std::list<struct ofl_meter_band_dscp_remark>    m_bands;    //!< Bands.
+  std::vector<struct ofl_meter_band_header*>      m_bandPtrs; //!< Pointers.
+};
+
+/**
+ * \ingroup ofswitch13
+ * A typed OpenFlow set-config message.
+ */
+class SetConfig : public MessageBuilder
+{
+public:
+  /**
+   * Complete constructor.
+   * \param missSendLen The max bytes of new flow that datapath should send to
+   *        the controller.
+   * \param flags The OFPC_* flags.
+   */
+  SetConfig (uint16_t missSendLen, uint16_t flags = OFPC_FRAG_NORMAL);
+
+  // Inherited from MessageBuilder
+  struct ofl_msg_header* GetMessage (void);
+
+private:
+  struct ofl_msg_set_config   m_msg;      //!< Message.
+  struct ofl_config           m_config;   //!< Switch configuration.
+};
+
+} // namespace ofs
+} // namespace ns3
+#endif /* OFSWITCH13_MESSAGE_BUILDER_H */
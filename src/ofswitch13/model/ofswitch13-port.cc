@@ -21,12 +21,16 @@
 #include <ns3/ethernet-header.h>
 #include <ns3/ethernet-trailer.h>
 #include <ns3/pointer.h>
+#include <ns3/double.h>
+#include <ns3/spectrum-value.h>
 #include <ns3/csma-net-device.h>
 #include <ns3/virtual-net-device.h>
 #include <ns3/wifi-net-device.h>
 #include <ns3/lte-ue-net-device.h>
 #include <ns3/mmwave-ue-net-device.h>
 #include <ns3/mc-ue-net-device.h>
+#include <ns3/mmwave-ue-phy.h>
+#include <cmath>
 #include "ofswitch13-device.h"
 #include "ofswitch13-port.h"
 #include "tunnel-id-tag.h"
@@ -57,7 +61,9 @@ OFSwitch13Port::OFSwitch13Port ()
   m_portNo (0),
   m_swPort (0),
   m_netDev (0),
-  m_openflowDev (0)
+  m_openflowDev (0),
+  m_radioLive (true),
+  m_inCoverage (true)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -102,7 +108,24 @@ OFSwitch13Port::GetTypeId (void)
                    ObjectFactoryValue (GetDefaultQueueFactory ()),
                    MakeObjectFactoryAccessor (&OFSwitch13Port::m_factQueue),
                    MakeObjectFactoryChecker ())
-
+    .AddAttribute ("SinrDownThreshold",
+                   "Radio quality (SINR in dB) below which a wireless port "
+                   "goes down.",
+                   DoubleValue (-3.0),
+                   MakeDoubleAccessor (&OFSwitch13Port::m_sinrDown),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SinrUpThreshold",
+                   "Radio quality (SINR in dB) above which a wireless port "
+                   "that went down comes back up.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&OFSwitch13Port::m_sinrUp),
+                   MakeDoubleChecker<double> ())
+
+    .AddTraceSource ("RadioQuality",
+                     "Traced value indicating the radio quality (average "
+                     "SINR in dB) of a wireless port.",
+                     MakeTraceSourceAccessor (&OFSwitch13Port::m_radioQuality),
+                     "ns3::TracedValueCallback::Double")
     .AddTraceSource ("SwitchPortRx",
                      "Trace source indicating a packet received at this port.",
                      MakeTraceSourceAccessor (&OFSwitch13Port::m_rxTrace),
@@ -121,7 +144,9 @@ OFSwitch13Port::OFSwitch13Port (struct datapath *dp, Ptr<NetDevice> netDev,
   m_portNo (0),
   m_swPort (0),
   m_netDev (netDev),
-  m_openflowDev (openflowDev)
+  m_openflowDev (openflowDev),
+  m_radioLive (true),
+  m_inCoverage (true)
 {
   NS_LOG_FUNCTION (this << netDev << openflowDev);
 
@@ -233,11 +258,17 @@ OFSwitch13Port::NotifyConstructionCompleted ()
     {
       mmWaveUeDev->SetOpenFlowReceiveCallback (
         MakeCallback (&OFSwitch13Port::Receive, this));
+      mmWaveUeDev->GetPhy ()->TraceConnectWithoutContext (
+        "ReportCurrentCellRsrpSinr",
+        MakeCallback (&OFSwitch13Port::NotifyMmWaveSinr, this));
     }
   else if (mcUeDev)
     {
       mcUeDev->SetOpenFlowReceiveCallback (
         MakeCallback (&OFSwitch13Port::Receive, this));
+      mcUeDev->GetMmWavePhy ()->TraceConnectWithoutContext (
+        "ReportCurrentCellRsrpSinr",
+        MakeCallback (&OFSwitch13Port::NotifyMmWaveSinr, this));
     }
   else
     {
@@ -274,37 +305,45 @@ OFSwitch13Port::GetSwitchDevice (void) const
 bool
 OFSwitch13Port::PortUpdateState ()
 {
-  uint32_t orig_state = m_swPort->conf->state;
-  if (m_netDev->IsLinkUp ())
-    {
-      m_swPort->conf->state &= ~OFPPS_LINK_DOWN;
-    }
-  else
-    {
-      m_swPort->conf->state |= OFPPS_LINK_DOWN;
-    }
-  dp_port_live_update (m_swPort);
+  return SetPortState (m_netDev->IsLinkUp () && m_radioLive && m_inCoverage);
+}
 
-  if (orig_state != m_swPort->conf->state)
+bool
+OFSwitch13Port::PortUpdateState (bool inCoverage)
+{
+  m_inCoverage = inCoverage;
+  return PortUpdateState ();
+}
+
+void
+OFSwitch13Port::UpdateRadioQuality (double sinr)
+{
+  NS_LOG_FUNCTION (this << sinr);
+
+  m_radioQuality = sinr;
+
+  // Hysteresis between both thresholds avoids flapping the port at the edge.
+  bool live = m_radioLive ? sinr >= m_sinrDown : sinr > m_sinrUp;
+  if (live != m_radioLive)
     {
-      NS_LOG_INFO ("Previous state: " << orig_state << ", current state: " << m_swPort->conf->state);
-      NS_LOG_INFO ("Port status has changed. Notifying the controller.");
-      struct ofl_msg_port_status msg;
-      msg.header.type = OFPT_PORT_STATUS;
-      msg.reason = OFPPR_MODIFY;
-      msg.desc = m_swPort->conf;
-      dp_send_message (m_swPort->dp, (struct ofl_msg_header*)&msg, 0);
-      return true;
+      NS_LOG_INFO ("Radio quality " << sinr << " dB, port " <<
+                   (live ? "up" : "down"));
+      m_radioLive = live;
+      PortUpdateState ();
     }
-  return false;
 }
 
 bool
-OFSwitch13Port::PortUpdateState (bool in5gRange)
+OFSwitch13Port::IsRadioLive (void) const
+{
+  return m_radioLive;
+}
+
+bool
+OFSwitch13Port::SetPortState (bool live)
 {
   uint32_t orig_state = m_swPort->conf->state;
-//  if (m_netDev->IsLinkUp () && in5gRange)
-  if (in5gRange)
+  if (live)
     {
       m_swPort->conf->state &= ~OFPPS_LINK_DOWN;
     }
@@ -328,6 +367,16 @@ OFSwitch13Port::PortUpdateState (bool in5gRange)
   return false;
 }
 
+void
+OFSwitch13Port::NotifyMmWaveSinr (uint64_t imsi, SpectrumValue &sinr,
+                                  SpectrumValue &power)
+{
+  NS_LOG_FUNCTION (this << imsi);
+
+  double avgSinr = Sum (sinr) / sinr.GetSpectrumModel ()->GetNumBands ();
+  UpdateRadioQuality (10 * std::log10 (avgSinr));
+}
+
 uint32_t
 OFSwitch13Port::GetPortFeatures ()
 {
@@ -25,6 +25,7 @@
 #include <ns3/net-device.h>
 #include <ns3/packet.h>
 #include <ns3/traced-callback.h>
+#include <ns3/traced-value.h>
 #include "ofswitch13-interface.h"
 #include "ofswitch13-queue.h"
 
@@ -35,6 +36,7 @@ namespace ns3 {
 extern template class Queue<Packet>;
 
 class OFSwitch13Device;
+class SpectrumValue;
 
 /**
  * \ingroup ofswitch13
@@ -43,6 +45,11 @@ class OFSwitch13Device;
  * OpenFlow device through the OpenFlow receive callback. This class handles
  * the ofsoftswitch13 internal sw_port structure.
  * \see ofsoftswitch13 udatapath/dp_ports.h
+ * For mmWave UE devices, the port liveness also follows the radio quality:
+ * the port goes down when the SINR reported by the UE PHY drops below the
+ * SinrDownThreshold attribute, and comes back when it rises above the
+ * SinrUpThreshold attribute. Setting the down threshold above the PHY outage
+ * threshold lets the controller fail over before packets are lost.
  * \attention Each underlying NetDevice used as port must only be assigned
  *            a MAC Address. Adding an Ipv4/IPv6 layer to it may cause error.
  */
@@ -106,7 +113,29 @@ public:
    */
   bool PortUpdateState ();
 
-  bool PortUpdateState (bool in5gRange);
+  /**
+   * Update the port state field based on NetDevice status and on the radio
+   * coverage for wireless ports, and notify the controller when changes
+   * occurs. The port is live only when the NetDevice link is up, the node
+   * is in coverage and the radio quality is good enough. The coverage state
+   * is kept for later updates.
+   * \param inCoverage True if the node is within radio coverage.
+   * \return true if the state of the port has changed, false otherwise.
+   */
+  bool PortUpdateState (bool inCoverage);
+
+  /**
+   * Update the radio quality of a wireless port, applying the liveness
+   * hysteresis. When the liveness changes, the port state is updated and the
+   * controller is notified.
+   * \param sinr The average SINR over the channel bandwidth (in dB).
+   */
+  void UpdateRadioQuality (double sinr);
+
+  /**
+   * \return True if the radio quality of this port is good enough to use it.
+   */
+  bool IsRadioLive (void) const;
 
   /**
    * Send a packet over this OpenFlow switch port. It will check port
@@ -136,6 +165,23 @@ private:
    */
   uint32_t GetPortFeatures ();
 
+  /**
+   * Set the port state field and notify the controller when changes occurs.
+   * \param live True if the port is live.
+   * \return true if the state of the port has changed, false otherwise.
+   */
+  bool SetPortState (bool live);
+
+  /**
+   * Notify the SINR measured by the mmWave UE PHY. Connected to the
+   * MmWaveUePhy ReportCurrentCellRsrpSinr trace source.
+   * \param imsi The UE IMSI.
+   * \param sinr The SINR for each resource block (linear).
+   * \param power Unused (the trace source reports the SINR twice).
+   */
+  void NotifyMmWaveSinr (uint64_t imsi, SpectrumValue &sinr,
+                         SpectrumValue &power);
+
   /**
    * Called when a packet is received on this OpenFlow switch port by the
    * underlying NetDevice. It will check port configuration, update counter
@@ -159,6 +205,9 @@ private:
   /** Trace source fired when a packet will be sent over this switch port. */
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
+  /** Radio quality (average SINR in dB) of wireless ports. */
+  TracedValue<double>       m_radioQuality;
+
   uint64_t                  m_dpId;         //!< OpenFlow datapath ID.
   uint32_t                  m_portNo;       //!< Port number.
   struct sw_port*           m_swPort;       //!< ofsoftswitch13 port structure.
@@ -166,6 +215,10 @@ private:
   Ptr<OFSwitch13Queue>      m_portQueue;    //!< OpenFlow port Queue.
   ObjectFactory             m_factQueue;    //!< Factory for port queue.
   Ptr<OFSwitch13Device>     m_openflowDev;  //!< OpenFlow device.
+  bool                      m_radioLive;    //!< Radio quality liveness.
+  bool                      m_inCoverage;   //!< Last radio coverage state.
+  double                    m_sinrUp;       //!< SINR to bring port up.
+  double                    m_sinrDown;     //!< SINR to bring port down.
 };
 
 } // namespace ns3
@@ -18,6 +18,7 @@
  * Author: Luciano Chaves <luciano@lrc.ic.unicamp.br>
  */
 
+#include <ns3/boolean.h>
 #include "ofswitch13-socket-handler.h"
 
 namespace ns3 {
@@ -31,6 +32,13 @@ OFSwitch13SocketHandler::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::OFSwitch13SocketHandler")
     .SetParent<Object> ()
     .SetGroupName ("OFSwitch13")
+    .AddAttribute ("CoalesceMessages",
+                   "Write messages queued within the same simulation event "
+                   "to the socket with a single send operation.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (
+                     &OFSwitch13SocketHandler::m_coalesce),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -39,7 +47,8 @@ OFSwitch13SocketHandler::OFSwitch13SocketHandler (Ptr<Socket> socket)
   : m_socket (socket),
   m_pendingPacket (0),
   m_pendingBytes (0),
-  m_txQueue ()
+  m_txQueue (),
+  m_coalesce (true)
 {
   NS_LOG_FUNCTION (this << socket);
 
@@ -68,9 +77,20 @@ OFSwitch13SocketHandler::SendMessage (Ptr<Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet);
 
-  // Insert this message into tx queue and try to forward it to the socket.
+  // Insert this message into tx queue and schedule the socket write for the
+  // end of the current event, so other messages can be coalesced with it.
   m_txQueue.push (packet);
-  Send (m_socket, m_socket->GetTxAvailable ());
+  if (!m_coalesce)
+    {
+      Send (m_socket, m_socket->GetTxAvailable ());
+    }
+  else if (!m_flushEvent.IsRunning ())
+    {
+      // Keep a reference to this handler until the event runs.
+      m_flushEvent = Simulator::ScheduleNow (
+          &OFSwitch13SocketHandler::Flush,
+          Ptr<OFSwitch13SocketHandler> (this));
+    }
   return 0;
 }
 
@@ -79,10 +99,22 @@ OFSwitch13SocketHandler::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
 
+  m_flushEvent.Cancel ();
   m_socket = 0;
   m_pendingPacket = 0;
 }
 
+void
+OFSwitch13SocketHandler::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_socket)
+    {
+      Send (m_socket, m_socket->GetTxAvailable ());
+    }
+}
+
 void
 OFSwitch13SocketHandler::Send (Ptr<Socket> socket, uint32_t available)
 {
@@ -93,14 +125,28 @@ OFSwitch13SocketHandler::Send (Ptr<Socket> socket, uint32_t available)
       // Get a reference for the next packet in the queue and check for
       // available space in socket tx buffer.
       Ptr<Packet> packet = m_txQueue.front ();
-      if (socket->GetTxAvailable () < packet->GetSize ())
+      uint32_t txAvailable = socket->GetTxAvailable ();
+      if (txAvailable < packet->GetSize ())
         {
           NS_LOG_WARN ("No space available to send message now.");
           return;
         }
 
-      // Remove the packet from the queue and send it to the socket.
+      // Remove the packet from the queue and append the following messages
+      // that also fit into the socket tx buffer, so they are sent together.
       m_txQueue.pop ();
+      if (m_coalesce && !m_txQueue.empty ()
+          && packet->GetSize () + m_txQueue.front ()->GetSize () <= txAvailable)
+        {
+          packet = packet->Copy ();
+          while (!m_txQueue.empty ()
+                 && packet->GetSize () + m_txQueue.front ()->GetSize ()
+                 <= txAvailable)
+            {
+              packet->AddAtEnd (m_txQueue.front ());
+              m_txQueue.pop ();
+            }
+        }
       int retval = socket->Send (packet);
       if (retval == -1)
         {
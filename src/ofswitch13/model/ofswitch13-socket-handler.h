@@ -40,7 +40,10 @@ namespace ns3 {
  * method. On the other direction, the TCP socket send callback is connected to
  * the Send () method that forwards OpenFlow message received by the
  * SendMessage () method to the open socket, respecting the original order of
- * the messages.
+ * the messages. Messages queued within the same simulation event are coalesced
+ * and written to the socket with a single Send () call, so bursts of small
+ * messages share TCP segments instead of producing one segment each. This can
+ * be disabled with the CoalesceMessages attribute.
  */
 class OFSwitch13SocketHandler : public Object
 {
@@ -90,6 +93,11 @@ private:
    */
   void Send (Ptr<Socket> socket, uint32_t available);
 
+  /**
+   * Write all messages queued during the current event to the socket.
+   */
+  void Flush (void);
+
   /**
    * Callback for bytes available in rx buffer.
    * \param socket The connected socket.
@@ -101,6 +109,8 @@ private:
   uint32_t                  m_pendingBytes;   //!< Pending bytes for message.
   MessageCallback           m_receivedMsg;    //!< OpenFlow message callback.
   std::queue<Ptr<Packet> >  m_txQueue;        //!< TX queue.
+  EventId                   m_flushEvent;     //!< Pending flush event.
+  bool                      m_coalesce;       //!< Coalesce queued messages.
 };
 
 } // namespace ns3
@@ -144,6 +144,9 @@ QosController::ConfigureBorderSwitch (Ptr<const RemoteSwitch> swtch)
 {
   NS_LOG_FUNCTION (this << swtch);
 
+  // Send the whole configuration as a single batch
+  StartBatch (swtch);
+
   // For packet-in messages, send only the first 128 bytes to the controller
   DpctlExecute (swtch, "set-config miss=128");
 
@@ -190,6 +193,7 @@ QosController::ConfigureBorderSwitch (Ptr<const RemoteSwitch> swtch)
                 "in_port=3,eth_type=0x0800,ip_proto=6 apply:group=3");
   DpctlExecute (swtch, "flow-mod cmd=add,table=0,prio=700 "
                 "in_port=4,eth_type=0x0800,ip_proto=6 apply:group=3");
+  CommitBatch (swtch);
 }
 
 void
@@ -197,6 +201,9 @@ QosController::ConfigureAggregationSwitch (Ptr<const RemoteSwitch> swtch)
 {
   NS_LOG_FUNCTION (this << swtch);
 
+  // Send the whole configuration as a single batch
+  StartBatch (swtch);
+
   if (m_linkAggregation)
     {
       // Configure Group #1 for aggregating links 1 and 2
@@ -220,6 +227,7 @@ QosController::ConfigureAggregationSwitch (Ptr<const RemoteSwitch> swtch)
   // Packets from input port 3 are redirected to group 1
   DpctlExecute (swtch, "flow-mod cmd=add,table=0,prio=500 "
                 "in_port=3 write:group=1");
+  CommitBatch (swtch);
 }
 
 ofl_err
@@ -377,25 +385,22 @@ QosController::HandleConnectionRequest (
   // If enable, install the metter entry for this connection
   if (m_meterEnable)
     {
-      std::ostringstream meterCmd;
-      meterCmd << "meter-mod cmd=add,flags=1,meter=" << connectionCounter
-               << " drop:rate=" << m_meterRate.GetBitRate () / 1000;
-      DpctlExecute (swtch, meterCmd.str ());
+      ofs::MeterMod meterMod (OFPMC_ADD, connectionCounter);
+      meterMod.AddDropBand (m_meterRate.GetBitRate () / 1000);
+      ExecuteMessage (swtch, meterMod);
     }
 
   // Install the flow entry for this TCP connection
-  std::ostringstream flowCmd;
-  flowCmd << "flow-mod cmd=add,table=0,prio=1000 eth_type=0x0800,ip_proto=6"
-          << ",ip_src=" << srcIp
-          << "ip_dst=" << m_serverIpAddress
-          << ",tcp_dst=" << m_serverTcpPort
-          << ",tcp_src=" << srcPort;
+  ofs::FlowMod flowMod (OFPFC_ADD);
+  flowMod.SetTable (0).SetPriority (1000);
+  flowMod.GetMatch ().EthType (0x0800).IpProto (6).Ipv4Src (srcIp)
+    .Ipv4Dst (serverIp).TcpDst (m_serverTcpPort).TcpSrc (srcPort);
   if (m_meterEnable)
     {
-      flowCmd << " meter:" << connectionCounter;
+      flowMod.Meter (connectionCounter);
     }
-  flowCmd << " write:group=" << serverNumber;
-  DpctlExecute (swtch, flowCmd.str ());
+  flowMod.WriteActions ().Group (serverNumber);
+  ExecuteMessage (swtch, flowMod);
 
   // Create group action with server number
   struct ofl_action_group *action =
@@ -22,11 +22,14 @@
 #include <ns3/traffic-type-controller.h>
 #include <ns3/network-module.h>
 #include <ns3/internet-module.h>
+#include <ns3/hash.h>
 
 NS_LOG_COMPONENT_DEFINE ("TrafficTypeController");
 NS_OBJECT_ENSURE_REGISTERED (TrafficTypeController);
 
 TrafficTypeController::TrafficTypeController ()
+  : m_lastStats (Seconds (0)),
+  m_reroutePort (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -42,6 +45,15 @@ TrafficTypeController::DoDispose ()
   NS_LOG_FUNCTION (this);
 
   m_arpTable.clear ();
+  m_radioPorts.clear ();
+  m_shadows.clear ();
+  if (m_reroutePort)
+    {
+      m_reroutePort->TraceDisconnectWithoutContext (
+        "SwitchPortTx",
+        MakeCallback (&TrafficTypeController::NotifyReroutedPacket, this));
+      m_reroutePort = 0;
+    }
   OFSwitch13Controller::DoDispose ();
 }
 
@@ -62,6 +74,32 @@ TrafficTypeController::GetTypeId (void)
                    DataRateValue (DataRate ("256Kbps")),
                    MakeDataRateAccessor (&TrafficTypeController::m_meterRate),
                    MakeDataRateChecker ())
+    .AddAttribute ("LinkAggregation",
+                   "Spread new connections over all available radio "
+                   "interfaces, with weights updated from port and queue "
+                   "statistics.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (
+                     &TrafficTypeController::m_linkAggregation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LossThreshold",
+                   "Radio loss ratio above which the link aggregation weight "
+                   "of the radio is halved.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TrafficTypeController::m_lossThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("MmWavePort",
+                   "The switch port attached to the mmWave interface.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&TrafficTypeController::m_mmWavePort),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PortFailover",
+                   "Move the active connection between the mmWave and LTE "
+                   "interfaces on mmWave port status changes, instead of "
+                   "at fixed times.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TrafficTypeController::m_portFailover),
+                   MakeBooleanChecker ())
     .AddAttribute ("ServerIpAddr",
                    "Server IPv4 address.",
                    AddressValue (Address (Ipv4Address ("10.1.1.1"))),
@@ -77,6 +115,19 @@ TrafficTypeController::GetTypeId (void)
                    AddressValue (Address (Mac48Address ("00:00:00:00:00:01"))),
                    MakeAddressAccessor (&TrafficTypeController::m_serverMacAddress),
                    MakeAddressChecker ())
+    .AddAttribute ("StatsInterval",
+                   "Interval between radio statistics requests for link "
+                   "aggregation.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&TrafficTypeController::m_statsInterval),
+                   MakeTimeChecker (MilliSeconds (10)))
+    .AddTraceSource ("RerouteLatency",
+                     "Trace source indicating the time between a reroute "
+                     "trigger at the controller and the first packet sent "
+                     "by the switch over the new port.",
+                     MakeTraceSourceAccessor (
+                       &TrafficTypeController::m_rerouteTrace),
+                     "ns3::TrafficTypeController::RerouteTracedCallback")
   ;
   return tid;
 }
@@ -135,6 +186,24 @@ TrafficTypeController::ConfigureCarSwitch (Ptr<const RemoteSwitch> swtch)
 {
   NS_LOG_FUNCTION (this << swtch);
 
+  // Radio interfaces available for the connections: LTE on port 4 through
+  // group 1, and mmWave through group 2.
+  RadioPort radio = {0, true, 10, 0, 0, 0, 0, 0};
+  radio.group = 1;
+  m_radioPorts [4] = radio;
+  radio.group = 2;
+  m_radioPorts [m_mmWavePort] = radio;
+  if (m_linkAggregation)
+    {
+      m_lastStats = Simulator::Now ();
+      Simulator::Schedule (m_statsInterval,
+                           &TrafficTypeController::RequestRadioStats,
+                           this, swtch);
+    }
+
+  // Send the whole configuration as a single batch
+  StartBatch (swtch);
+
   // For packet-in messages, send only the first 128 bytes to the controller
   DpctlExecute (swtch, "set-config miss=128");
 
@@ -160,15 +229,18 @@ TrafficTypeController::ConfigureCarSwitch (Ptr<const RemoteSwitch> swtch)
   //                   ",set_field=eth_src:00:00:00:00:00:01,output=1");
   //   }
 
-  // Group #1 to send traffic out from LTE interface (port 4)
-  DpctlExecute (swtch, "group-mod cmd=add,type=ind,group=1 "
-                "weight=0,port=any,group=any "
-                "output=4");
+  // Group #1 to send traffic out from LTE interface (port 4), and group #2
+  // to send traffic out from mmWave interface. Each one uses the other
+  // interface as backup.
+  ofs::GroupMod lteGroup (OFPGC_ADD, OFPGT_INDIRECT, 1);
+  lteGroup.AddBucket ().Output (4);
+  ExecuteMessage (swtch, lteGroup);
+  AddShadowGroup (swtch, 1, 4, m_mmWavePort);
 
-  // Group #2 to send traffic out from mmWave interface (port 5)
-  DpctlExecute (swtch, "group-mod cmd=add,type=ind,group=2 "
-                "weight=0,port=any,group=any "
-                "output=5");
+  ofs::GroupMod mmWaveGroup (OFPGC_ADD, OFPGT_INDIRECT, 2);
+  mmWaveGroup.AddBucket ().Output (m_mmWavePort);
+  ExecuteMessage (swtch, mmWaveGroup);
+  AddShadowGroup (swtch, 2, m_mmWavePort, 4);
 
   // DpctlExecute (swtch, "group-mod cmd=add,type=ind,group=3 "
   //               "weight=0,port=any,group=any set_field=ip_dst:10.1.1.4"
@@ -231,6 +303,7 @@ TrafficTypeController::ConfigureCarSwitch (Ptr<const RemoteSwitch> swtch)
   // DpctlExecute (swtch, "flow-mod cmd=add,table=0,prio=201 "
   //               "eth_type=0x0800,in_port=6, apply:group=4");
 
+  CommitBatch (swtch);
 }
 
 // void
@@ -367,26 +440,31 @@ TrafficTypeController::HandleConnectionRequest (
 
   if (dstIp==Ipv4Address("1.0.0.2"))
     {
-    // Select a  route number to assign this connection
-    uint16_t routeNumber = 2;
+    // Select a route number to assign this connection: the mmWave interface
+    // (group 2) when it is available, or the LTE interface (group 1).
+    uint16_t routeNumber;
+    if (m_linkAggregation)
+      {
+        routeNumber = SelectRoute (srcIp, dstIp, 17, srcPort, dstPort);
+      }
+    else
+      {
+        routeNumber = (m_portFailover && !IsRadioLive (m_mmWavePort)) ? 1 : 2;
+      }
     NS_LOG_INFO ("Connection assigned to route " << routeNumber);
 
     // If enable, install the metter entry for this connection
     if (m_meterEnable)
       {
-        std::ostringstream meterCmd;
-        meterCmd << "meter-mod cmd=add,flags=1,meter=" << routeNumber
-                 << " drop:rate=" << m_meterRate.GetBitRate () / 1000;
-        DpctlExecute (swtch, meterCmd.str ());
+        ofs::MeterMod meterMod (OFPMC_ADD, routeNumber);
+        meterMod.AddDropBand (m_meterRate.GetBitRate () / 1000);
+        ExecuteMessage (swtch, meterMod);
       }
 
     // Install the group entry for the return path
-    std::ostringstream flowCmd;
-    flowCmd << "group-mod cmd=add,type=ind,group=" << routeNumber+2
-            << " weight=0,port=any,group=any set_field=ip_dst:" << srcIp
-            << ",set_field=eth_dst:" << srcMac
-            << ",output=" << inPort;
-    DpctlExecute (swtch, flowCmd.str ());
+    ofs::GroupMod groupMod (OFPGC_ADD, OFPGT_INDIRECT, routeNumber + 2);
+    groupMod.AddBucket ().SetIpv4Dst (srcIp).SetEthDst (srcMac).Output (inPort);
+    ExecuteMessage (swtch, groupMod);
 
     // DpctlExecute (swtch, "flow-mod cmd=add,table=0,prio=201 "
     //               "eth_type=0x0800,in_port=6, apply:group=4");
@@ -395,29 +473,25 @@ TrafficTypeController::HandleConnectionRequest (
     //               "in_port=3 write:group=1");
 
     // Install the flow entry for the return path
-    flowCmd.str(std::string());
-    flowCmd << "flow-mod cmd=add,table=0,prio=1000"
-            << " eth_type=0x0800,ip_proto=17"
-            << ",ip_src=" << dstIp
-            << ",udp_dst=" << srcPort
-            << ",udp_src=" << dstPort;
+    ofs::FlowMod returnMod (OFPFC_ADD);
+    returnMod.SetTable (0).SetPriority (1000);
+    returnMod.GetMatch ().EthType (0x0800).IpProto (17).Ipv4Src (dstIp)
+      .UdpDst (srcPort).UdpSrc (dstPort);
     if (m_meterEnable)
       {
-        flowCmd << " meter:" << routeNumber;
+        returnMod.Meter (routeNumber);
       }
-    flowCmd << " apply:group=" << routeNumber+2;
-    DpctlExecute (swtch, flowCmd.str ());
+    returnMod.ApplyActions ().Group (routeNumber + 2);
+    ExecuteMessage (swtch, returnMod);
 
     // Install the flow entry for this UDP connection
-    flowCmd.str(std::string());
-    flowCmd << "flow-mod cmd=add,table=0,prio=800 "
-            << " eth_type=0x0800,ip_proto=17"
-            << ",ip_src=" << srcIp
-            << ",ip_dst=" << dstIp
-            << ",udp_dst=" << dstPort
-            << ",udp_src=" << srcPort
-            << " apply:group=" << routeNumber;
-    DpctlExecute (swtch, flowCmd.str ());
+    ofs::FlowMod flowMod (OFPFC_ADD);
+    flowMod.SetTable (0).SetPriority (800);
+    flowMod.GetMatch ().EthType (0x0800).IpProto (17).Ipv4Src (srcIp)
+      .Ipv4Dst (dstIp).UdpDst (dstPort).UdpSrc (srcPort);
+    flowMod.ApplyActions ().Group (routeNumber);
+    ExecuteMessage (swtch, flowMod);
+    AddShadowFlow (swtch, srcIp, dstIp, srcPort, dstPort, routeNumber);
 
     // Create group action with routeNumber
     struct ofl_action_group *action =
@@ -447,9 +521,12 @@ TrafficTypeController::HandleConnectionRequest (
   // All handlers must free the message when everything is ok
   ofl_msg_free ((struct ofl_msg_header*)msg, 0);
 
-  Simulator::Schedule (Seconds(5.0), &TrafficTypeController::SwitchInterface, this, swtch, xid, 1);
-  Simulator::Schedule (Seconds(11.0), &TrafficTypeController::SwitchInterface, this, swtch, xid, 2);
-  std::cout << "Scheduled call to method SwitchInterface" << std::endl;
+  if (!m_portFailover)
+    {
+      Simulator::Schedule (Seconds (5.0), &TrafficTypeController::SwitchInterface, this, swtch, xid, 1);
+      Simulator::Schedule (Seconds (11.0), &TrafficTypeController::SwitchInterface, this, swtch, xid, 2);
+      NS_LOG_INFO ("Scheduled interface switching at fixed times.");
+    }
   return 0;
 }
 
@@ -457,55 +534,334 @@ ofl_err
 TrafficTypeController::SwitchInterface (
   Ptr<const RemoteSwitch> swtch, uint32_t xid, uint16_t altRouteNumber)
 {
-  std::cout << "Successfull call to method" << std::endl;
-  // Mac48Address hostMac = Mac48Address ("00:00:00:00:00:15");
-  Ipv4Address hostIp = Ipv4Address ("10.1.1.4");
-  Ipv4Address serverIp = Ipv4Address ("1.0.0.2");
-  uint16_t localPort = 1000;
-  uint16_t remotePort = 2000;
-  // uint16_t ofSwitchHostPort = 3;
-  // uint16_t routeNumber = 1;
-  // uint16_t altRouteNumber = 2;
-
-  // Add the group entry for the return path  /* (Not necessary actually) */
-  std::ostringstream flowCmd;
-  // flowCmd << "group-mod cmd=add,type=ind,group=" << altRouteNumber + 2
-  //         << " weight=0,port=any,group=any set_field=ip_dst:" << hostIp
-  //         << ",set_field=eth_dst:" << hostMac
-  //         << ",output=" << ofSwitchHostPort;
-  // DpctlExecute (swtch, flowCmd.str ());
-
-  // Modify the flow entry for the return path /* (Not necessary if redirecting to existing OF group) */
-  // flowCmd.str(std::string());
-  // flowCmd << "flow-mod cmd=mod,table=0,prio=1000"
-  //         << " eth_type=0x0800,ip_proto=17"
-  //         << ",ip_src=" << serverIp
-  //         << ",udp_dst=" << localPort
-  //         << ",udp_src=" << remotePort;
-  // if (m_meterEnable)
-  //   {
-  //     flowCmd << " meter:" << altRouteNumber + 2;
-  //   }
-  //
-  // /* Because we are dealing with traffic from/to same devices with same udp port Numbers
-  // This flow can be kept redirecting to existing group 4 */
-  // flowCmd << " apply:group=" << routeNumber + 2;
-  // DpctlExecute (swtch, flowCmd.str ());
-
-  // Modify the flow entry for this UDP connection
-  flowCmd.str(std::string());
-  flowCmd << "flow-mod cmd=mod,table=0,prio=800 "
-          << " eth_type=0x0800,ip_proto=17"
-          << ",ip_src=" << hostIp
-          << ",ip_dst=" << serverIp
-          << ",udp_dst=" << remotePort
-          << ",udp_src=" << localPort
-          << " apply:group=" << altRouteNumber;
-  DpctlExecute (swtch, flowCmd.str ());
+  NS_LOG_FUNCTION (this << swtch << xid << altRouteNumber);
+
+  NS_LOG_INFO ("Moving connections to route " << altRouteNumber);
+  auto shadow = m_shadows.find (swtch->GetDpId ());
+  if (shadow == m_shadows.end ())
+    {
+      return 0;
+    }
+
+  // The flow-mod messages for this move were built when the connections were
+  // installed, so the handover decision only sends them.
+  bool moved = false;
+  for (auto &it : shadow->second.flows)
+    {
+      ShadowFlow &flow = it.second;
+      auto move = flow.moves.find (altRouteNumber);
+      if (flow.group != altRouteNumber && move != flow.moves.end ())
+        {
+          ExecuteMessage (swtch, *move->second);
+          flow.group = altRouteNumber;
+          moved = true;
+        }
+    }
+
+  auto group = shadow->second.groups.find (altRouteNumber);
+  if (moved && group != shadow->second.groups.end ())
+    {
+      StartRerouteMeasure (swtch, group->second.port);
+    }
+  return 0;
+}
+
+ofl_err
+TrafficTypeController::HandlePortStatus (
+  struct ofl_msg_port_status *msg, Ptr<const RemoteSwitch> swtch,
+  uint32_t xid)
+{
+  NS_LOG_FUNCTION (this << swtch << xid);
+
+  auto it = m_radioPorts.find (msg->desc->port_no);
+  if (msg->reason == OFPPR_MODIFY && it != m_radioPorts.end ())
+    {
+      bool live = !(msg->desc->state & OFPPS_LINK_DOWN);
+      if (live != it->second.live)
+        {
+          NS_LOG_INFO ("Radio port " << it->first << " is " <<
+                       (live ? "up" : "down"));
+          it->second.live = live;
+          if (m_portFailover)
+            {
+              RerouteGroups (swtch, it->first, live);
+            }
+        }
+    }
+
+  // All handlers must free the message when everything is ok
+  ofl_msg_free ((struct ofl_msg_header*)msg, 0);
+  return 0;
+}
+
+void
+TrafficTypeController::AddShadowGroup (Ptr<const RemoteSwitch> swtch,
+                                       uint32_t groupId, uint32_t primaryPort,
+                                       uint32_t backupPort)
+{
+  NS_LOG_FUNCTION (this << swtch << groupId << primaryPort << backupPort);
+
+  ShadowGroup &group = m_shadows [swtch->GetDpId ()].groups [groupId];
+  group.port = primaryPort;
+  group.primaryPort = primaryPort;
+  group.backupPort = backupPort;
+  group.toBackup.reset (
+    new ofs::GroupMod (OFPGC_MODIFY, OFPGT_INDIRECT, groupId));
+  group.toBackup->AddBucket ().Output (backupPort);
+  group.toPrimary.reset (
+    new ofs::GroupMod (OFPGC_MODIFY, OFPGT_INDIRECT, groupId));
+  group.toPrimary->AddBucket ().Output (primaryPort);
+}
+
+void
+TrafficTypeController::AddShadowFlow (Ptr<const RemoteSwitch> swtch,
+                                      Ipv4Address srcIp, Ipv4Address dstIp,
+                                      uint16_t srcPort, uint16_t dstPort,
+                                      uint32_t groupId)
+{
+  NS_LOG_FUNCTION (this << swtch << srcIp << dstIp << srcPort << dstPort <<
+                   groupId);
+
+  SwitchShadow &shadow = m_shadows [swtch->GetDpId ()];
+  ShadowFlow &flow =
+    shadow.flows [std::make_tuple (srcIp, dstIp, srcPort, dstPort)];
+  flow.group = groupId;
+  flow.moves.clear ();
+  for (auto const &group : shadow.groups)
+    {
+      ofs::FlowMod *flowMod = new ofs::FlowMod (OFPFC_MODIFY);
+      flowMod->SetTable (0).SetPriority (800);
+      flowMod->GetMatch ().EthType (0x0800).IpProto (17).Ipv4Src (srcIp)
+        .Ipv4Dst (dstIp).UdpDst (dstPort).UdpSrc (srcPort);
+      flowMod->ApplyActions ().Group (group.first);
+      flow.moves [group.first].reset (flowMod);
+    }
+}
+
+void
+TrafficTypeController::RerouteGroups (Ptr<const RemoteSwitch> swtch,
+                                      uint32_t portNo, bool live)
+{
+  NS_LOG_FUNCTION (this << swtch << portNo << live);
+
+  auto shadow = m_shadows.find (swtch->GetDpId ());
+  if (shadow == m_shadows.end ())
+    {
+      return;
+    }
+
+  for (auto &it : shadow->second.groups)
+    {
+      ShadowGroup &group = it.second;
+      if (!live && group.port == portNo && IsRadioLive (group.backupPort))
+        {
+          ExecuteMessage (swtch, *group.toBackup);
+          group.port = group.backupPort;
+        }
+      else if (live && group.primaryPort == portNo && group.port != portNo)
+        {
+          ExecuteMessage (swtch, *group.toPrimary);
+          group.port = portNo;
+        }
+      else
+        {
+          continue;
+        }
+      NS_LOG_INFO ("Route group " << it.first << " moved to port " <<
+                   group.port);
+
+      // Measure the reroute latency when connections use this group.
+      for (auto const &flow : shadow->second.flows)
+        {
+          if (flow.second.group == it.first)
+            {
+              StartRerouteMeasure (swtch, group.port);
+              break;
+            }
+        }
+    }
+}
+
+void
+TrafficTypeController::StartRerouteMeasure (Ptr<const RemoteSwitch> swtch,
+                                            uint32_t portNo)
+{
+  NS_LOG_FUNCTION (this << swtch << portNo);
+
+  if (m_reroutePort)
+    {
+      m_reroutePort->TraceDisconnectWithoutContext (
+        "SwitchPortTx",
+        MakeCallback (&TrafficTypeController::NotifyReroutedPacket, this));
+    }
+  m_rerouteTime = Simulator::Now ();
+  m_reroutePort =
+    OFSwitch13Device::GetDevice (swtch->GetDpId ())->GetSwitchPort (portNo);
+  m_reroutePort->TraceConnectWithoutContext (
+    "SwitchPortTx",
+    MakeCallback (&TrafficTypeController::NotifyReroutedPacket, this));
+}
+
+void
+TrafficTypeController::NotifyReroutedPacket (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  Time latency = Simulator::Now () - m_rerouteTime;
+  NS_LOG_INFO ("Reroute latency: " << latency.As (Time::MS));
+  m_rerouteTrace (latency);
+
+  m_reroutePort->TraceDisconnectWithoutContext (
+    "SwitchPortTx",
+    MakeCallback (&TrafficTypeController::NotifyReroutedPacket, this));
+  m_reroutePort = 0;
+}
+
+ofl_err
+TrafficTypeController::HandleMultipartReply (
+  struct ofl_msg_multipart_reply_header *msg, Ptr<const RemoteSwitch> swtch,
+  uint32_t xid)
+{
+  NS_LOG_FUNCTION (this << swtch << xid);
+
+  if (msg->type == OFPMP_QUEUE_STATS)
+    {
+      // Queue statistics are requested just before port statistics. Save the
+      // total TX errors of the radio queues for the next weight update.
+      struct ofl_msg_multipart_reply_queue *reply =
+        (struct ofl_msg_multipart_reply_queue*)msg;
+      for (auto &it : m_radioPorts)
+        {
+          it.second.queueErrors = 0;
+        }
+      for (size_t i = 0; i < reply->stats_num; i++)
+        {
+          auto it = m_radioPorts.find (reply->stats [i]->port_no);
+          if (it != m_radioPorts.end ())
+            {
+              it->second.queueErrors += reply->stats [i]->tx_errors;
+            }
+        }
+    }
+  else if (msg->type == OFPMP_PORT_STATS)
+    {
+      UpdateRadioWeights ((struct ofl_msg_multipart_reply_port*)msg);
+    }
 
+  // All handlers must free the message when everything is ok
+  ofl_msg_free ((struct ofl_msg_header*)msg, 0);
   return 0;
 }
 
+void
+TrafficTypeController::RequestRadioStats (Ptr<const RemoteSwitch> swtch)
+{
+  NS_LOG_FUNCTION (this << swtch);
+
+  DpctlExecute (swtch, "stats-queue");
+  DpctlExecute (swtch, "stats-port");
+  Simulator::Schedule (m_statsInterval,
+                       &TrafficTypeController::RequestRadioStats, this, swtch);
+}
+
+void
+TrafficTypeController::UpdateRadioWeights (
+  struct ofl_msg_multipart_reply_port *reply)
+{
+  NS_LOG_FUNCTION (this);
+
+  double interval = (Simulator::Now () - m_lastStats).GetSeconds ();
+  m_lastStats = Simulator::Now ();
+
+  for (size_t i = 0; i < reply->stats_num; i++)
+    {
+      struct ofl_port_stats *stats = reply->stats [i];
+      auto it = m_radioPorts.find (stats->port_no);
+      if (it == m_radioPorts.end ())
+        {
+          continue;
+        }
+
+      RadioPort &radio = it->second;
+      uint64_t drops = stats->tx_dropped + stats->tx_errors
+        + radio.queueErrors;
+      uint64_t newBytes = stats->tx_bytes - radio.txBytes;
+      uint64_t newPackets = stats->tx_packets - radio.txPackets;
+      uint64_t newDrops = drops - radio.txDrops;
+      radio.txBytes = stats->tx_bytes;
+      radio.txPackets = stats->tx_packets;
+      radio.txDrops = drops;
+      radio.throughput = interval > 0 ? newBytes * 8 / interval : 0;
+
+      double loss = (newPackets + newDrops)
+        ? static_cast<double> (newDrops) / (newPackets + newDrops) : 0;
+      if (!radio.live)
+        {
+          radio.weight = 0;
+        }
+      else if (loss > m_lossThreshold)
+        {
+          radio.weight = std::max<uint32_t> (1, radio.weight / 2);
+        }
+      else
+        {
+          // Radios proven to deliver traffic grow faster than idle ones,
+          // which are only slowly probed.
+          radio.weight = std::min<uint32_t> (
+              100, std::max<uint32_t> (1, radio.weight) + (newPackets ? 5 : 1));
+        }
+      NS_LOG_INFO ("Radio port " << it->first << ": throughput " <<
+                   radio.throughput << " bps, loss " << loss <<
+                   ", weight " << radio.weight);
+    }
+}
+
+uint16_t
+TrafficTypeController::SelectRoute (Ipv4Address srcIp, Ipv4Address dstIp,
+                                     uint8_t ipProto, uint16_t srcPort,
+                                     uint16_t dstPort)
+{
+  NS_LOG_FUNCTION (this << srcIp << dstIp << ipProto << srcPort << dstPort);
+
+  uint32_t total = 0;
+  for (auto const &it : m_radioPorts)
+    {
+      total += it.second.live ? it.second.weight : 0;
+    }
+  if (total == 0)
+    {
+      return 1; // No radio is known to be available. Fall back to LTE.
+    }
+
+  // Hash the connection 5-tuple into the weighted space of live radios.
+  uint8_t buffer [13];
+  srcIp.Serialize (buffer);
+  dstIp.Serialize (buffer + 4);
+  buffer [8] = ipProto;
+  memcpy (buffer + 9, &srcPort, 2);
+  memcpy (buffer + 11, &dstPort, 2);
+  uint32_t point = Hash32 ((char*)buffer, sizeof (buffer)) % total;
+  for (auto const &it : m_radioPorts)
+    {
+      uint32_t weight = it.second.live ? it.second.weight : 0;
+      if (point < weight)
+        {
+          NS_LOG_INFO ("Connection hashed to radio port " << it.first);
+          return it.second.group;
+        }
+      point -= weight;
+    }
+  NS_ABORT_MSG ("Weighted route selection failed.");
+  return 1;
+}
+
+bool
+TrafficTypeController::IsRadioLive (uint32_t portNo) const
+{
+  auto it = m_radioPorts.find (portNo);
+  return it == m_radioPorts.end () || it->second.live;
+}
+
 Ipv4Address
 TrafficTypeController::ExtractIpv4Address (uint32_t oxm_of, struct ofl_match* match)
 {
@@ -23,6 +23,8 @@
 #define TRAFFIC_TYPE_CONTROLLER_H
 
 #include <ns3/ofswitch13-module.h>
+#include <memory>
+#include <tuple>
 
 using namespace ns3;
 
@@ -56,6 +58,42 @@ public:
     struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
     uint32_t xid);
 
+  /**
+   * Handle a port status message sent by the switch to this controller. When
+   * port failover is enabled, a change in the liveness of a radio port moves
+   * all connections on this radio to the other one (and back), with a single
+   * precomputed group-mod message.
+   * \note Inherited from OFSwitch13Controller.
+   * \param msg The OpenFlow received message.
+   * \param swtch The remote switch metadata.
+   * \param xid The transaction id from the request message.
+   * \return 0 if everything's ok, otherwise an error number.
+   */
+  ofl_err HandlePortStatus (
+    struct ofl_msg_port_status *msg, Ptr<const RemoteSwitch> swtch,
+    uint32_t xid);
+
+  /**
+   * Handle a multipart reply message sent by the switch to this controller.
+   * Port and queue statistics from the car switch are used to update the
+   * link aggregation weights.
+   * \note Inherited from OFSwitch13Controller.
+   * \param msg The OpenFlow received message.
+   * \param swtch The remote switch metadata.
+   * \param xid The transaction id from the request message.
+   * \return 0 if everything's ok, otherwise an error number.
+   */
+  ofl_err HandleMultipartReply (
+    struct ofl_msg_multipart_reply_header *msg, Ptr<const RemoteSwitch> swtch,
+    uint32_t xid);
+
+  /**
+   * TracedCallback signature for reroute latency.
+   * \param latency The time between the reroute trigger at the controller
+   *        and the first packet sent by the switch over the new port.
+   */
+  typedef void (*RerouteTracedCallback)(Time latency);
+
 protected:
   // Inherited from OFSwitch13Controller
   void HandshakeSuccessful (Ptr<const RemoteSwitch> swtch);
@@ -89,9 +127,107 @@ private:
     struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
     uint32_t xid);
 
+  /**
+   * Request port and queue statistics from the car switch, periodically
+   * rescheduling itself while link aggregation is enabled.
+   * \param swtch The switch information.
+   */
+  void RequestRadioStats (Ptr<const RemoteSwitch> swtch);
+
+  /**
+   * Update the link aggregation weights with the port statistics gathered
+   * since the last update and the latest queue statistics. Weights follow an
+   * additive increase, multiplicative decrease rule: they grow while the
+   * radio delivers traffic without loss and are halved when the loss ratio
+   * exceeds the LossThreshold attribute.
+   * \param reply The port statistics reply.
+   */
+  void UpdateRadioWeights (struct ofl_msg_multipart_reply_port *reply);
+
+  /**
+   * Select the route for a new connection, hashing the connection 5-tuple
+   * over the weights of the available radio interfaces. As the route is fixed
+   * by the connection flow entry, all packets of a connection follow the same
+   * interface and TCP segments are kept in order.
+   * \param srcIp Source IP address.
+   * \param dstIp Destination IP address.
+   * \param ipProto IP protocol number.
+   * \param srcPort Source transport port.
+   * \param dstPort Destination transport port.
+   * \return The route (group) number.
+   */
+  uint16_t SelectRoute (Ipv4Address srcIp, Ipv4Address dstIp, uint8_t ipProto,
+                        uint16_t srcPort, uint16_t dstPort);
+
+  /**
+   * \param portNo The switch port number.
+   * \return False if the switch reported this radio port down.
+   */
+  bool IsRadioLive (uint32_t portNo) const;
+
+  /**
+   * Move the active UDP connections to another interface, using the
+   * flow-mod messages precomputed for each connection in the flow table
+   * shadow.
+   * \param swtch The switch information.
+   * \param xid Transaction id.
+   * \param altRouteNumber The group for the new interface (1 for LTE and 2
+   *        for mmWave).
+   * \return 0 if everything's ok, otherwise an error number.
+   */
   ofl_err SwitchInterface (Ptr<const RemoteSwitch> swtch,
     uint32_t xid, uint16_t altRouteNumber);
 
+  /**
+   * Save a route group into the switch shadow, precomputing the group-mod
+   * messages that swap its bucket between the primary and backup ports.
+   * \param swtch The switch information.
+   * \param groupId The route group ID.
+   * \param primaryPort The output port of the group.
+   * \param backupPort The output port used while the primary port is down.
+   */
+  void AddShadowGroup (Ptr<const RemoteSwitch> swtch, uint32_t groupId,
+                       uint32_t primaryPort, uint32_t backupPort);
+
+  /**
+   * Save a connection flow entry into the switch shadow, precomputing the
+   * flow-mod messages that move the connection to each other route group.
+   * \param swtch The switch information.
+   * \param srcIp Source IP address.
+   * \param dstIp Destination IP address.
+   * \param srcPort Source UDP port.
+   * \param dstPort Destination UDP port.
+   * \param groupId The current route group of the connection.
+   */
+  void AddShadowFlow (Ptr<const RemoteSwitch> swtch, Ipv4Address srcIp,
+                      Ipv4Address dstIp, uint16_t srcPort, uint16_t dstPort,
+                      uint32_t groupId);
+
+  /**
+   * Swap the bucket of the route groups forwarding to a radio port whose
+   * liveness has changed, moving all their connections at once.
+   * \param swtch The switch information.
+   * \param portNo The radio port number.
+   * \param live The new port liveness.
+   */
+  void RerouteGroups (Ptr<const RemoteSwitch> swtch, uint32_t portNo,
+                      bool live);
+
+  /**
+   * Start measuring the reroute latency, waiting for the first packet sent
+   * over the new output port.
+   * \param swtch The switch information.
+   * \param portNo The new output port number.
+   */
+  void StartRerouteMeasure (Ptr<const RemoteSwitch> swtch, uint32_t portNo);
+
+  /**
+   * Notify the first packet sent over the new output port after a reroute.
+   * Connected to the switch port SwitchPortTx trace source.
+   * \param packet The packet.
+   */
+  void NotifyReroutedPacket (Ptr<const Packet> packet);
+
   /**
    * Handle TCP connection request
    * \param msg The packet-in message.
@@ -141,10 +277,79 @@ private:
   Address   m_serverMacAddress;   //!< Border switch MAC address
   bool      m_meterEnable;        //!< Enable per-flow mettering
   DataRate  m_meterRate;          //!< Per-flow meter rate
+  bool      m_portFailover;       //!< Fail over on mmWave port status
+  uint32_t  m_mmWavePort;         //!< Switch port of the mmWave interface
+  bool      m_linkAggregation;    //!< Spread connections over radios
+  Time      m_statsInterval;      //!< Radio statistics polling interval
+  double    m_lossThreshold;      //!< Loss ratio to reduce a radio weight
 
   /** Map saving <IPv4 address / MAC address> */
   typedef std::map<Ipv4Address, Mac48Address> IpMacMap_t;
   IpMacMap_t m_arpTable;          //!< ARP resolution table.
+
+  /** Link aggregation metadata for a radio interface of the car switch. */
+  struct RadioPort
+  {
+    uint16_t  group;              //!< Group forwarding to this port.
+    bool      live;               //!< Last reported liveness.
+    uint32_t  weight;             //!< Link aggregation weight.
+    double    throughput;         //!< Last measured TX throughput (bps).
+    uint64_t  txBytes;            //!< TX bytes at last update.
+    uint64_t  txPackets;          //!< TX packets at last update.
+    uint64_t  txDrops;            //!< TX drops and errors at last update.
+    uint64_t  queueErrors;        //!< Queue TX errors from last reply.
+  };
+
+  /** Map saving <switch port number / radio port metadata> */
+  typedef std::map<uint32_t, RadioPort> RadioPortMap_t;
+  RadioPortMap_t m_radioPorts;    //!< Radio interfaces of the car switch.
+  Time           m_lastStats;     //!< Time of the last weight update.
+
+  /** Shadow of a route group, with the precomputed bucket swap messages. */
+  struct ShadowGroup
+  {
+    uint32_t  port;               //!< Current output port.
+    uint32_t  primaryPort;        //!< Output port when live.
+    uint32_t  backupPort;         //!< Output port while primary is down.
+    std::unique_ptr<ofs::GroupMod> toBackup;  //!< Swap to backup port.
+    std::unique_ptr<ofs::GroupMod> toPrimary; //!< Swap to primary port.
+  };
+
+  /** Map saving <route group ID / group shadow> */
+  typedef std::map<uint32_t, ShadowGroup> ShadowGroupMap_t;
+
+  /** Map saving <route group ID / flow-mod moving a connection to it> */
+  typedef std::map<uint32_t, std::unique_ptr<ofs::FlowMod> > FlowModMap_t;
+
+  /** Shadow of a connection flow entry, with the precomputed moves. */
+  struct ShadowFlow
+  {
+    uint32_t      group;          //!< Current route group.
+    FlowModMap_t  moves;          //!< Flow-mods to move to other groups.
+  };
+
+  /** Connection key <source IP, destination IP, source and dest. port> */
+  typedef std::tuple<Ipv4Address, Ipv4Address, uint16_t, uint16_t> FlowKey_t;
+
+  /** Map saving <connection key / flow shadow> */
+  typedef std::map<FlowKey_t, ShadowFlow> ShadowFlowMap_t;
+
+  /** Shadow of the flow and group tables installed by this controller. */
+  struct SwitchShadow
+  {
+    ShadowGroupMap_t groups;      //!< Route groups.
+    ShadowFlowMap_t  flows;       //!< Connection flow entries.
+  };
+
+  /** Map saving <datapath ID / switch shadow> */
+  typedef std::map<uint64_t, SwitchShadow> SwitchShadowMap_t;
+  SwitchShadowMap_t m_shadows;    //!< Switch table shadows.
+
+  Ptr<OFSwitch13Port> m_reroutePort;  //!< Port waiting for rerouted traffic.
+  Time              m_rerouteTime;    //!< Time of the last reroute trigger.
+
+  /** Trace source fired with the latency of each reroute. */
+  TracedCallback<Time> m_rerouteTrace;
 };
 
 #endif /* TRAFFIC_TYPE_CONTROLLER_H */
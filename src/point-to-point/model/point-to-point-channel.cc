@@ -19,6 +19,9 @@
 #include "point-to-point-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
@@ -40,6 +43,16 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("DeepCopy",
+                   "Whether the two devices are run by different threads, "
+                   "such as partitions of the multithreaded simulator, "
+                   "and hence must not share packets or be referenced by "
+                   "the sending thread.  The TxRxPointToPoint trace "
+                   "source cannot be connected then.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::SetDeepCopy,
+                                        &PointToPointChannel::GetDeepCopy),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,7 +70,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_deepCopy (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,6 +94,7 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      UpdateDestinationNodes ();
     }
 }
 
@@ -97,6 +112,18 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  if (m_deepCopy)
+    {
+      // The destination is run by another thread: hand it a packet of
+      // its own, and leave the reference counts of its objects alone.
+      NS_ABORT_MSG_UNLESS (m_txrxPointToPoint.IsEmpty (),
+                           "TxRxPointToPoint traced on a channel with DeepCopy");
+      Simulator::ScheduleWithContext (m_link[wire].m_dstNode,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), p->DeepCopy ());
+      return true;
+    }
+
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p->Copy ());
@@ -106,6 +133,35 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+void
+PointToPointChannel::SetDeepCopy (bool deepCopy)
+{
+  NS_LOG_FUNCTION (this << deepCopy);
+  m_deepCopy = deepCopy;
+  UpdateDestinationNodes ();
+}
+
+bool
+PointToPointChannel::GetDeepCopy (void) const
+{
+  return m_deepCopy;
+}
+
+void
+PointToPointChannel::UpdateDestinationNodes (void)
+{
+  if (!m_deepCopy || m_nDevices != N_DEVICES)
+    {
+      return;
+    }
+  for (std::size_t i = 0; i < N_DEVICES; ++i)
+    {
+      Ptr<Node> node = m_link[i].m_dst->GetNode ();
+      NS_ABORT_MSG_IF (node == 0, "DeepCopy needs the devices to be added to their nodes first");
+      m_link[i].m_dstNode = node->GetId ();
+    }
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -146,11 +146,30 @@ protected:
      Time duration, Time lastBitTime);
                     
 private:
+  /**
+   * Set whether the devices are run by different threads.
+   *
+   * \param [in] deepCopy If true, each device receives deep copies of the
+   *        packets sent by the other one, and the channel does not
+   *        touch the other device's objects while transmitting.
+   */
+  void SetDeepCopy (bool deepCopy);
+  /**
+   * \returns Whether the devices are run by different threads.
+   */
+  bool GetDeepCopy (void) const;
+  /**
+   * With m_deepCopy, record the node ids of the destinations once both
+   * devices are attached.
+   */
+  void UpdateDestinationNodes (void);
+
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
   Time          m_delay;    //!< Propagation delay
   std::size_t        m_nDevices; //!< Devices of this channel
+  bool          m_deepCopy; //!< The devices are run by different threads
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -194,11 +213,12 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNode (0) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    uint32_t                   m_dstNode; //!< Node id of m_dst, with m_deepCopy
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
@@ -82,6 +82,23 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_next != 0)
+    {
+      // the loss of the next models can't be bounded from this model only
+      return -1;
+    }
+  return DoGetMaxRange (txPowerDbm, rxPowerDbm);
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return -1;
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -277,6 +294,18 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  if (m_minLoss > maxLossDb)
+    {
+      return 0;
+    }
+  // distance at which the loss of DoCalcRxPower is maxLossDb
+  return m_lambda / (4 * M_PI) * std::pow (10.0, (maxLossDb - 10 * std::log10 (m_systemLoss)) / 20);
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -451,6 +480,21 @@ TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+TwoRayGroundPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  // Beyond the crossover distance, the two-ray loss is higher than the
+  // Friis loss, so the Friis range bounds both (with antennae above z = 0).
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  double range = m_lambda / (4 * M_PI) * std::pow (10.0, (maxLossDb - 10 * std::log10 (m_systemLoss)) / 20);
+  if (txPowerDbm >= rxPowerDbm)
+    {
+      // there is no loss up to the minimum distance
+      range = std::max (range, m_minDistance);
+    }
+  return range;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel);
@@ -540,6 +584,21 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  if (m_referenceLoss > maxLossDb)
+    {
+      return 0;
+    }
+  if (m_exponent <= 0)
+    {
+      return -1;
+    }
+  return m_referenceDistance * std::pow (10.0, (maxLossDb - m_referenceLoss) / (10 * m_exponent));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -642,6 +701,38 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_referenceLoss < 0 || m_exponent0 <= 0 || m_exponent1 <= 0 || m_exponent2 <= 0
+      || m_distance0 > m_distance1 || m_distance1 > m_distance2)
+    {
+      // the loss does not increase with the distance
+      return -1;
+    }
+  double maxLossDb = txPowerDbm - rxPowerDbm;
+  if (maxLossDb < 0)
+    {
+      return 0;
+    }
+  if (maxLossDb < m_referenceLoss)
+    {
+      return m_distance0;
+    }
+  // invert the loss of the field in which it reaches maxLossDb
+  double loss1 = m_referenceLoss + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  if (maxLossDb < loss1)
+    {
+      return m_distance0 * std::pow (10.0, (maxLossDb - m_referenceLoss) / (10 * m_exponent0));
+    }
+  double loss2 = loss1 + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  if (maxLossDb < loss2)
+    {
+      return m_distance1 * std::pow (10.0, (maxLossDb - loss1) / (10 * m_exponent1));
+    }
+  return m_distance2 * std::pow (10.0, (maxLossDb - loss2) / (10 * m_exponent2));
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -804,6 +895,12 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FixedRssLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return m_rss < rxPowerDbm ? 0 : -1;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel);
@@ -930,6 +1027,16 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (txPowerDbm < rxPowerDbm)
+    {
+      return 0;
+    }
+  return rxPowerDbm > -1000 ? m_range : -1;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
@@ -93,6 +93,22 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * \brief Get a distance beyond which the reception power is always
+   * below a given power.
+   *
+   * The bound lets channels skip the receivers which can't receive a
+   * signal without computing the loss to each of them. It is
+   * conservative: a model which can't bound its loss (e.g., with random
+   * fading), and any chain of loss models, returns no bound.
+   *
+   * \param txPowerDbm the transmission power (in dBm)
+   * \param rxPowerDbm the reception power (in dBm)
+   * \returns a distance (in m) beyond which CalcRxPower returns less than
+   * rxPowerDbm, or a negative value if there is no such distance
+   */
+  double GetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -140,6 +156,17 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns the distance beyond which the reception power of this
+   * particular PropagationLossModel is below rxPowerDbm.
+   * The default implementation returns no bound.
+   *
+   * \param txPowerDbm the transmission power (in dBm)
+   * \param rxPowerDbm the reception power (in dBm)
+   * \returns the distance (in m), or a negative value if there is none
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +349,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +470,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +559,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +643,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -747,6 +778,7 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
   double m_rss; //!< the received signal strength
 };
 
@@ -852,6 +884,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
@@ -436,6 +436,102 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+// Check that the receive power is below a given power beyond the distance
+// returned by PropagationLossModel::GetMaxRange
+class MaxRangePropagationLossModelTestCase : public TestCase
+{
+public:
+  MaxRangePropagationLossModelTestCase ();
+  virtual ~MaxRangePropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the range of a loss model over a set of distances
+   * \param name the loss model name
+   * \param lossModel the loss model
+   * \param txPowerDbm the transmission power
+   * \param rxPowerDbm the reception power
+   * \param exact whether the receive power reaches rxPowerDbm at the range
+   */
+  void Check (std::string name, Ptr<PropagationLossModel> lossModel,
+              double txPowerDbm, double rxPowerDbm, bool exact);
+};
+
+MaxRangePropagationLossModelTestCase::MaxRangePropagationLossModelTestCase ()
+  : TestCase ("Test PropagationLossModel::GetMaxRange")
+{
+}
+
+MaxRangePropagationLossModelTestCase::~MaxRangePropagationLossModelTestCase ()
+{
+}
+
+void
+MaxRangePropagationLossModelTestCase::Check (std::string name, Ptr<PropagationLossModel> lossModel,
+                                             double txPowerDbm, double rxPowerDbm, bool exact)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  double range = lossModel->GetMaxRange (txPowerDbm, rxPowerDbm);
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (range, 0, name << ": no range for " << txPowerDbm << " dBm to " << rxPowerDbm << " dBm");
+  for (double distance = 0.01; distance < 100000; distance *= 1.05)
+    {
+      if (distance > range * 1.000001)
+        {
+          b->SetPosition (Vector (distance, 0, 0));
+          NS_TEST_EXPECT_MSG_LT (lossModel->CalcRxPower (txPowerDbm, a, b), rxPowerDbm,
+                                 name << ": receive power above " << rxPowerDbm << " dBm at " << distance
+                                      << " m, beyond the range " << range << " m");
+        }
+    }
+  if (exact && range > 0.01)
+    {
+      b->SetPosition (Vector (range * 0.9999, 0, 0));
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (lossModel->CalcRxPower (txPowerDbm, a, b), rxPowerDbm,
+                                   name << ": range " << range << " m is not tight");
+    }
+}
+
+void
+MaxRangePropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  Check ("Friis", friis, 16, -96, true);
+  Check ("Friis", friis, 16, 20, true);
+  friis->SetMinLoss (40);
+  Check ("Friis with minimum loss", friis, 16, -96, true);
+  Check ("Friis with minimum loss", friis, 16, -30, true);
+
+  Ptr<TwoRayGroundPropagationLossModel> twoRay = CreateObject<TwoRayGroundPropagationLossModel> ();
+  twoRay->SetHeightAboveZ (1.5);
+  Check ("TwoRayGround", twoRay, 16, -96, false);
+  Check ("TwoRayGround", twoRay, 16, -10, false);
+  Check ("TwoRayGround", twoRay, 16, 20, false);
+
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Check ("LogDistance", logDistance, 16, -96, true);
+  Check ("LogDistance", logDistance, 16, -40, true);
+
+  Ptr<ThreeLogDistancePropagationLossModel> threeLog = CreateObject<ThreeLogDistancePropagationLossModel> ();
+  Check ("ThreeLogDistance", threeLog, 16, -96, true);
+  Check ("ThreeLogDistance", threeLog, 16, -60, true);
+  Check ("ThreeLogDistance", threeLog, 16, -30, true);
+  Check ("ThreeLogDistance", threeLog, 16, 10, true);
+
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  Check ("Range", range, 16, -96, true);
+
+  // models which can't bound their loss, and chains, have no range
+  Ptr<NakagamiPropagationLossModel> nakagami = CreateObject<NakagamiPropagationLossModel> ();
+  NS_TEST_EXPECT_MSG_LT (nakagami->GetMaxRange (16, -96), 0, "Nakagami has no range");
+  logDistance->SetNext (nakagami);
+  NS_TEST_EXPECT_MSG_LT (logDistance->GetMaxRange (16, -96), 0, "chains have no range");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +546,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MaxRangePropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
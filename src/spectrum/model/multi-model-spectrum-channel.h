@@ -128,6 +128,25 @@ public:
 protected:
   void DoDispose ();
 
+  /**
+   * Deliver a signal to a receiver after the propagation delay.  The
+   * default implementation schedules StartRx () in the context of the
+   * receiver's node.
+   *
+   * \param params The signal parameters, as seen by the receiver.
+   * \param receiver A pointer to the receiver SpectrumPhy.
+   * \param delay The propagation delay.
+   */
+  virtual void ScheduleRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver, Time delay);
+
+  /**
+   * Used internally to reschedule transmission after the propagation delay.
+   *
+   * \param params The signal parameters.
+   * \param receiver A pointer to the receiver SpectrumPhy.
+   */
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
 private:
   /**
    * This method checks if m_rxSpectrumModelInfoMap contains an entry
@@ -141,14 +160,6 @@ private:
    */
   TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
 
-  /**
-   * Used internally to reschedule transmission after the propagation delay.
-   *
-   * \param params The signal parameters.
-   * \param receiver A pointer to the receiver SpectrumPhy.
-   */
-  virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
-
   /**
    * Data structure holding, for each TX SpectrumModel,  all the
    * converters to any RX SpectrumModel, and all the corresponding
@@ -0,0 +1,406 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/simulator.h>
+#include <ns3/simulator-impl.h>
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
+#include <ns3/node-list.h>
+#include <ns3/mobility-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/antenna-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/mpi-interface.h>
+#include <ns3/mpi-receiver.h>
+#include <cstring>
+#include "multi-model-spectrum-remote-channel.h"
+
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultiModelSpectrumRemoteChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (MultiModelSpectrumRemoteChannel);
+NS_OBJECT_ENSURE_REGISTERED (MultiModelSpectrumRemoteHeader);
+
+/**
+ * \ingroup spectrum
+ * The remote channels of this rank, indexed by channel id.
+ */
+static std::map<uint32_t, MultiModelSpectrumRemoteChannel *> g_remoteChannels;
+
+
+MultiModelSpectrumRemoteChannel::MultiModelSpectrumRemoteChannel ()
+  : m_slotDuration (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+  g_remoteChannels[GetId ()] = this;
+}
+
+MultiModelSpectrumRemoteChannel::~MultiModelSpectrumRemoteChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultiModelSpectrumRemoteChannel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  g_remoteChannels.erase (GetId ());
+  m_phys.clear ();
+  MultiModelSpectrumChannel::DoDispose ();
+}
+
+TypeId
+MultiModelSpectrumRemoteChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultiModelSpectrumRemoteChannel")
+    .SetParent<MultiModelSpectrumChannel> ()
+    .SetGroupName ("Spectrum")
+    .AddConstructor<MultiModelSpectrumRemoteChannel> ()
+    .AddAttribute ("SlotDuration",
+                   "The duration of a slot of the technology using the "
+                   "channel.  Signals sent to other ranks are delivered "
+                   "this long after their propagation delay, which widens "
+                   "the time windows of the distributed simulator.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultiModelSpectrumRemoteChannel::m_slotDuration),
+                   MakeTimeChecker ())
+    .AddAttribute ("LookAhead",
+                   "The smallest propagation delay between a SpectrumPhy "
+                   "of this rank and a SpectrumPhy of another rank, plus "
+                   "the SlotDuration.",
+                   TypeId::ATTR_GET, // read-only attribute
+                   TimeValue (Seconds (0)), // unused, read-only attribute
+                   MakeTimeAccessor (&MultiModelSpectrumRemoteChannel::GetLookAhead),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+bool
+MultiModelSpectrumRemoteChannel::IsLocal (Ptr<const SpectrumPhy> phy)
+{
+  Ptr<NetDevice> device = phy->GetDevice ();
+  if (device == 0 || device->GetNode () == 0)
+    {
+      return true;
+    }
+  return device->GetNode ()->GetSystemId () == MpiInterface::GetSystemId ();
+}
+
+void
+MultiModelSpectrumRemoteChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  MultiModelSpectrumChannel::AddRx (phy);
+
+  Ptr<NetDevice> device = phy->GetDevice ();
+  if (device == 0)
+    {
+      // cannot be addressed from another rank, hence always local
+      return;
+    }
+  m_phys[device] = phy;
+
+  // A single MpiReceiver per device serves all the remote channels the
+  // device is attached to: the summaries carry the channel id.
+  Ptr<MpiReceiver> mpiRec = device->GetObject<MpiReceiver> ();
+  if (mpiRec == 0)
+    {
+      mpiRec = CreateObject<MpiReceiver> ();
+      mpiRec->SetReceiveCallback (MakeBoundCallback (&MultiModelSpectrumRemoteChannel::ReceiveRemote, device));
+      device->AggregateObject (mpiRec);
+    }
+}
+
+void
+MultiModelSpectrumRemoteChannel::StartTx (Ptr<SpectrumSignalParameters> params)
+{
+  NS_LOG_FUNCTION (this << params);
+  if (!IsLocal (params->txPhy))
+    {
+      // the copy of a SpectrumPhy of another rank: the owner forwards
+      // its transmissions to us
+      NS_LOG_LOGIC ("ignoring transmission of remote phy " << params->txPhy);
+      return;
+    }
+  MultiModelSpectrumChannel::StartTx (params);
+}
+
+void
+MultiModelSpectrumRemoteChannel::ScheduleRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver, Time delay)
+{
+  if (IsLocal (receiver))
+    {
+      MultiModelSpectrumChannel::ScheduleRx (params, receiver, delay);
+      return;
+    }
+
+#ifdef NS3_MPI
+  static bool checked = false;
+  if (!checked)
+    {
+      checked = true;
+      NS_ABORT_MSG_IF (Simulator::GetImplementation ()->GetInstanceTypeId ().GetName () == "ns3::NullMessageSimulatorImpl",
+                       "MultiModelSpectrumRemoteChannel requires ns3::DistributedSimulatorImpl");
+    }
+
+  Ptr<NetDevice> txDevice = params->txPhy->GetDevice ();
+  Ptr<NetDevice> rxDevice = receiver->GetDevice ();
+  MultiModelSpectrumRemoteHeader header;
+  header.SetSignal (GetId (), txDevice->GetNode ()->GetId (), txDevice->GetIfIndex (),
+                    params->duration, params->psd);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  NS_LOG_LOGIC ("forwarding to node " << rxDevice->GetNode ()->GetId ()
+                << " on rank " << rxDevice->GetNode ()->GetSystemId ());
+  MpiInterface::SendPacket (p, Simulator::Now () + delay + m_slotDuration,
+                            rxDevice->GetNode ()->GetId (), rxDevice->GetIfIndex ());
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+void
+MultiModelSpectrumRemoteChannel::ReceiveRemote (Ptr<NetDevice> device, Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (device << p);
+  MultiModelSpectrumRemoteHeader header;
+  p->RemoveHeader (header);
+  std::map<uint32_t, MultiModelSpectrumRemoteChannel *>::const_iterator it =
+    g_remoteChannels.find (header.GetChannelId ());
+  NS_ASSERT_MSG (it != g_remoteChannels.end (),
+                 "No remote channel with id " << header.GetChannelId () << " on this rank");
+  MultiModelSpectrumRemoteChannel *channel = it->second;
+
+  std::map<Ptr<NetDevice>, Ptr<SpectrumPhy> >::const_iterator phy = channel->m_phys.find (device);
+  NS_ASSERT (phy != channel->m_phys.end ());
+  channel->DoReceiveRemote (device, header.GetTxNode (), header.GetTxIfIndex (),
+                            header.GetDuration (), header.GetPsd (phy->second->GetRxSpectrumModel ()));
+}
+
+void
+MultiModelSpectrumRemoteChannel::DoReceiveRemote (Ptr<NetDevice> device, uint32_t txNode, uint32_t txIfIndex,
+                                                  Time duration, Ptr<SpectrumValue> psd)
+{
+  NS_LOG_FUNCTION (this << device << txNode << txIfIndex << duration);
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->psd = psd;
+  params->duration = duration;
+  // the antenna gains were already applied by the transmitting rank
+  params->txAntenna = 0;
+
+  Ptr<Node> node = NodeList::GetNode (txNode);
+  for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+    {
+      if (node->GetDevice (i)->GetIfIndex () == txIfIndex)
+        {
+          std::map<Ptr<NetDevice>, Ptr<SpectrumPhy> >::const_iterator it = m_phys.find (node->GetDevice (i));
+          if (it != m_phys.end ())
+            {
+              params->txPhy = it->second;
+            }
+          break;
+        }
+    }
+  NS_ASSERT_MSG (params->txPhy != 0, "Transmitter " << txNode << ":" << txIfIndex << " unknown on this rank");
+
+  StartRx (params, m_phys[device]);
+}
+
+Time
+MultiModelSpectrumRemoteChannel::GetLookAhead (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Time lookAhead = Simulator::GetMaximumSimulationTime ();
+  bool remotes = false;
+  for (std::map<Ptr<NetDevice>, Ptr<SpectrumPhy> >::const_iterator local = m_phys.begin ();
+       local != m_phys.end (); ++local)
+    {
+      if (!IsLocal (local->second))
+        {
+          continue;
+        }
+      Ptr<MobilityModel> localMobility = local->second->GetMobility ();
+      for (std::map<Ptr<NetDevice>, Ptr<SpectrumPhy> >::const_iterator remote = m_phys.begin ();
+           remote != m_phys.end (); ++remote)
+        {
+          if (IsLocal (remote->second))
+            {
+              continue;
+            }
+          Ptr<MobilityModel> remoteMobility = remote->second->GetMobility ();
+          NS_ABORT_MSG_IF (m_propagationDelay == 0,
+                           "MultiModelSpectrumRemoteChannel spanning several ranks "
+                           "requires a PropagationDelayModel");
+          NS_ABORT_MSG_IF (localMobility == 0 || remoteMobility == 0,
+                           "MultiModelSpectrumRemoteChannel spanning several ranks "
+                           "requires a MobilityModel for each SpectrumPhy");
+          lookAhead = std::min (lookAhead, m_propagationDelay->GetDelay (localMobility, remoteMobility));
+          remotes = true;
+        }
+    }
+  if (!remotes)
+    {
+      return lookAhead;
+    }
+  return lookAhead + m_slotDuration;
+}
+
+
+MultiModelSpectrumRemoteHeader::MultiModelSpectrumRemoteHeader ()
+  : m_channelId (0),
+    m_txNode (0),
+    m_txIfIndex (0),
+    m_duration (0),
+    m_numBands (0)
+{
+}
+
+TypeId
+MultiModelSpectrumRemoteHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultiModelSpectrumRemoteHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Spectrum")
+    .AddConstructor<MultiModelSpectrumRemoteHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+MultiModelSpectrumRemoteHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+MultiModelSpectrumRemoteHeader::GetSerializedSize (void) const
+{
+  return 4 + 4 + 4 + 8 + 4 + 4 + m_bands.size () * (4 + 8);
+}
+
+void
+MultiModelSpectrumRemoteHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_channelId);
+  start.WriteHtonU32 (m_txNode);
+  start.WriteHtonU32 (m_txIfIndex);
+  start.WriteHtonU64 (m_duration);
+  start.WriteHtonU32 (m_numBands);
+  start.WriteHtonU32 (m_bands.size ());
+  for (std::vector<std::pair<uint32_t, double> >::const_iterator it = m_bands.begin ();
+       it != m_bands.end (); ++it)
+    {
+      uint64_t value;
+      std::memcpy (&value, &it->second, sizeof (value));
+      start.WriteHtonU32 (it->first);
+      start.WriteHtonU64 (value);
+    }
+}
+
+uint32_t
+MultiModelSpectrumRemoteHeader::Deserialize (Buffer::Iterator start)
+{
+  m_channelId = start.ReadNtohU32 ();
+  m_txNode = start.ReadNtohU32 ();
+  m_txIfIndex = start.ReadNtohU32 ();
+  m_duration = start.ReadNtohU64 ();
+  m_numBands = start.ReadNtohU32 ();
+  uint32_t n = start.ReadNtohU32 ();
+  m_bands.resize (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_bands[i].first = start.ReadNtohU32 ();
+      uint64_t value = start.ReadNtohU64 ();
+      std::memcpy (&m_bands[i].second, &value, sizeof (value));
+    }
+  return GetSerializedSize ();
+}
+
+void
+MultiModelSpectrumRemoteHeader::Print (std::ostream &os) const
+{
+  os << "channel=" << m_channelId
+     << " tx=" << m_txNode << ":" << m_txIfIndex
+     << " duration=" << m_duration
+     << " bands=" << m_bands.size () << "/" << m_numBands;
+}
+
+void
+MultiModelSpectrumRemoteHeader::SetSignal (uint32_t channelId, uint32_t txNode, uint32_t txIfIndex,
+                                           Time duration, Ptr<const SpectrumValue> psd)
+{
+  m_channelId = channelId;
+  m_txNode = txNode;
+  m_txIfIndex = txIfIndex;
+  m_duration = duration.GetTimeStep ();
+  m_numBands = psd->GetSpectrumModel ()->GetNumBands ();
+  m_bands.clear ();
+  // Only the allocated bands are sent: a transmission rarely spans the
+  // whole band.
+  uint32_t index = 0;
+  for (Values::const_iterator it = psd->ConstValuesBegin (); it != psd->ConstValuesEnd (); ++it, ++index)
+    {
+      if (*it != 0)
+        {
+          m_bands.push_back (std::make_pair (index, *it));
+        }
+    }
+}
+
+uint32_t
+MultiModelSpectrumRemoteHeader::GetChannelId (void) const
+{
+  return m_channelId;
+}
+
+uint32_t
+MultiModelSpectrumRemoteHeader::GetTxNode (void) const
+{
+  return m_txNode;
+}
+
+uint32_t
+MultiModelSpectrumRemoteHeader::GetTxIfIndex (void) const
+{
+  return m_txIfIndex;
+}
+
+Time
+MultiModelSpectrumRemoteHeader::GetDuration (void) const
+{
+  return TimeStep (m_duration);
+}
+
+Ptr<SpectrumValue>
+MultiModelSpectrumRemoteHeader::GetPsd (Ptr<const SpectrumModel> model) const
+{
+  NS_ASSERT_MSG (model->GetNumBands () == m_numBands,
+                 "Spectrum model mismatch between ranks");
+  Ptr<SpectrumValue> psd = Create<SpectrumValue> (model);
+  for (std::vector<std::pair<uint32_t, double> >::const_iterator it = m_bands.begin ();
+       it != m_bands.end (); ++it)
+    {
+      (*psd)[it->first] = it->second;
+    }
+  return psd;
+}
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTI_MODEL_SPECTRUM_REMOTE_CHANNEL_H
+#define MULTI_MODEL_SPECTRUM_REMOTE_CHANNEL_H
+
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/header.h>
+#include <ns3/packet.h>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class NetDevice;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief A MultiModelSpectrumChannel spanning several MPI ranks.
+ *
+ * Like the point-to-point remote channel, this channel is meant to be
+ * created on every rank of a distributed simulation, with the same
+ * topology (nodes, devices, SpectrumPhy instances and mobility) built
+ * everywhere; a node only runs on the rank matching its system id.
+ *
+ * A transmission by a local SpectrumPhy is delivered as usual to the
+ * local receivers.  For each receiver owned by another rank and within
+ * range (i.e., not dropped by the MaxLossDb check), the transmitting
+ * rank computes the received PSD, including antenna gains and the
+ * spectrum propagation loss, and sends a summary of it (the bands with
+ * non-zero power, the duration and the transmitter identity) through
+ * MpiInterface to the rank owning the receiver.  There, the receiver
+ * gets a plain SpectrumSignalParameters whose txPhy is the local copy
+ * of the transmitter: technology-specific content (packets, control
+ * messages) does not cross ranks, so a remote signal is only ever
+ * interference.  A cell and the devices it serves must therefore be
+ * kept on the same rank, while inter-cell interference crosses ranks.
+ *
+ * Transmissions by the local copies of remote SpectrumPhy instances
+ * are ignored, since the owning rank already forwards them.
+ *
+ * Signals forwarded to another rank are delivered one SlotDuration
+ * after their propagation delay, and the LookAhead attribute reports
+ * the smallest propagation delay between a local and a remote
+ * SpectrumPhy plus the SlotDuration, which DistributedSimulatorImpl
+ * uses to bound its time windows.  A propagation delay model is
+ * therefore required as soon as SpectrumPhy instances of several ranks
+ * are attached.  Only the granted time window algorithm is supported:
+ * the null message algorithm only accounts for point-to-point links.
+ */
+class MultiModelSpectrumRemoteChannel : public MultiModelSpectrumChannel
+{
+public:
+  MultiModelSpectrumRemoteChannel ();
+  virtual ~MultiModelSpectrumRemoteChannel ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited from SpectrumChannel
+  virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+
+  /**
+   * \return the smallest propagation delay between a SpectrumPhy of
+   * this rank and a SpectrumPhy of another rank, plus the slot duration.
+   */
+  Time GetLookAhead (void) const;
+
+protected:
+  void DoDispose ();
+  virtual void ScheduleRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver, Time delay);
+
+private:
+  /**
+   * MpiReceiver callback of the devices attached to any remote channel.
+   *
+   * \param device The receiving device.
+   * \param p The packet holding the signal summary.
+   */
+  static void ReceiveRemote (Ptr<NetDevice> device, Ptr<Packet> p);
+
+  /**
+   * Start the reception of a signal sent by another rank.
+   *
+   * \param device The receiving device.
+   * \param txNode The node id of the transmitter.
+   * \param txIfIndex The interface index of the transmitter.
+   * \param duration The signal duration.
+   * \param psd The received PSD.
+   */
+  void DoReceiveRemote (Ptr<NetDevice> device, uint32_t txNode, uint32_t txIfIndex,
+                        Time duration, Ptr<SpectrumValue> psd);
+
+  /**
+   * \param phy A SpectrumPhy.
+   * \return true if the node of the SpectrumPhy runs on this rank.
+   */
+  static bool IsLocal (Ptr<const SpectrumPhy> phy);
+
+  /** The SpectrumPhy attached to this channel, for each device. */
+  std::map<Ptr<NetDevice>, Ptr<SpectrumPhy> > m_phys;
+  /** The additional delay of the signals sent to other ranks. */
+  Time m_slotDuration;
+};
+
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief The summary of a signal sent to another rank by a
+ * MultiModelSpectrumRemoteChannel.
+ */
+class MultiModelSpectrumRemoteHeader : public Header
+{
+public:
+  MultiModelSpectrumRemoteHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  /**
+   * Set the signal.
+   *
+   * \param channelId The id of the channel.
+   * \param txNode The node id of the transmitter.
+   * \param txIfIndex The interface index of the transmitter.
+   * \param duration The signal duration.
+   * \param psd The received PSD, of which the non-zero bands are kept.
+   */
+  void SetSignal (uint32_t channelId, uint32_t txNode, uint32_t txIfIndex,
+                  Time duration, Ptr<const SpectrumValue> psd);
+  /** \return The id of the channel. */
+  uint32_t GetChannelId (void) const;
+  /** \return The node id of the transmitter. */
+  uint32_t GetTxNode (void) const;
+  /** \return The interface index of the transmitter. */
+  uint32_t GetTxIfIndex (void) const;
+  /** \return The signal duration. */
+  Time GetDuration (void) const;
+  /**
+   * Rebuild the received PSD.
+   *
+   * \param model The spectrum model of the receiver.
+   * \return The received PSD.
+   */
+  Ptr<SpectrumValue> GetPsd (Ptr<const SpectrumModel> model) const;
+
+private:
+  uint32_t m_channelId;  //!< The channel id.
+  uint32_t m_txNode;     //!< The node id of the transmitter.
+  uint32_t m_txIfIndex;  //!< The interface index of the transmitter.
+  int64_t m_duration;    //!< The signal duration, in time steps.
+  uint32_t m_numBands;   //!< The number of bands of the PSD.
+  /** The non-zero bands of the PSD, as (band index, value) pairs. */
+  std::vector<std::pair<uint32_t, double> > m_bands;
+};
+
+}
+
+#endif /* MULTI_MODEL_SPECTRUM_REMOTE_CHANNEL_H */
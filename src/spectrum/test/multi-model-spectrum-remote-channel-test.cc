@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/node.h>
+#include <ns3/node-container.h>
+#include <ns3/packet.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/wifi-spectrum-value-helper.h>
+#include <ns3/adhoc-aloha-noack-ideal-phy-helper.h>
+#include <ns3/multi-model-spectrum-remote-channel.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * Check the lookahead of a MultiModelSpectrumRemoteChannel: the
+ * smallest propagation delay between a SpectrumPhy of this rank and a
+ * SpectrumPhy of another rank, plus the slot duration.
+ */
+class MultiModelSpectrumRemoteChannelLookAheadTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumRemoteChannelLookAheadTestCase ();
+  virtual ~MultiModelSpectrumRemoteChannelLookAheadTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Create a node with a SpectrumPhy attached to a channel.
+   *
+   * \param channel The channel.
+   * \param systemId The rank of the node.
+   * \param x The position of the node along the x axis, in meters.
+   */
+  void AddNode (Ptr<SpectrumChannel> channel, uint32_t systemId, double x);
+};
+
+MultiModelSpectrumRemoteChannelLookAheadTestCase::MultiModelSpectrumRemoteChannelLookAheadTestCase ()
+  : TestCase ("Check the lookahead of a MultiModelSpectrumRemoteChannel")
+{
+}
+
+MultiModelSpectrumRemoteChannelLookAheadTestCase::~MultiModelSpectrumRemoteChannelLookAheadTestCase ()
+{
+}
+
+void
+MultiModelSpectrumRemoteChannelLookAheadTestCase::AddNode (Ptr<SpectrumChannel> channel,
+                                                          uint32_t systemId, double x)
+{
+  Ptr<Node> node = CreateObject<Node> (systemId);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (Vector (x, 0, 0));
+  node->AggregateObject (mobility);
+
+  WifiSpectrumValue5MhzFactory sf;
+  AdhocAlohaNoackIdealPhyHelper deviceHelper;
+  deviceHelper.SetChannel (channel);
+  deviceHelper.SetTxPowerSpectralDensity (sf.CreateTxPowerSpectralDensity (0.1, 1));
+  deviceHelper.SetNoisePowerSpectralDensity (sf.CreateConstant (1.381e-23 * 290));
+  deviceHelper.Install (node);
+}
+
+void
+MultiModelSpectrumRemoteChannelLookAheadTestCase::DoRun (void)
+{
+  Ptr<MultiModelSpectrumRemoteChannel> channel = CreateObject<MultiModelSpectrumRemoteChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetAttribute ("SlotDuration", TimeValue (MicroSeconds (100)));
+
+  // This test runs as rank 0: with only local phys, nothing bounds the
+  // time windows.
+  AddNode (channel, 0, 0.0);
+  AddNode (channel, 0, 30.0);
+  NS_TEST_ASSERT_MSG_EQ (channel->GetLookAhead (), Simulator::GetMaximumSimulationTime (),
+                         "Lookahead bounded without any remote phy");
+
+  // The closest remote phy is 300 m away from a local one: 1 us of
+  // propagation, plus the slot.
+  AddNode (channel, 1, 330.0);
+  AddNode (channel, 1, 900.0);
+  NS_TEST_ASSERT_MSG_EQ (channel->GetLookAhead (), Seconds (300.0 / 299792458.0) + MicroSeconds (100),
+                         "Lookahead is not the smallest delay to a remote phy plus the slot");
+  TimeValue lookAhead;
+  channel->GetAttribute ("LookAhead", lookAhead);
+  NS_TEST_ASSERT_MSG_EQ (lookAhead.Get (), channel->GetLookAhead (), "Wrong LookAhead attribute");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * Check that a MultiModelSpectrumRemoteHeader carries the non-zero
+ * bands of a PSD.
+ */
+class MultiModelSpectrumRemoteHeaderTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumRemoteHeaderTestCase ();
+  virtual ~MultiModelSpectrumRemoteHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MultiModelSpectrumRemoteHeaderTestCase::MultiModelSpectrumRemoteHeaderTestCase ()
+  : TestCase ("Check the serialization of a MultiModelSpectrumRemoteHeader")
+{
+}
+
+MultiModelSpectrumRemoteHeaderTestCase::~MultiModelSpectrumRemoteHeaderTestCase ()
+{
+}
+
+void
+MultiModelSpectrumRemoteHeaderTestCase::DoRun (void)
+{
+  std::vector<double> frequencies;
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      frequencies.push_back (1e9 + i * 1e6);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (frequencies);
+  Ptr<SpectrumValue> psd = Create<SpectrumValue> (model);
+  (*psd)[2] = 1.5e-12;
+  (*psd)[7] = 3.25e-17;
+
+  MultiModelSpectrumRemoteHeader header;
+  header.SetSignal (12, 34, 5, MicroSeconds (125), psd);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 4 + 4 + 4 + 8 + 4 + 4 + 2 * (4 + 8),
+                         "Only the non-zero bands should be sent");
+
+  MultiModelSpectrumRemoteHeader received;
+  p->RemoveHeader (received);
+  NS_TEST_ASSERT_MSG_EQ (received.GetChannelId (), 12, "Wrong channel id");
+  NS_TEST_ASSERT_MSG_EQ (received.GetTxNode (), 34, "Wrong transmitter node");
+  NS_TEST_ASSERT_MSG_EQ (received.GetTxIfIndex (), 5, "Wrong transmitter interface");
+  NS_TEST_ASSERT_MSG_EQ (received.GetDuration (), MicroSeconds (125), "Wrong duration");
+  Ptr<SpectrumValue> rxPsd = received.GetPsd (model);
+  for (uint32_t i = 0; i < frequencies.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((*rxPsd)[i], (*psd)[i], "Wrong power in band " << i);
+    }
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * MultiModelSpectrumRemoteChannel TestSuite.
+ */
+class MultiModelSpectrumRemoteChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumRemoteChannelTestSuite ();
+};
+
+MultiModelSpectrumRemoteChannelTestSuite::MultiModelSpectrumRemoteChannelTestSuite ()
+  : TestSuite ("multi-model-spectrum-remote-channel", UNIT)
+{
+  AddTestCase (new MultiModelSpectrumRemoteChannelLookAheadTestCase, TestCase::QUICK);
+  AddTestCase (new MultiModelSpectrumRemoteHeaderTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static MultiModelSpectrumRemoteChannelTestSuite g_multiModelSpectrumRemoteChannelTestSuite;
@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/spectrum-helper.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/wifi-spectrum-value-helper.h"
+#include "ns3/adhoc-aloha-noack-ideal-phy-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/socket.h"
+
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * Multithreaded simulation of shared spectrum channels.
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Run two groups of nodes, each sharing a spectrum channel, joined by
+ * a point-to-point link, and check that the multithreaded simulator
+ * keeps each group in one partition and receives exactly the same
+ * packets as the default simulator.
+ */
+class MtpSpectrumTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] threads The number of partitions.
+   */
+  MtpSpectrumTestCase (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Build and run the scenario with a simulator implementation.
+   * \param [in] simulatorType The SimulatorImplementationType.
+   */
+  void RunScenario (const std::string &simulatorType);
+  /**
+   * Set up an on-off packet socket flow.
+   * \param [in] from The sending device.
+   * \param [in] to The receiving device.
+   * \param [in] protocol The protocol number.
+   * \param [in] start The start time of the flow.
+   */
+  void AddFlow (Ptr<NetDevice> from, Ptr<NetDevice> to, uint16_t protocol, Time start);
+  /**
+   * Receive the packets of a node.
+   * \param [in] socket The receiving socket.
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /** Number of nodes in each spectrum channel. */
+  static const uint32_t GROUP = 3;
+
+  uint32_t m_threads;               //!< Number of partitions.
+  std::vector<uint64_t> m_packets;  //!< Packets received per node.
+  std::vector<uint64_t> m_sum;      //!< Sum of reception times per node.
+  std::vector<uint32_t> m_partition;  //!< Partition of each node.
+  Time m_lookAhead;                 //!< Lookahead of the run.
+  bool m_deepCopy;                  //!< DeepCopy of the link after the run.
+  Time m_end;                       //!< Time at the end of Run.
+};
+
+MtpSpectrumTestCase::MtpSpectrumTestCase (uint32_t threads)
+  : TestCase ("Check two spectrum channels joined by a point-to-point link on " +
+              std::to_string (threads) + " threads"),
+    m_threads (threads),
+    m_deepCopy (false)
+{
+}
+
+void
+MtpSpectrumTestCase::Receive (Ptr<Socket> socket)
+{
+  // The packets of a node are all received in its partition.
+  uint32_t node = socket->GetNode ()->GetId ();
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_packets[node]++;
+      m_sum[node] += Simulator::Now ().GetNanoSeconds ();
+    }
+}
+
+void
+MtpSpectrumTestCase::AddFlow (Ptr<NetDevice> from, Ptr<NetDevice> to, uint16_t protocol, Time start)
+{
+  PacketSocketAddress socket;
+  socket.SetSingleDevice (from->GetIfIndex ());
+  socket.SetPhysicalAddress (to->GetAddress ());
+  socket.SetProtocol (protocol);
+
+  OnOffHelper onoff ("ns3::PacketSocketFactory", Address (socket));
+  onoff.SetConstantRate (DataRate ("0.5Mbps"));
+  onoff.SetAttribute ("PacketSize", UintegerValue (125));
+  ApplicationContainer apps = onoff.Install (from->GetNode ());
+  apps.Start (start);
+  apps.Stop (start + MilliSeconds (50));
+}
+
+void
+MtpSpectrumTestCase::RunScenario (const std::string &simulatorType)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  m_packets.assign (2 * GROUP, 0);
+  m_sum.assign (2 * GROUP, 0);
+
+  NodeContainer nodes;
+  nodes.Create (2 * GROUP);
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (nodes);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (5.0),
+                                 "GridWidth", UintegerValue (GROUP));
+  mobility.Install (nodes);
+
+  WifiSpectrumValue5MhzFactory sf;
+  AdhocAlohaNoackIdealPhyHelper deviceHelper;
+  deviceHelper.SetTxPowerSpectralDensity (sf.CreateTxPowerSpectralDensity (0.1, 1));
+  deviceHelper.SetNoisePowerSpectralDensity (sf.CreateConstant (1.381e-23 * 290));
+  deviceHelper.SetPhyAttribute ("Rate", DataRateValue (DataRate ("1Mbps")));
+  std::vector<NetDeviceContainer> groups;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      NodeContainer group;
+      for (uint32_t j = 0; j < GROUP; ++j)
+        {
+          group.Add (nodes.Get (i * GROUP + j));
+        }
+      deviceHelper.SetChannel (SpectrumChannelHelper::Default ().Create ());
+      groups.push_back (deviceHelper.Install (group));
+    }
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer link = p2p.Install (nodes.Get (0), nodes.Get (GROUP));
+
+  // Two senders towards the first node of each spectrum channel, which
+  // collide half of the time, and a flow each way over the link.
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      AddFlow (groups[i].Get (1), groups[i].Get (0), 1, MilliSeconds (100));
+      AddFlow (groups[i].Get (2), groups[i].Get (0), 1, MilliSeconds (125));
+    }
+  AddFlow (link.Get (0), link.Get (1), 0x0800, MilliSeconds (110));
+  AddFlow (link.Get (1), link.Get (0), 0x0800, MilliSeconds (115));
+
+  // The nodes only keep the receive callbacks, not the sockets.
+  std::vector<Ptr<Socket> > sinks;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (i), TypeId::LookupByName ("ns3::PacketSocketFactory"));
+      sink->Bind ();
+      sink->SetRecvCallback (MakeCallback (&MtpSpectrumTestCase::Receive, this));
+      sinks.push_back (sink);
+    }
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  m_end = Simulator::Now ();
+
+  Ptr<MultithreadedSimulatorImpl> impl =
+    DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl != 0)
+    {
+      m_partition.clear ();
+      for (uint32_t i = 0; i < nodes.GetN (); ++i)
+        {
+          m_partition.push_back (impl->GetPartition (i));
+        }
+      m_lookAhead = impl->GetLookAhead ();
+      BooleanValue deepCopy;
+      link.Get (0)->GetChannel ()->GetAttribute ("DeepCopy", deepCopy);
+      m_deepCopy = deepCopy.Get ();
+    }
+  Simulator::Destroy ();
+}
+
+void
+MtpSpectrumTestCase::DoRun (void)
+{
+  RunScenario ("ns3::DefaultSimulatorImpl");
+  std::vector<uint64_t> packets = m_packets;
+  std::vector<uint64_t> sum = m_sum;
+  Time end = m_end;
+  NS_TEST_ASSERT_MSG_GT (packets[0], 0, "No packets received in the first group");
+  NS_TEST_ASSERT_MSG_GT (packets[GROUP], 0, "No packets received in the second group");
+
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (m_threads));
+  RunScenario ("ns3::MultithreadedSimulatorImpl");
+
+  for (uint32_t i = 0; i < 2 * GROUP; ++i)
+    {
+      uint32_t first = i < GROUP ? 0 : GROUP;
+      NS_TEST_EXPECT_MSG_EQ (m_partition[i], m_partition[first],
+                             "Node " << i << " split from its spectrum channel");
+      NS_TEST_EXPECT_MSG_EQ (m_packets[i], packets[i], "Wrong number of packets received by node " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_sum[i], sum[i], "Wrong reception times in node " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_end, end, "Simulation stopped at a different time");
+  if (m_threads > 1)
+    {
+      NS_TEST_EXPECT_MSG_NE (m_partition[0], m_partition[GROUP], "Spectrum channels not split");
+      NS_TEST_EXPECT_MSG_EQ (m_lookAhead, MilliSeconds (2), "Lookahead is not the link delay");
+      NS_TEST_EXPECT_MSG_EQ (m_deepCopy, true, "Link joining two partitions without deep copies");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_deepCopy, false, "Deep copies in a single partition");
+    }
+}
+
+void
+MtpSpectrumTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (0));
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * Multithreaded simulation of shared spectrum channels TestSuite.
+ */
+class MtpSpectrumTestSuite : public TestSuite
+{
+public:
+  MtpSpectrumTestSuite ()
+    : TestSuite ("mtp-spectrum", SYSTEM)
+  {
+    AddTestCase (new MtpSpectrumTestCase (1), TestCase::QUICK);
+    AddTestCase (new MtpSpectrumTestCase (2), TestCase::QUICK);
+    AddTestCase (new MtpSpectrumTestCase (4), TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization */
+static MtpSpectrumTestSuite g_mtpSpectrumTestSuite;
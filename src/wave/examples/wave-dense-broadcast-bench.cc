@@ -0,0 +1,163 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark for dense 802.11p broadcast traffic.
+ *
+ * A platoon of vehicles drives on a multi-lane road, and every vehicle
+ * broadcasts a BSM sized packet every interval, with a random jitter. With
+ * the default transmit power most vehicles are within range of each other,
+ * so every receiver tracks many overlapping signals, which stresses the
+ * interference tracking and the channel fan-out of the PHY. The run time and
+ * the PHY receive counts are reported, e.g.:
+ *   ./waf --run "wave-dense-broadcast-bench --nodes=200 --duration=10"
+ * With --culling=1, the channel skips the vehicles out of range of each
+ * transmission (see the YansWifiChannel ReceiverCulling attribute), and the
+ * number of skipped receptions is reported.
+ */
+
+#include <chrono>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-80211p-helper.h"
+#include "ns3/wave-mac-helper.h"
+
+using namespace ns3;
+
+/// Number of broadcast packets sent
+static uint64_t g_sent = 0;
+/// Number of packets received by the PHYs
+static uint64_t g_rxOk = 0;
+/// Number of packets dropped by the PHYs
+static uint64_t g_rxDrop = 0;
+
+/// Count a received packet
+static void
+PhyRxEnd (Ptr<const Packet> packet)
+{
+  g_rxOk++;
+}
+
+/// Count a dropped packet
+static void
+PhyRxDrop (Ptr<const Packet> packet)
+{
+  g_rxDrop++;
+}
+
+/**
+ * Broadcast a packet, and schedule the next one
+ * \param device the device to send from
+ * \param size the packet size
+ * \param interval the broadcast interval
+ * \param jitter the jitter of the broadcast times
+ */
+static void
+Broadcast (Ptr<NetDevice> device, uint32_t size, Time interval, Ptr<UniformRandomVariable> jitter)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x88dc);
+  g_sent++;
+  Time next = interval + MicroSeconds (jitter->GetInteger (0, 2000)) - MicroSeconds (1000);
+  Simulator::Schedule (next, &Broadcast, device, size, interval, jitter);
+}
+
+/// Get the wall clock time in seconds since a start time
+static double
+Elapsed (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 200;
+  uint32_t lanes = 4;
+  double spacing = 10.0;
+  double duration = 10.0;
+  double txPower = 20.0;
+  uint32_t packetSize = 200;
+  double interval = 0.1;
+  bool culling = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of vehicles", nodes);
+  cmd.AddValue ("lanes", "Number of lanes", lanes);
+  cmd.AddValue ("spacing", "Distance between vehicles of a lane (m)", spacing);
+  cmd.AddValue ("duration", "Simulated time (s)", duration);
+  cmd.AddValue ("txPower", "Transmit power (dBm)", txPower);
+  cmd.AddValue ("packetSize", "Broadcast packet size (bytes)", packetSize);
+  cmd.AddValue ("interval", "Broadcast interval (s)", interval);
+  cmd.AddValue ("culling", "Skip the receivers out of range in the channel", culling);
+  cmd.Parse (argc, argv);
+
+  NodeContainer vehicles;
+  vehicles.Create (nodes);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (spacing),
+                                 "DeltaY", DoubleValue (4.0),
+                                 "GridWidth", UintegerValue ((nodes + lanes - 1) / lanes),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (vehicles);
+  for (NodeContainer::Iterator it = vehicles.Begin (); it != vehicles.End (); ++it)
+    {
+      (*it)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (25, 0, 0));
+    }
+
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> channel = wifiChannel.Create ();
+  channel->SetAttribute ("ReceiverCulling", BooleanValue (culling));
+  wifiPhy.SetChannel (channel);
+  wifiPhy.Set ("TxPowerStart", DoubleValue (txPower));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (txPower));
+  NqosWaveMacHelper wifi80211pMac = NqosWaveMacHelper::Default ();
+  Wifi80211pHelper wifi80211p = Wifi80211pHelper::Default ();
+  wifi80211p.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                      "DataMode", StringValue ("OfdmRate6MbpsBW10MHz"),
+                                      "ControlMode", StringValue ("OfdmRate6MbpsBW10MHz"));
+  NetDeviceContainer devices = wifi80211p.Install (wifiPhy, wifi80211pMac, vehicles);
+
+  Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable> ();
+  for (NetDeviceContainer::Iterator it = devices.Begin (); it != devices.End (); ++it)
+    {
+      Time start = MicroSeconds (jitter->GetInteger (0, interval * 1e6));
+      Simulator::Schedule (start, &Broadcast, *it, packetSize, Seconds (interval), jitter);
+    }
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                 MakeCallback (&PhyRxEnd));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxDrop",
+                                 MakeCallback (&PhyRxDrop));
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  double runTime = Elapsed (start);
+
+  std::cout << "nodes: " << nodes << ", duration: " << duration << " s" << std::endl
+            << "run time: " << runTime << " s, broadcasts: " << g_sent
+            << ", PHY rx ok: " << g_rxOk << ", PHY rx drop: " << g_rxDrop << std::endl
+            << "channel receptions: " << channel->GetNReceptions ()
+            << ", culled: " << channel->GetNCulledReceptions () << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
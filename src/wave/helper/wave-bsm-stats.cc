@@ -71,6 +71,23 @@ WaveBsmStats::IncExpectedRxPktCount (int index)
   m_waveTotalPktExpectedReceiveCounts[index - 1]++;
 }
 
+void
+WaveBsmStats::AddExpectedRxPktCount (int index, int count)
+{
+  m_wavePktExpectedReceiveCounts[index - 1] += count;
+  m_waveTotalPktExpectedReceiveCounts[index - 1] += count;
+}
+
+Ptr<BsmNeighborGrid>
+WaveBsmStats::GetNeighborGrid ()
+{
+  if (m_neighborGrid == 0)
+    {
+      m_neighborGrid = CreateObject<BsmNeighborGrid> ();
+    }
+  return m_neighborGrid;
+}
+
 void
 WaveBsmStats::IncRxPktCount ()
 {
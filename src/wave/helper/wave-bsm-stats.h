@@ -23,6 +23,7 @@
 #define WAVE_BSM_STATS_H
 
 #include "ns3/object.h"
+#include "ns3/bsm-neighbor-grid.h"
 #include <vector>
 
 namespace ns3 {
@@ -111,6 +112,24 @@ public:
    */
   void IncExpectedRxPktCount (int index);
 
+  /**
+   * \brief Adds to the count of (broadcast) packets expected
+   * to be received within the coverage area(index), as
+   * IncExpectedRxPktCount called count times.
+   * \param index index for statistics
+   * \param count number of expected receptions
+   * \return none
+   */
+  void AddExpectedRxPktCount (int index, int count);
+
+  /**
+   * \brief Returns the spatial grid of node positions shared by
+   * the BSM applications using these statistics, to find the nodes
+   * within the coverage areas.  The grid is created on first use.
+   * \return the neighbor grid
+   */
+  Ptr<BsmNeighborGrid> GetNeighborGrid ();
+
   /**
    * \brief Increments the count of actual packets received
    * (regardless of coverage area).
@@ -242,6 +261,7 @@ private:
   std::vector <int> m_waveTotalPktInCoverageReceiveCounts; ///< total packet in coverage receive counts
   std::vector <int> m_waveTotalPktExpectedReceiveCounts; ///< total packet expected receive counts
   int m_log; ///< log
+  Ptr<BsmNeighborGrid> m_neighborGrid; ///< shared neighbor grid
 };
 
 } // namespace ns3
@@ -26,6 +26,8 @@
 #include "ns3/wave-helper.h"
 #include "ns3/mobility-model.h"
 #include "ns3/mobility-helper.h"
+#include <algorithm>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("BsmApplication");
 
@@ -61,7 +63,9 @@ BsmApplication::BsmApplication ()
     m_nodeId (0),
     m_chAccessMode (0),
     m_txMaxDelay (MilliSeconds (10)),
-    m_prevTxDelay (MilliSeconds (0))
+    m_prevTxDelay (MilliSeconds (0)),
+    m_neighborGrid (0),
+    m_txMaxRange (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -76,6 +80,9 @@ BsmApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
+  m_neighborGrid = 0;
+  m_neighbors.clear ();
+
   // chain up
   Application::DoDispose ();
 }
@@ -217,6 +224,29 @@ BsmApplication::Setup (Ipv4InterfaceContainer & i,
   m_adhocTxInterfaces = &i;
   m_nodeId = nodeId;
   m_txMaxDelay = txMaxDelay;
+
+  // expected receivers are counted in the bucket of the
+  // smallest range they are within, so keep the ranges sorted
+  m_sortedRangesSq.clear ();
+  for (int index = 1; index <= size; index++)
+    {
+      m_sortedRangesSq.push_back (std::make_pair (m_txSafetyRangesSq[index - 1], index));
+    }
+  std::sort (m_sortedRangesSq.begin (), m_sortedRangesSq.end ());
+  m_rangeCounts.assign (size, 0);
+  m_txMaxRange = size > 0 ? std::sqrt (m_sortedRangesSq.back ().first) : 0;
+
+  // all the nodes with a BSM application share the grid,
+  // which holds every node that could receive a BSM
+  m_neighborGrid = m_waveBsmStats->GetNeighborGrid ();
+  if (m_neighborGrid->GetNNodes () == 0)
+    {
+      int nRxNodes = m_adhocTxInterfaces->GetN ();
+      for (int index = 0; index < nRxNodes; index++)
+        {
+          m_neighborGrid->AddNode (GetNode (index));
+        }
+    }
 }
 
 void
@@ -253,39 +283,39 @@ BsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
             }
 
           // find other nodes within range that would be
-          // expected to receive this broadbast
-          int nRxNodes = m_adhocTxInterfaces->GetN ();
-          for (int i = 0; i < nRxNodes; i++)
+          // expected to receive this broadbast, from the
+          // grid of node positions instead of checking all nodes
+          m_neighborGrid->GetNeighbors (txPosition->GetPosition (), m_txMaxRange, m_neighbors);
+          std::fill (m_rangeCounts.begin (), m_rangeCounts.end (), 0);
+          for (auto const &neighbor : m_neighbors)
             {
-              Ptr<Node> rxNode = GetNode (i);
-              int rxNodeId = rxNode->GetId ();
-
-              if (rxNodeId != txNodeId)
+              int rxNodeId = neighbor.first->GetId ();
+              double distSq = neighbor.second;
+              // confirm that the receiving node
+              // has also started moving in the scenario
+              // if it has not started moving, then
+              // it is not a candidate to receive a packet
+              if (rxNodeId == txNodeId || m_nodesMoving->at (rxNodeId) != 1 || distSq <= 0.0)
+                {
+                  continue;
+                }
+              // count the dest node in the smallest range it is within
+              auto range = std::lower_bound (m_sortedRangesSq.begin (), m_sortedRangesSq.end (),
+                                             std::make_pair (distSq, 0));
+              if (range != m_sortedRangesSq.end ())
+                {
+                  m_rangeCounts[range - m_sortedRangesSq.begin ()]++;
+                }
+            }
+          // we should expect dest nodes within a range, including those
+          // within smaller ones, to receive broadcast pkt
+          int expected = 0;
+          for (uint32_t bucket = 0; bucket < m_sortedRangesSq.size (); bucket++)
+            {
+              expected += m_rangeCounts[bucket];
+              if (expected > 0)
                 {
-                  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
-                  NS_ASSERT (rxPosition != 0);
-                  // confirm that the receiving node
-                  // has also started moving in the scenario
-                  // if it has not started moving, then
-                  // it is not a candidate to receive a packet
-                  int receiverMoving = m_nodesMoving->at (rxNodeId);
-                  if (receiverMoving == 1)
-                    {
-                      double distSq = MobilityHelper::GetDistanceSquaredBetween (txNode, rxNode);
-                      if (distSq > 0.0)
-                        {
-                          // dest node within range?
-                          int rangeCount = m_txSafetyRangesSq.size ();
-                          for (int index = 1; index <= rangeCount; index++)
-                            {
-                              if (distSq <= m_txSafetyRangesSq[index - 1])
-                                {
-                                  // we should expect dest node to receive broadcast pkt
-                                  m_waveBsmStats->IncExpectedRxPktCount (index);
-                                }
-                            }
-                        }
-                    }
+                  m_waveBsmStats->AddExpectedRxPktCount (m_sortedRangesSq[bucket].second, expected);
                 }
             }
         }
@@ -26,6 +26,7 @@
 #include "ns3/wave-bsm-stats.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/bsm-neighbor-grid.h"
 
 namespace ns3 {
 /**
@@ -176,6 +177,14 @@ private:
    * max transmit delay (default 10ms) */
   Time m_txMaxDelay;
   Time m_prevTxDelay; ///< previous transmit delay
+  Ptr<BsmNeighborGrid> m_neighborGrid; ///< shared grid of node positions
+  double m_txMaxRange; ///< largest tx safety range, in m
+  /// tx safety ranges squared, sorted, with their statistics index
+  std::vector<std::pair<double, int> > m_sortedRangesSq;
+  /// nodes within the largest range of the last BSM, and their squared distance
+  std::vector<std::pair<Ptr<Node>, double> > m_neighbors;
+  /// nodes within each sorted range and not within the previous one
+  std::vector<int> m_rangeCounts;
 };
 
 } // namespace ns3
@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/bsm-neighbor-grid.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mobility-model.h"
+#include <cmath>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BsmNeighborGrid");
+NS_OBJECT_ENSURE_REGISTERED (BsmNeighborGrid);
+
+/**
+ * \brief Get the squared distance between two positions, computed as
+ * MobilityHelper::GetDistanceSquaredBetween does
+ * \param a a position
+ * \param b another position
+ * \return the squared distance, in m ^ 2
+ */
+static double
+GetDistanceSquared (const Vector &a, const Vector &b)
+{
+  double dist = CalculateDistance (a, b);
+  return dist * dist;
+}
+
+TypeId
+BsmNeighborGrid::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BsmNeighborGrid")
+    .SetParent<Object> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<BsmNeighborGrid> ()
+    .AddAttribute ("CellSize",
+                   "The size of the grid cells, in m. "
+                   "If zero, the largest query range so far is used.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&BsmNeighborGrid::m_cellSizeAttr),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("RebuildInterval",
+                   "The time after which the first query rebuilds the grid.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&BsmNeighborGrid::m_rebuildInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxSpeed",
+                   "The highest node speed expected between grid builds, in m/s.",
+                   DoubleValue (60),
+                   MakeDoubleAccessor (&BsmNeighborGrid::m_maxSpeed),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+BsmNeighborGrid::BsmNeighborGrid ()
+  : m_cellSize (1),
+    m_cellSizeAttr (0),
+    m_maxQueryRange (0),
+    m_buildSpeed (0),
+    m_built (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BsmNeighborGrid::~BsmNeighborGrid ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BsmNeighborGrid::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  m_cells.clear ();
+  Object::DoDispose ();
+}
+
+void
+BsmNeighborGrid::AddNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  GridNode gridNode;
+  gridNode.node = node;
+  gridNode.mobility = node->GetObject<MobilityModel> ();
+  NS_ASSERT (gridNode.mobility != 0);
+  m_nodes.push_back (gridNode);
+  m_built = false;
+}
+
+uint32_t
+BsmNeighborGrid::GetNNodes (void) const
+{
+  return m_nodes.size ();
+}
+
+int32_t
+BsmNeighborGrid::GetCell (double coordinate) const
+{
+  return static_cast<int32_t> (std::floor (coordinate / m_cellSize));
+}
+
+uint64_t
+BsmNeighborGrid::GetCellKey (int32_t x, int32_t y)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+void
+BsmNeighborGrid::Build (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_cellSize = m_cellSizeAttr > 0 ? m_cellSizeAttr : std::max (m_maxQueryRange, 1.0);
+  for (auto &cell : m_cells)
+    {
+      cell.second.clear ();
+    }
+  m_buildSpeed = 0;
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    {
+      Vector position = m_nodes[i].mobility->GetPosition ();
+      m_cells[GetCellKey (GetCell (position.x), GetCell (position.y))].push_back (i);
+      m_buildSpeed = std::max (m_buildSpeed, m_nodes[i].mobility->GetVelocity ().GetLength ());
+    }
+  m_lastBuild = Simulator::Now ();
+  m_built = true;
+}
+
+void
+BsmNeighborGrid::GetNeighbors (const Vector &position, double range,
+                               std::vector<std::pair<Ptr<Node>, double> > &neighbors)
+{
+  NS_LOG_FUNCTION (this << position << range);
+
+  neighbors.clear ();
+  m_maxQueryRange = std::max (m_maxQueryRange, range);
+  if (!m_built || Simulator::Now () - m_lastBuild >= m_rebuildInterval)
+    {
+      Build ();
+    }
+
+  double rangeSq = range * range;
+  double travelled = std::max (m_maxSpeed, m_buildSpeed) * (Simulator::Now () - m_lastBuild).GetSeconds ();
+  double searchRange = range + travelled;
+  int32_t minX = GetCell (position.x - searchRange);
+  int32_t maxX = GetCell (position.x + searchRange);
+  int32_t minY = GetCell (position.y - searchRange);
+  int32_t maxY = GetCell (position.y + searchRange);
+
+  // When the search covers more cells than there are nodes, checking every
+  // node is cheaper than visiting the cells.
+  double cells = (static_cast<double> (maxX) - minX + 1) * (static_cast<double> (maxY) - minY + 1);
+  if (cells > m_nodes.size ())
+    {
+      for (auto const &gridNode : m_nodes)
+        {
+          double distSq = GetDistanceSquared (gridNode.mobility->GetPosition (), position);
+          if (distSq <= rangeSq)
+            {
+              neighbors.push_back (std::make_pair (gridNode.node, distSq));
+            }
+        }
+      return;
+    }
+
+  for (int32_t x = minX; x <= maxX; x++)
+    {
+      for (int32_t y = minY; y <= maxY; y++)
+        {
+          auto cell = m_cells.find (GetCellKey (x, y));
+          if (cell == m_cells.end ())
+            {
+              continue;
+            }
+          for (uint32_t i : cell->second)
+            {
+              double distSq = GetDistanceSquared (m_nodes[i].mobility->GetPosition (), position);
+              if (distSq <= rangeSq)
+                {
+                  neighbors.push_back (std::make_pair (m_nodes[i].node, distSq));
+                }
+            }
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BSM_NEIGHBOR_GRID_H
+#define BSM_NEIGHBOR_GRID_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+class Node;
+class MobilityModel;
+
+/**
+ * \ingroup wave
+ * \brief The BsmNeighborGrid class is a spatial grid of node positions,
+ * used to find the nodes within range of a position without checking the
+ * distance to every node. It is shared by all the BsmApplication instances
+ * of a scenario (see WaveBsmStats::GetNeighborGrid) to count the nodes
+ * expected to receive each BSM.
+ *
+ * Nodes are placed in square cells of the x-y plane from their positions
+ * when the grid is built. The grid is rebuilt by the first query after
+ * RebuildInterval, so it is not rebuilt while there are no queries. Nodes
+ * may have moved since the grid was built, so queries search the cells
+ * within the range plus the distance a node could have travelled since
+ * then (at MaxSpeed, or at the highest node speed seen when the grid was
+ * built, if higher), and check the current position of each candidate.
+ * Query results are exact as long as no node moves faster than that.
+ */
+class BsmNeighborGrid : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor
+   * \return none
+   */
+  BsmNeighborGrid ();
+  virtual ~BsmNeighborGrid ();
+
+  /**
+   * \brief Add a node to the grid. The node must have a MobilityModel.
+   * \param node the node
+   * \return none
+   */
+  void AddNode (Ptr<Node> node);
+
+  /**
+   * \brief Get the number of nodes in the grid
+   * \return the number of nodes
+   */
+  uint32_t GetNNodes (void) const;
+
+  /**
+   * \brief Get the nodes within range of a position, at the current time
+   * \param position the position
+   * \param range the range, in m
+   * \param neighbors cleared, then filled with each node within range
+   * and its squared distance to the position, in m ^ 2
+   * \return none
+   */
+  void GetNeighbors (const Vector &position, double range,
+                     std::vector<std::pair<Ptr<Node>, double> > &neighbors);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Place the nodes in the cells of their current positions
+   * \return none
+   */
+  void Build (void);
+
+  /**
+   * \brief Get the cell coordinate of a position coordinate
+   * \param coordinate the position coordinate, in m
+   * \return the cell coordinate
+   */
+  int32_t GetCell (double coordinate) const;
+
+  /**
+   * \brief Get the key of a cell
+   * \param x the cell x coordinate
+   * \param y the cell y coordinate
+   * \return the cell key
+   */
+  static uint64_t GetCellKey (int32_t x, int32_t y);
+
+  /// Node in the grid
+  struct GridNode
+  {
+    Ptr<Node> node;               ///< the node
+    Ptr<MobilityModel> mobility;  ///< the node mobility model
+  };
+
+  std::vector<GridNode> m_nodes; ///< nodes in the grid
+  /// node indexes in each non-empty cell, by cell key
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells;
+  double m_cellSize; ///< cell size in use, in m
+  double m_cellSizeAttr; ///< cell size attribute, in m (0 for the largest query range)
+  double m_maxQueryRange; ///< largest query range so far, in m
+  Time m_rebuildInterval; ///< time after which the grid is rebuilt
+  double m_maxSpeed; ///< speed bound for the distance travelled since the build, in m/s
+  double m_buildSpeed; ///< highest node speed when the grid was built, in m/s
+  Time m_lastBuild; ///< time of the last build
+  bool m_built; ///< whether the grid has been built since the last change
+};
+
+} // namespace ns3
+
+#endif /* BSM_NEIGHBOR_GRID_H */
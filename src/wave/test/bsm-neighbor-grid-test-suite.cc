@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/bsm-neighbor-grid.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Check that the nodes found by the BsmNeighborGrid are the nodes
+ * found by checking the distance to every node, while the nodes move and
+ * the grid gets stale between rebuilds.
+ */
+class BsmNeighborGridTestCase : public TestCase
+{
+public:
+  BsmNeighborGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Compare the grid neighbors of each node with the nodes within range.
+   * \param range The query range, in m.
+   */
+  void Check (double range);
+
+  NodeContainer m_nodes; ///< the nodes
+  Ptr<BsmNeighborGrid> m_grid; ///< the grid under test
+  uint32_t m_found; ///< number of neighbors found
+};
+
+BsmNeighborGridTestCase::BsmNeighborGridTestCase ()
+  : TestCase ("Check BsmNeighborGrid queries against all node distances"),
+    m_found (0)
+{
+}
+
+void
+BsmNeighborGridTestCase::Check (double range)
+{
+  std::vector<std::pair<Ptr<Node>, double> > neighbors;
+  for (NodeContainer::Iterator tx = m_nodes.Begin (); tx != m_nodes.End (); ++tx)
+    {
+      Vector position = (*tx)->GetObject<MobilityModel> ()->GetPosition ();
+      m_grid->GetNeighbors (position, range, neighbors);
+      std::vector<uint32_t> actual;
+      for (auto const &neighbor : neighbors)
+        {
+          double distSq = MobilityHelper::GetDistanceSquaredBetween (*tx, neighbor.first);
+          NS_TEST_EXPECT_MSG_EQ_TOL (neighbor.second, distSq, 1e-6, "Wrong distance");
+          actual.push_back (neighbor.first->GetId ());
+        }
+      std::vector<uint32_t> expected;
+      for (NodeContainer::Iterator rx = m_nodes.Begin (); rx != m_nodes.End (); ++rx)
+        {
+          if (MobilityHelper::GetDistanceSquaredBetween (*tx, *rx) <= range * range)
+            {
+              expected.push_back ((*rx)->GetId ());
+            }
+        }
+      std::sort (actual.begin (), actual.end ());
+      NS_TEST_EXPECT_MSG_EQ ((actual == expected), true, "Wrong neighbors of node " << (*tx)->GetId ()
+                             << " within " << range << " m at " << Simulator::Now ().GetSeconds () << " s");
+      m_found += actual.size ();
+    }
+}
+
+void
+BsmNeighborGridTestCase::DoRun (void)
+{
+  m_nodes.Create (200);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=2000.0]"),
+                                 "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=2000.0]"));
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (m_nodes);
+  Ptr<UniformRandomVariable> speed = CreateObject<UniformRandomVariable> ();
+  speed->SetStream (1);
+  for (NodeContainer::Iterator it = m_nodes.Begin (); it != m_nodes.End (); ++it)
+    {
+      (*it)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (
+        Vector (speed->GetValue (-30, 30), speed->GetValue (-30, 30), 0));
+    }
+
+  m_grid = CreateObject<BsmNeighborGrid> ();
+  m_grid->SetAttribute ("RebuildInterval", TimeValue (Seconds (1)));
+  m_grid->SetAttribute ("MaxSpeed", DoubleValue (30 * std::sqrt (2)));
+  for (NodeContainer::Iterator it = m_nodes.Begin (); it != m_nodes.End (); ++it)
+    {
+      m_grid->AddNode (*it);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_grid->GetNNodes (), 200, "Wrong number of nodes");
+
+  // query between rebuilds, with ranges below and above the cell size
+  for (Time t = Seconds (0); t < Seconds (5); t += MilliSeconds (300))
+    {
+      Simulator::Schedule (t, &BsmNeighborGridTestCase::Check, this, 150);
+      Simulator::Schedule (t, &BsmNeighborGridTestCase::Check, this, 50);
+      Simulator::Schedule (t, &BsmNeighborGridTestCase::Check, this, 400);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // the nodes find at least themselves
+  NS_TEST_EXPECT_MSG_GT (m_found, 200 * 3 * 17, "Too few neighbors to check the grid");
+  m_grid = 0;
+  m_nodes = NodeContainer ();
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief BSM neighbor grid test suite
+ */
+class BsmNeighborGridTestSuite : public TestSuite
+{
+public:
+  BsmNeighborGridTestSuite ();
+};
+
+BsmNeighborGridTestSuite::BsmNeighborGridTestSuite ()
+  : TestSuite ("wave-bsm-neighbor-grid", UNIT)
+{
+  AddTestCase (new BsmNeighborGridTestCase, TestCase::QUICK);
+}
+
+static BsmNeighborGridTestSuite bsmNeighborGridTestSuite; ///< the test suite
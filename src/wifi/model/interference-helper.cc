@@ -19,6 +19,7 @@
  *          Sébastien Deronne <sebastien.deronne@gmail.com>
  */
 
+#include <algorithm>
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
@@ -89,8 +90,9 @@ Event::GetPayloadMode (void) const
  *       short period of time.
  ****************************************************************/
 
-InterferenceHelper::NiChange::NiChange (double power, Ptr<Event> event)
-  : m_power (power),
+InterferenceHelper::NiChange::NiChange (double powerChange, Ptr<Event> event)
+  : m_power (0),
+    m_powerChange (powerChange),
     m_event (event)
 {
 }
@@ -102,9 +104,15 @@ InterferenceHelper::NiChange::GetPower (void) const
 }
 
 void
-InterferenceHelper::NiChange::AddPower (double power)
+InterferenceHelper::NiChange::SetPower (double power)
 {
-  m_power += power;
+  m_power = power;
+}
+
+double
+InterferenceHelper::NiChange::GetPowerChange (void) const
+{
+  return m_powerChange;
 }
 
 Ptr<Event>
@@ -125,7 +133,7 @@ InterferenceHelper::InterferenceHelper ()
     m_rxing (false)
 {
   // Always have a zero power noise event in the list
-  AddNiChangeEvent (Time (0), NiChange (0.0, 0));
+  m_lastKnownPower = AddNiChangeEvent (Time (0), NiChange (0.0, 0));
 }
 
 InterferenceHelper::~InterferenceHelper ()
@@ -182,14 +190,11 @@ InterferenceHelper::GetEnergyDuration (double energyW) const
   Time now = Simulator::Now ();
   auto i = GetPreviousPosition (now);
   Time end = i->first;
-  for (; i != m_niChanges.end (); ++i)
+  double noiseInterferenceW = GetPower (i);
+  while (noiseInterferenceW >= energyW && ++i != m_niChanges.end ())
     {
-      double noiseInterferenceW = i->second.GetPower ();
+      noiseInterferenceW += i->second.GetPowerChange ();
       end = i->first;
-      if (noiseInterferenceW < energyW)
-        {
-          break;
-        }
     }
   return end > now ? end - now : MicroSeconds (0);
 }
@@ -198,24 +203,24 @@ void
 InterferenceHelper::AppendEvent (Ptr<Event> event)
 {
   NS_LOG_FUNCTION (this);
-  double previousPowerStart = 0;
-  double previousPowerEnd = 0;
-  previousPowerStart = GetPreviousPosition (event->GetStartTime ())->second.GetPower ();
-  previousPowerEnd = GetPreviousPosition (event->GetEndTime ())->second.GetPower ();
+  UpdatePower (event->GetStartTime ());
+  double previousPowerStart = GetPreviousPosition (event->GetStartTime ())->second.GetPower ();
 
   if (!m_rxing)
     {
       m_firstPower = previousPowerStart;
-      // Always leave the first zero power noise event in the list
-      m_niChanges.erase (++(m_niChanges.begin ()),
-                         GetNextPosition (event->GetStartTime ()));
-    }
-  auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
-  auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
-  for (auto i = first; i != last; ++i)
-    {
-      i->second.AddPower (event->GetRxPowerW ());
+      // Always leave the first noise event in the list, with the power
+      // of the erased ones, or zero power if no signal is left
+      auto last = GetNextPosition (event->GetStartTime ());
+      m_niChanges.begin ()->second.SetPower (last == m_niChanges.end () ? 0 : previousPowerStart);
+      m_niChanges.erase (++(m_niChanges.begin ()), last);
+      m_lastKnownPower = m_niChanges.begin ();
     }
+  // The later NiChanges are not updated: their power is set from the
+  // power changes once they are past
+  AddNiChangeEvent (event->GetStartTime (), NiChange (event->GetRxPowerW (), event));
+  AddNiChangeEvent (event->GetEndTime (), NiChange (-event->GetRxPowerW (), event));
+  UpdatePower (event->GetStartTime ());
 }
 
 double
@@ -234,20 +239,19 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint1
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiRange *ni) const
 {
   double noiseInterference = m_firstPower;
   auto it = m_niChanges.find (event->GetStartTime ());
   for (; it != m_niChanges.end () && it->second.GetEvent () != event; ++it)
     {
-      noiseInterference = it->second.GetPower ();
-    }
-  ni->emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != m_niChanges.end () && it->second.GetEvent () != event)
-    {
-      ni->insert (*it);
+      noiseInterference = GetPower (it);
     }
-  ni->emplace (event->GetEndTime (), NiChange (0, event));
+  NS_ASSERT_MSG (it != m_niChanges.end (), "Start of event not found");
+  ni->first = it;
+  ni->second = std::find_if (++it, m_niChanges.end (),
+                             [&event] (const NiChanges::value_type &change) { return change.second.GetEvent () == event; });
+  NS_ASSERT_MSG (ni->second != m_niChanges.end (), "End of event not found");
   return noiseInterference;
 }
 
@@ -274,13 +278,14 @@ InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiM
 }
 
 double
-InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, const NiRange &ni) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = ni.first;
   Time previous = j->first;
+  double totalPowerW = GetPower (j);
   WifiMode payloadMode = event->GetPayloadMode ();
   WifiPreamble preamble = txVector.GetPreambleType ();
   Time plcpHeaderStart = j->first + WifiPhy::GetPlcpPreambleDuration (txVector); //packet start time + preamble
@@ -289,8 +294,9 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  while (j != ni.second)
     {
+      ++j;
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
       NS_ASSERT (current >= previous);
@@ -314,7 +320,8 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
                                             payloadMode, txVector);
           NS_LOG_DEBUG ("previous is before payload and current is in the payload: mode=" << payloadMode << ", psr=" << psr);
         }
-      noiseInterferenceW = j->second.GetPower () - powerW;
+      totalPowerW += j->second.GetPowerChange ();
+      noiseInterferenceW = totalPowerW - powerW;
       previous = j->first;
     }
   double per = 1 - psr;
@@ -322,13 +329,14 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
 }
 
 double
-InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, const NiRange &ni) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = ni.first;
   Time previous = j->first;
+  double totalPowerW = GetPower (j);
   WifiPreamble preamble = txVector.GetPreambleType ();
   WifiMode mcsHeaderMode;
   if (preamble == WIFI_PREAMBLE_HT_MF || preamble == WIFI_PREAMBLE_HT_GF)
@@ -353,8 +361,9 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  while (j != ni.second)
     {
+      ++j;
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
       NS_ASSERT (current >= previous);
@@ -728,7 +737,8 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
             }
         }
 
-      noiseInterferenceW = j->second.GetPower () - powerW;
+      totalPowerW += j->second.GetPowerChange ();
+      noiseInterferenceW = totalPowerW - powerW;
       previous = j->first;
     }
 
@@ -739,7 +749,7 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
+  NiRange ni;
   double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
@@ -748,7 +758,7 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpPayloadPer (event, &ni);
+  double per = CalculatePlcpPayloadPer (event, ni);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -759,7 +769,7 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
+  NiRange ni;
   double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
@@ -768,7 +778,7 @@ InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the plcp header and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpHeaderPer (event, &ni);
+  double per = CalculatePlcpHeaderPer (event, ni);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -781,7 +791,8 @@ InterferenceHelper::EraseEvents (void)
 {
   m_niChanges.clear ();
   // Always have a zero power noise event in the list
-  AddNiChangeEvent (Time (0), NiChange (0.0, 0));
+  m_lastKnownPower = AddNiChangeEvent (Time (0), NiChange (0.0, 0));
+  m_lastUpdate = Time (0);
   m_rxing = false;
   m_firstPower = 0;
 }
@@ -808,6 +819,35 @@ InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change)
   return m_niChanges.insert (GetNextPosition (moment), std::make_pair (moment, change));
 }
 
+void
+InterferenceHelper::UpdatePower (Time moment)
+{
+  for (auto next = std::next (m_lastKnownPower);
+       next != m_niChanges.end () && next->first <= moment; ++next)
+    {
+      next->second.SetPower (m_lastKnownPower->second.GetPower () + next->second.GetPowerChange ());
+      m_lastKnownPower = next;
+    }
+  m_lastUpdate = moment;
+}
+
+double
+InterferenceHelper::GetPower (NiChanges::const_iterator change) const
+{
+  if (change->first <= m_lastUpdate)
+    {
+      return change->second.GetPower ();
+    }
+  NiChanges::const_iterator i = m_lastKnownPower;
+  double power = i->second.GetPower ();
+  while (i != change)
+    {
+      ++i;
+      power += i->second.GetPowerChange ();
+    }
+  return power;
+}
+
 void
 InterferenceHelper::NotifyRxStart ()
 {
@@ -820,6 +860,7 @@ InterferenceHelper::NotifyRxEnd ()
 {
   NS_LOG_FUNCTION (this);
   m_rxing = false;
+  UpdatePower (Simulator::Now ());
   //Update m_firstPower for frame capture
   auto it = m_niChanges.find (Simulator::Now ());
   it--;
@@ -212,24 +212,31 @@ private:
   {
 public:
     /**
-     * Create a NiChange at the given time and the amount of NI change.
+     * Create a NiChange with the amount of NI change.
      *
-     * \param power the power
+     * \param powerChange the power change
      * \param event causes this NI change
      */
-    NiChange (double power, Ptr<Event> event);
+    NiChange (double powerChange, Ptr<Event> event);
     /**
-     * Return the power
+     * Return the power from this NI change on. It is only known once
+     * the power of the previous NI changes is known.
      *
      * \return the power
      */
     double GetPower (void) const;
     /**
-     * Add a given amount of power.
+     * Set the power from this NI change on.
      *
-     * \param power the power to be added to the existing value
+     * \param power the power
      */
-    void AddPower (double power);
+    void SetPower (double power);
+    /**
+     * Return the power change
+     *
+     * \return the power change
+     */
+    double GetPowerChange (void) const;
     /**
      * Return the event causes the corresponding NI change
      *
@@ -240,13 +247,23 @@ public:
 
 private:
     double m_power; ///< power
+    double m_powerChange; ///< power change
     Ptr<Event> m_event; ///< event
   };
 
   /**
-   * typedef for a multimap of NiChanges
+   * typedef for a multimap of NiChanges. Each NiChange holds the power
+   * change of the start or end of a signal, so adding a signal does not
+   * update the later NiChanges. The power from a NiChange on, i.e. the
+   * prefix sum of the power changes, is set once the NiChange is past.
    */
   typedef std::multimap<Time, NiChange> NiChanges;
+  /**
+   * typedef for the NiChanges of an event: the first one is the start
+   * of the event and the second one is its end, with the NI changes
+   * during the event in between.
+   */
+  typedef std::pair<NiChanges::const_iterator, NiChanges::const_iterator> NiRange;
 
   /**
    * Append the given Event.
@@ -258,11 +275,11 @@ private:
    * Calculate noise and interference power in W.
    *
    * \param event
-   * \param ni
+   * \param ni the NiChanges of the event
    *
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiRange *ni) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -291,27 +308,29 @@ private:
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param ni the NiChanges of the event
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpPayloadPer (Ptr<const Event> event, const NiRange &ni) const;
   /**
    * Calculate the error rate of the plcp header. The plcp header can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param ni the NiChanges of the event
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpHeaderPer (Ptr<const Event> event, const NiRange &ni) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
   uint8_t m_numRxAntennas; /**< the number of RX antennas in the corresponding receiver */
   /// Experimental: needed for energy duration calculation
   NiChanges m_niChanges;
+  NiChanges::iterator m_lastKnownPower; ///< the last NiChange whose power is set
+  Time m_lastUpdate; ///< the time up to which the power of the NiChanges is set
   double m_firstPower; ///< first power
   bool m_rxing; ///< flag whether it is in receiving state
 
@@ -346,6 +365,21 @@ private:
    * \returns the iterator of the new event
    */
   NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change);
+  /**
+   * Set the power of the NiChanges up to the given moment, from the power
+   * of the last NiChange whose power is set.
+   *
+   * \param moment time to set the power up to
+   */
+  void UpdatePower (Time moment);
+  /**
+   * Return the power from the given NiChange on, adding the power changes
+   * since the last NiChange whose power is set if needed.
+   *
+   * \param change the NiChange
+   * \returns the power
+   */
+  double GetPower (NiChanges::const_iterator change) const;
 };
 
 } //namespace ns3
@@ -22,6 +22,8 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -30,6 +32,9 @@
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 namespace ns3 {
 
@@ -52,11 +57,41 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverCulling",
+                   "Whether to skip the PHYs out of range of each transmission, "
+                   "when the propagation loss model can bound its range.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_culling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CullingMargin",
+                   "The margin below the lowest energy detection and CCA mode 1 "
+                   "thresholds of the PHYs under which receivers are skipped, in dB.",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cullingMargin),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("CullingGridInterval",
+                   "The time after which the first transmission rebuilds the grid "
+                   "of PHY positions used for culling.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&YansWifiChannel::m_cullingInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("CullingMaxSpeed",
+                   "The highest PHY speed expected between culling grid builds, in m/s.",
+                   DoubleValue (60),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cullingMaxSpeed),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_cullingCellSize (1),
+    m_cullingMaxRange (0),
+    m_cullingRxPowerDbm (0),
+    m_cullingBuildSpeed (0),
+    m_cullingBuilt (false),
+    m_nReceptions (0),
+    m_nCulled (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -65,6 +100,7 @@ YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+  m_cullingMobility.clear ();
 }
 
 void
@@ -82,43 +118,190 @@ YansWifiChannel::SetPropagationDelayModel (const Ptr<PropagationDelayModel> dela
 }
 
 void
-YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
+  if (m_culling && FindReceivers (senderMobility, txPowerDbm))
+    {
+      m_nCulled += m_phyList.size () - m_receivers.size ();
+      for (uint32_t i : m_receivers)
+        {
+          if (sender != m_phyList[i])
+            {
+              SendTo (sender, senderMobility, m_phyList[i], packet, txPowerDbm, duration);
+            }
+        }
+      return;
+    }
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
     {
       if (sender != (*i))
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          SendTo (sender, senderMobility, *i, packet, txPowerDbm, duration);
+        }
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                         Ptr<const Packet> packet, double txPowerDbm, Time duration)
+{
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  m_nReceptions++;
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm, duration);
+}
+
+int32_t
+YansWifiChannel::GetCullingCell (double coordinate) const
+{
+  return static_cast<int32_t> (std::floor (coordinate / m_cullingCellSize));
+}
+
+/**
+ * \param x the cell x coordinate
+ * \param y the cell y coordinate
+ * \return the key of a culling grid cell
+ */
+static uint64_t
+GetCullingCellKey (int32_t x, int32_t y)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+void
+YansWifiChannel::BuildCullingGrid (double txPowerDbm)
+{
+  NS_LOG_FUNCTION (this << txPowerDbm);
+
+  // The channel reception power does not include the receiver gain
+  m_cullingRxPowerDbm = std::numeric_limits<double>::infinity ();
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      double thresholdDbm = std::min ((*i)->GetEdThreshold (), (*i)->GetCcaMode1Threshold ());
+      m_cullingRxPowerDbm = std::min (m_cullingRxPowerDbm, thresholdDbm - (*i)->GetRxGain ());
+    }
+  m_cullingRxPowerDbm -= m_cullingMargin;
+  m_cullingMaxRange = std::max (m_cullingMaxRange, m_loss->GetMaxRange (txPowerDbm, m_cullingRxPowerDbm));
+  m_cullingCellSize = std::max (m_cullingMaxRange, 1.0);
+
+  for (auto &cell : m_cullingCells)
+    {
+      cell.second.clear ();
+    }
+  m_cullingMobility.resize (m_phyList.size ());
+  m_cullingBuildSpeed = 0;
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      m_cullingMobility[i] = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      Vector position = m_cullingMobility[i]->GetPosition ();
+      m_cullingCells[GetCullingCellKey (GetCullingCell (position.x), GetCullingCell (position.y))].push_back (i);
+      m_cullingBuildSpeed = std::max (m_cullingBuildSpeed, m_cullingMobility[i]->GetVelocity ().GetLength ());
+    }
+  m_cullingLastBuild = Simulator::Now ();
+  m_cullingBuilt = true;
+  NS_LOG_DEBUG ("culling below " << m_cullingRxPowerDbm << "dBm, cell size=" << m_cullingCellSize << "m");
+}
+
+bool
+YansWifiChannel::FindReceivers (Ptr<MobilityModel> senderMobility, double txPowerDbm)
+{
+  NS_LOG_FUNCTION (this << senderMobility << txPowerDbm);
+
+  Time now = Simulator::Now ();
+  if (!m_cullingBuilt || now - m_cullingLastBuild >= m_cullingInterval)
+    {
+      BuildCullingGrid (txPowerDbm);
+    }
+  double range = m_loss->GetMaxRange (txPowerDbm, m_cullingRxPowerDbm);
+  if (range < 0)
+    {
+      return false;
+    }
+  m_cullingMaxRange = std::max (m_cullingMaxRange, range);
+
+  m_receivers.clear ();
+  Vector position = senderMobility->GetPosition ();
+  double travelled = std::max (m_cullingMaxSpeed, m_cullingBuildSpeed) * (now - m_cullingLastBuild).GetSeconds ();
+  double searchRange = range + travelled;
+  int32_t minX = GetCullingCell (position.x - searchRange);
+  int32_t maxX = GetCullingCell (position.x + searchRange);
+  int32_t minY = GetCullingCell (position.y - searchRange);
+  int32_t maxY = GetCullingCell (position.y + searchRange);
+
+  // When the search covers more cells than there are PHYs, checking every
+  // PHY is cheaper than visiting the cells.
+  double cells = (static_cast<double> (maxX) - minX + 1) * (static_cast<double> (maxY) - minY + 1);
+  if (cells > m_phyList.size ())
+    {
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          if (CalculateDistance (m_cullingMobility[i]->GetPosition (), position) <= range)
             {
-              continue;
+              m_receivers.push_back (i);
             }
+        }
+      return true;
+    }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+  for (int32_t x = minX; x <= maxX; x++)
+    {
+      for (int32_t y = minY; y <= maxY; y++)
+        {
+          auto cell = m_cullingCells.find (GetCullingCellKey (x, y));
+          if (cell == m_cullingCells.end ())
             {
-              dstNode = 0xffffffff;
+              continue;
             }
-          else
+          for (uint32_t i : cell->second)
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              if (CalculateDistance (m_cullingMobility[i]->GetPosition (), position) <= range)
+                {
+                  m_receivers.push_back (i);
+                }
             }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
         }
     }
+  // deliver in the order of the PHY list, as without culling
+  std::sort (m_receivers.begin (), m_receivers.end ());
+  return true;
+}
+
+uint64_t
+YansWifiChannel::GetNReceptions (void) const
+{
+  return m_nReceptions;
+}
+
+uint64_t
+YansWifiChannel::GetNCulledReceptions (void) const
+{
+  return m_nCulled;
 }
 
 void
@@ -145,6 +328,7 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  m_cullingBuilt = false;
 }
 
 int64_t
@@ -22,6 +22,9 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include <vector>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -30,7 +33,7 @@ class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
 class Packet;
-class Time;
+class MobilityModel;
 
 /**
  * \brief a channel to interconnect ns3::YansWifiPhy objects.
@@ -40,6 +43,20 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default, the channel delivers each transmission to every other PHY of
+ * the same channel number. With the ReceiverCulling attribute, the channel
+ * skips the PHYs too far away to detect the transmission: the propagation
+ * loss model bounds the distance beyond which the reception power is below
+ * the energy detection and CCA mode 1 thresholds of all the PHYs, minus
+ * CullingMargin (see PropagationLossModel::GetMaxRange), and a grid of the
+ * PHY positions finds the PHYs within that distance. Skipped PHYs do not
+ * see the transmission at all, so it neither adds to their interference nor
+ * fires their PhyRxDrop trace. Culling is disabled for the loss models which
+ * can't bound their range, and the grid assumes that no PHY moves faster
+ * than CullingMaxSpeed (or than the highest PHY speed when the grid was
+ * built) between grid builds. The PHY thresholds and gains are read when the
+ * grid is built.
  */
 class YansWifiChannel : public Channel
 {
@@ -84,7 +101,17 @@ public:
    * attempts to deliver the packet to all other YansWifiPhy objects
    * on the channel (except for the sender).
    */
-  void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+  void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration);
+
+  /**
+   * \return the number of receptions scheduled on the PHYs of this channel
+   */
+  uint64_t GetNReceptions (void) const;
+  /**
+   * \return the number of receptions skipped because the receiver was out
+   * of range, with ReceiverCulling
+   */
+  uint64_t GetNCulledReceptions (void) const;
 
   /**
    * Assign a fixed random variable stream number to the random variables
@@ -116,9 +143,65 @@ private:
    */
   static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
 
+  /**
+   * Schedule the reception of a packet on a PHY, if it uses the channel
+   * number of the sender.
+   *
+   * \param sender the PHY sending the packet
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the PHY receiving the packet
+   * \param packet the packet being sent
+   * \param txPowerDbm the tx power associated to the packet being sent (dBm)
+   * \param duration the transmission duration associated with the packet being sent
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+               Ptr<const Packet> packet, double txPowerDbm, Time duration);
+
+  /**
+   * Read the culling threshold from the PHYs, and place the PHYs in the
+   * cells of their current positions.
+   *
+   * \param txPowerDbm the tx power of the transmission being sent (dBm)
+   */
+  void BuildCullingGrid (double txPowerDbm);
+
+  /**
+   * Find the PHYs which may receive a transmission, with ReceiverCulling.
+   * Fills m_receivers with the indexes in m_phyList of the PHYs within
+   * range of the sender, in increasing order.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power of the transmission (dBm)
+   * \return false if the range can't be bounded, and every PHY may receive
+   */
+  bool FindReceivers (Ptr<MobilityModel> senderMobility, double txPowerDbm);
+
+  /**
+   * \param coordinate a position coordinate (m)
+   * \return the culling grid cell coordinate
+   */
+  int32_t GetCullingCell (double coordinate) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_culling;                      //!< Whether receivers out of range are skipped
+  double m_cullingMargin;              //!< Margin below the PHY thresholds (dB)
+  Time m_cullingInterval;              //!< Time after which the culling grid is rebuilt
+  double m_cullingMaxSpeed;            //!< Speed bound for the PHY moves between grid builds (m/s)
+  /// PHY indexes in each non-empty cell of the culling grid, by cell key
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cullingCells;
+  std::vector<Ptr<MobilityModel> > m_cullingMobility; //!< Mobility model of each PHY
+  double m_cullingCellSize;            //!< Culling grid cell size (m)
+  double m_cullingMaxRange;            //!< Largest culling range so far (m)
+  double m_cullingRxPowerDbm;          //!< Channel reception power below which PHYs are skipped (dBm)
+  double m_cullingBuildSpeed;          //!< Highest PHY speed when the grid was built (m/s)
+  Time m_cullingLastBuild;             //!< Time of the last culling grid build
+  bool m_cullingBuilt;                 //!< Whether the grid was built since the last PHY was added
+  std::vector<uint32_t> m_receivers;   //!< PHYs within range of the last transmission
+  uint64_t m_nReceptions;              //!< Number of receptions scheduled
+  uint64_t m_nCulled;                  //!< Number of receptions skipped by culling
 };
 
 } //namespace ns3
@@ -42,6 +42,8 @@
 #include "ns3/wifi-spectrum-signal-parameters.h"
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/boolean.h"
 #include "ns3/mgt-headers.h"
 
 using namespace ns3;
@@ -1690,6 +1692,131 @@ StaWifiMacScanningTestCase::DoRun (void)
   }
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that YansWifiChannel receiver culling only skips the PHYs
+ * which can't detect a transmission.
+ *
+ * Nodes spread over an area larger than their range broadcast one packet
+ * each, one after the other, with and without culling. The PHYs must start
+ * and end receiving the same packets in both cases.
+ */
+class YansWifiChannelCullingTest : public TestCase
+{
+public:
+  YansWifiChannelCullingTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Run the scenario
+   * \param culling whether to enable receiver culling
+   * \param rxBegin the number of receptions started by each node
+   * \param rxEnd the number of receptions ended by each node
+   * \param channel the channel, set by the method
+   */
+  void RunOne (bool culling, std::vector<uint32_t> *rxBegin, std::vector<uint32_t> *rxEnd,
+               Ptr<YansWifiChannel> *channel);
+  /**
+   * Count a PHY trace event
+   * \param count the counter of the node
+   * \param packet the received packet
+   */
+  static void Count (uint32_t *count, Ptr<const Packet> packet);
+
+  std::vector<Vector> m_positions; ///< node positions
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : TestCase ("Test YansWifiChannel receiver culling")
+{
+}
+
+void
+YansWifiChannelCullingTest::Count (uint32_t *count, Ptr<const Packet> packet)
+{
+  (*count)++;
+}
+
+void
+YansWifiChannelCullingTest::RunOne (bool culling, std::vector<uint32_t> *rxBegin, std::vector<uint32_t> *rxEnd,
+                                    Ptr<YansWifiChannel> *channel)
+{
+  uint32_t nNodes = m_positions.size ();
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      positionAlloc->Add (m_positions[i]);
+    }
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  YansWifiChannelHelper channelHelper = YansWifiChannelHelper::Default ();
+  *channel = channelHelper.Create ();
+  (*channel)->SetAttribute ("ReceiverCulling", BooleanValue (culling));
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (*channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  rxBegin->assign (nNodes, 0);
+  rxEnd->assign (nNodes, 0);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("PhyRxBegin", MakeBoundCallback (&Count, &(*rxBegin)[i]));
+      wifiPhy->TraceConnectWithoutContext ("PhyRxEnd", MakeBoundCallback (&Count, &(*rxEnd)[i]));
+      Ptr<NetDevice> device = devices.Get (i);
+      Simulator::Schedule (MilliSeconds (10 * (i + 1)), &NetDevice::Send, device,
+                           Create<Packet> (100), device->GetBroadcast (), 1);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> coordinate = CreateObject<UniformRandomVariable> ();
+  coordinate->SetStream (1);
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      m_positions.push_back (Vector (coordinate->GetValue (0, 3000), coordinate->GetValue (0, 3000), 0));
+    }
+
+  std::vector<uint32_t> rxBegin, rxEnd, culledRxBegin, culledRxEnd;
+  Ptr<YansWifiChannel> channel, culledChannel;
+  RunOne (false, &rxBegin, &rxEnd, &channel);
+  RunOne (true, &culledRxBegin, &culledRxEnd, &culledChannel);
+
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNCulledReceptions (), 0, "No culling expected");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNReceptions (), 60 * 59, "Every PHY should get every packet");
+  NS_TEST_EXPECT_MSG_GT (culledChannel->GetNCulledReceptions (), 0, "Some PHYs should be out of range");
+  NS_TEST_EXPECT_MSG_EQ (culledChannel->GetNReceptions () + culledChannel->GetNCulledReceptions (), 60 * 59,
+                         "Every PHY should get or skip every packet");
+  uint32_t received = 0;
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (culledRxBegin[i], rxBegin[i], "Different receptions started on node " << i);
+      NS_TEST_EXPECT_MSG_EQ (culledRxEnd[i], rxEnd[i], "Different receptions ended on node " << i);
+      received += rxEnd[i];
+    }
+  NS_TEST_EXPECT_MSG_GT (received, 0, "Some packets should be received");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1715,6 +1842,7 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
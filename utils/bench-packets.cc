@@ -26,15 +26,50 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-memory-pool.h"
+#include "ns3/abort.h"
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <stdlib.h> // for exit ()
 #include <limits>
 #include <algorithm>
+#include <vector>
+#include <atomic>
+#include <new>
 
 using namespace ns3;
 
+/// Number of calls to the global operator new, by any thread
+std::atomic<uint64_t> g_allocs (0);
+
+/**
+ * Count heap allocations.
+ * \param size the number of bytes requested
+ * \returns the allocated storage
+ */
+void *
+operator new (std::size_t size)
+{
+  ++g_allocs;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+/**
+ * Release storage from the counting operator new.
+ * \param p the storage to release
+ */
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
 /// BenchHeader class used for benchmarking packet serialization/deserialization
 template <int N>
 class BenchHeader : public Header
@@ -328,6 +363,114 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchPacketTags (uint32_t n)
+{
+  // Packet tags of the sizes used by the LTE and mmWave stacks, going
+  // through PDCP/RLC-like copy, segmentation and reassembly
+  BenchHeader<2> pdcp;
+  BenchHeader<3> rlc;
+  BenchTag<8> rlcTag;
+  BenchTag<12> pdcpTag;
+  BenchTag<17> macTag;
+  BenchTag<40> lteTag;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1400);
+      p->AddPacketTag (pdcpTag);
+      p->AddHeader (pdcp);
+      p->AddPacketTag (rlcTag);
+      p->AddPacketTag (lteTag);
+
+      // Retransmission buffer copy, then two RLC segments
+      Ptr<Packet> retx = p->Copy ();
+      Ptr<Packet> seg0 = p->CreateFragment (0, 700);
+      Ptr<Packet> seg1 = p->CreateFragment (700, 702);
+      seg0->ReplacePacketTag (rlcTag);
+      seg1->ReplacePacketTag (rlcTag);
+      seg0->AddHeader (rlc);
+      seg1->AddHeader (rlc);
+      seg0->AddPacketTag (macTag);
+      seg1->AddPacketTag (macTag);
+
+      // Receiver side
+      seg0->RemovePacketTag (macTag);
+      seg1->RemovePacketTag (macTag);
+      seg0->RemoveHeader (rlc);
+      seg1->RemoveHeader (rlc);
+      seg0->AddAtEnd (seg1);
+      seg0->RemovePacketTag (rlcTag);
+      seg0->RemoveHeader (pdcp);
+      seg0->RemoveAllPacketTags ();
+      retx->RemovePacketTag (lteTag);
+    }
+}
+
+/**
+ * Segment an SDU into RLC-like PDUs and reassemble it, as RLC does for
+ * the transport blocks of a large TCP segment.
+ * \param sdu the SDU, consumed
+ */
+static void
+SegmentAndReassemble (Ptr<Packet> sdu)
+{
+  BenchHeader<2> rlc;
+  uint32_t sduSize = sdu->GetSize ();
+
+  std::vector<Ptr<Packet> > pdus;
+  while (sdu->GetSize () > 0)
+    {
+      uint32_t segmentSize = std::min<uint32_t> (sdu->GetSize (), 100 - rlc.GetSerializedSize ());
+      Ptr<Packet> pdu = sdu->CreateFragment (0, segmentSize);
+      sdu->RemoveAtStart (segmentSize);
+      pdu->AddHeader (rlc);
+      pdus.push_back (pdu);
+    }
+
+  Ptr<Packet> reassembled;
+  for (std::vector<Ptr<Packet> >::iterator i = pdus.begin (); i != pdus.end (); ++i)
+    {
+      (*i)->RemoveHeader (rlc);
+      if (reassembled == 0)
+        {
+          reassembled = *i;
+        }
+      else
+        {
+          reassembled->AddAtEnd (*i);
+        }
+    }
+  NS_ABORT_UNLESS (reassembled->GetSize () == sduSize);
+}
+
+static void
+benchSegmentation (uint32_t n)
+{
+  BenchHeader<40> tcpIp;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> sdu = Create<Packet> (65536 - tcpIp.GetSerializedSize ());
+      sdu->AddHeader (tcpIp);
+      SegmentAndReassemble (sdu);
+    }
+}
+
+static void
+benchSegmentationData (uint32_t n)
+{
+  BenchHeader<40> tcpIp;
+  std::vector<uint8_t> payload (65536 - tcpIp.GetSerializedSize (), 0x5a);
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> sdu = Create<Packet> (&payload[0], payload.size ());
+      sdu->AddHeader (tcpIp);
+      SegmentAndReassemble (sdu);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -343,16 +486,24 @@ static void
 runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  uint64_t allocs = g_allocs;
+  uint64_t poolAllocs = PacketMemoryPool::GetNAllocations ();
   for (uint32_t i = 0; i < minIterations; i++)
     {
       uint64_t delay = runBenchOneIteration(bench, n);
       minDelay = std::min(minDelay, delay);
     }
+  double packets = n;
+  packets *= minIterations;
+  allocs = g_allocs - allocs;
+  poolAllocs = PacketMemoryPool::GetNAllocations () - poolAllocs;
   double ps = n;
   ps *= 1000;
   ps /= minDelay;
   std::cout << ps << " packets/s"
-            << " (" << minDelay << " ms elapsed)\t"
+            << " (" << minDelay << " ms elapsed, "
+            << allocs / packets << " mallocs/packet, "
+            << poolAllocs / packets << " pool allocs/packet)\t"
             << name
             << std::endl;
 }
@@ -385,6 +536,11 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTags, n, minIterations, "Packet tags with copies and segments");
+  runBench (&benchSegmentation, std::max<uint32_t> (1, n / 100), minIterations,
+            "Segment a 64 KB SDU in 100 bytes PDUs and reassemble it");
+  runBench (&benchSegmentationData, std::max<uint32_t> (1, n / 100), minIterations,
+            "Segment a 64 KB SDU of data in 100 bytes PDUs and reassemble it");
 
   return 0;
 }
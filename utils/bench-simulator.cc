@@ -22,9 +22,13 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <string.h>
 
 #include "ns3/core-module.h"
+#include "ns3/core-config.h"
 
 using namespace ns3;
 
@@ -39,6 +43,39 @@ std::string g_me;
 // Output field width
 int g_fwidth = 6;
 
+// Recorded mmWave event intervals, relative to the top level directory
+const std::string g_mmwaveFile = "utils/bench-simulator-mmwave.txt";
+
+/// Number of calls to the global operator new, by any thread
+std::atomic<uint64_t> g_allocs (0);
+
+/**
+ * Count heap allocations.
+ * \param size the number of bytes requested
+ * \returns the allocated storage
+ */
+void *
+operator new (std::size_t size)
+{
+  ++g_allocs;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+/**
+ * Release storage from the counting operator new.
+ * \param p the storage to release
+ */
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
 /// Bench class
 class Bench
 {
@@ -99,6 +136,7 @@ Bench::RunBench (void)
 {
   SystemWallClockMs time;
   double init, simu;
+  uint64_t allocs;
 
   DEB ("initializing");
   m_count = 0;
@@ -115,10 +153,12 @@ Bench::RunBench (void)
   DEB ("initialization took " << init << "s");
 
   DEB ("running");
+  allocs = g_allocs;
   time.Start ();
   Simulator::Run ();
   simu = time.End ();
   simu /= 1000;
+  allocs = g_allocs - allocs;
   DEB ("run took " << simu << "s");
 
   LOG (std::setw (g_fwidth) << init <<
@@ -126,7 +166,8 @@ Bench::RunBench (void)
        std::setw (g_fwidth) << (init / m_population) <<
        std::setw (g_fwidth) << simu <<
        std::setw (g_fwidth) << (m_count / simu) <<
-       std::setw (g_fwidth) << (simu / m_count));
+       std::setw (g_fwidth) << (simu / m_count) <<
+       std::setw (g_fwidth) << ((double) allocs / m_count));
 
 }
 
@@ -145,6 +186,145 @@ Bench::Cb (void)
 }
 
 
+#ifdef HAVE_PTHREAD_H
+
+/// Benchmark cross-thread event injection through ScheduleWithContext
+class InjectBench
+{
+public:
+  /**
+   * constructor
+   * \param total the total number of events to inject per run
+   */
+  InjectBench (const uint32_t total)
+    : m_total (total),
+      m_count (0),
+      m_producers (1)
+  {
+  }
+
+  /**
+   * Run function
+   * \param producers the number of injecting threads
+   */
+  void RunBench (const uint32_t producers);
+private:
+  /**
+   * Producer thread body
+   * \param context the bench and the producer index
+   */
+  static void Produce (std::pair<InjectBench *, uint32_t> context);
+  /// Injected event
+  void Cb (void);
+  /// Keep the simulator running while events are being injected
+  void Pump (void);
+
+  uint32_t m_total;     ///< total
+  uint32_t m_count;     ///< count
+  uint32_t m_producers; ///< number of producers
+};
+
+void
+InjectBench::RunBench (const uint32_t producers)
+{
+  SystemWallClockMs time;
+  double simu;
+
+  m_count = 0;
+  m_producers = producers;
+  Simulator::ScheduleNow (&InjectBench::Pump, this);
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < producers; ++i)
+    {
+      threads.push_back (Create<SystemThread> (
+        MakeBoundCallback (&InjectBench::Produce,
+                           std::pair<InjectBench *, uint32_t> (this, i))));
+    }
+
+  DEB ("running with " << producers << " producers");
+  time.Start ();
+  for (uint32_t i = 0; i < producers; ++i)
+    {
+      threads[i]->Start ();
+    }
+  Simulator::Run ();
+  simu = time.End ();
+  simu /= 1000;
+  for (uint32_t i = 0; i < producers; ++i)
+    {
+      threads[i]->Join ();
+    }
+  DEB ("run took " << simu << "s");
+
+  LOG (std::setw (g_fwidth) << simu <<
+       std::setw (g_fwidth) << (m_count / simu) <<
+       std::setw (g_fwidth) << (simu / m_count));
+}
+
+void
+InjectBench::Produce (std::pair<InjectBench *, uint32_t> context)
+{
+  InjectBench *me = context.first;
+  uint32_t share = me->m_total / me->m_producers;
+  for (uint32_t i = 0; i < share; ++i)
+    {
+      Simulator::ScheduleWithContext (context.second, Seconds (0),
+                                      &InjectBench::Cb, me);
+    }
+}
+
+void
+InjectBench::Cb (void)
+{
+  ++m_count;
+}
+
+void
+InjectBench::Pump (void)
+{
+  if (m_count < (m_total / m_producers) * m_producers)
+    {
+      Simulator::Schedule (NanoSeconds (1), &InjectBench::Pump, this);
+    }
+}
+
+/**
+ * Run the injection benchmark for 1, 2, 4, ... up to maxThreads producers.
+ * \param total the total number of events to inject per run
+ * \param maxThreads the largest number of producer threads
+ */
+void
+RunInjectBench (const uint32_t total, const uint32_t maxThreads)
+{
+  LOGME ("injection: " << total << " events, 1 to " << maxThreads << " producers");
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Threads" <<
+       std::left << std::setw (3 * g_fwidth) << "Injection:");
+  LOG (std::left << std::setw (g_fwidth) << "" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+  LOG (std::setfill ('-') <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::setfill (' ')
+       );
+
+  InjectBench bench (total);
+  for (uint32_t n = 1; n <= maxThreads; n *= 2)
+    {
+      std::cout << std::left << std::setw (g_fwidth) << n;
+      bench.RunBench (n);
+    }
+  LOG ("");
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
 {
@@ -199,6 +379,61 @@ GetRandomStream (std::string filename)
 }
 
 
+/**
+ * Build a synthetic stream of event intervals shaped like the mmWave PHY.
+ *
+ * This approximates the recorded intervals replayed by --mmwave, for
+ * other symbol periods.  The mmWave PHY and MAC schedule their events (slot start and end,
+ * spectrum StartRx/EndRx, control messages) on OFDM symbol boundaries,
+ * and every cell does so at the same instants.  The resulting event
+ * list is a handful of distinct timestamps, each shared by many events.
+ * The intervals generated here are whole numbers of symbols: zero for
+ * another event at the current boundary, one to a full subframe for
+ * the next slot, and occasionally a whole frame.
+ *
+ * \param symbol the OFDM symbol period, in ns
+ * \returns the random variable stream
+ */
+Ptr<RandomVariableStream>
+GetMmWaveStream (double symbol)
+{
+  // MmWavePhyMacCommon defaults: 24 symbols per subframe,
+  // 10 subframes per frame.
+  const uint32_t symbolsPerSubframe = 24;
+  const uint32_t subframesPerFrame = 10;
+  const uint32_t entries = 100000;
+
+  LOGME ("using mmWave slot-clustered distribution, symbol " << symbol << " ns");
+  Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+  std::vector<double> nsValues;
+  nsValues.reserve (entries);
+  for (uint32_t i = 0; i < entries; ++i)
+    {
+      double u = urv->GetValue ();
+      uint32_t symbols;
+      if (u < 0.35)
+        {
+          symbols = 0;
+        }
+      else if (u < 0.80)
+        {
+          symbols = urv->GetInteger (1, symbolsPerSubframe);
+        }
+      else if (u < 0.95)
+        {
+          symbols = symbolsPerSubframe;
+        }
+      else
+        {
+          symbols = symbolsPerSubframe * subframesPerFrame;
+        }
+      nsValues.push_back (symbols * symbol);
+    }
+  Ptr<DeterministicRandomVariable> drv = CreateObject<DeterministicRandomVariable> ();
+  drv->SetValueArray (&nsValues[0], nsValues.size ());
+  return drv;
+}
+
 
 int main (int argc, char *argv[])
 {
@@ -207,11 +442,17 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedDary = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  bool mmwave = false;
+  bool synthetic = false;
+  double symbol = 4160;
+  bool inject = false;
+  uint32_t threads = 16;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -221,17 +462,32 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in s.\n"
+             "With --mmwave, the intervals are replayed from a recording\n"
+             "of the mmWave EPC example, " + g_mmwaveFile + ",\n"
+             "unless --file is given as well.  With --mmwave --synthetic,\n"
+             "they are instead generated as whole OFDM symbols of --symbol,\n"
+             "clustered at slot and subframe boundaries as in the mmWave PHY.\n"
+             "\n"
+             "With --inject, measure instead the rate at which events\n"
+             "injected from other threads through ScheduleWithContext\n"
+             "are run, for 1, 2, 4,... up to --threads producers.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("dary",  "use DaryHeapScheduler",         schedDary);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("mmwave", "replay recorded mmWave event times", mmwave);
+  cmd.AddValue ("synthetic", "with --mmwave, generate slot-clustered event times instead", synthetic);
+  cmd.AddValue ("symbol", "synthetic mmWave OFDM symbol period in ns (default 4160)", symbol);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("inject", "benchmark cross-thread event injection", inject);
+  cmd.AddValue ("threads", "maximum number of injecting threads (default 16)", threads);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
@@ -249,6 +505,10 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
+  if (schedDary)
+    {
+      factory.SetTypeId ("ns3::DaryHeapScheduler");
+    }
   Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
@@ -259,21 +519,44 @@ int main (int argc, char *argv[])
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
 
+  if (inject)
+    {
+#ifdef HAVE_PTHREAD_H
+      RunInjectBench (total, threads);
+#else
+      LOGME ("threading not available, skipping injection benchmark");
+#endif
+      Simulator::Destroy ();
+      return 0;
+    }
+
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  if (mmwave && synthetic)
+    {
+      bench->SetRandomStream (GetMmWaveStream (symbol));
+    }
+  else if (mmwave && filename == "")
+    {
+      bench->SetRandomStream (GetRandomStream (g_mmwaveFile));
+    }
+  else
+    {
+      bench->SetRandomStream (GetRandomStream (filename));
+    }
 
   // table header
   LOG ("");
   LOG (std::left << std::setw (g_fwidth) << "Run #" <<
        std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
+       std::left << std::setw (4 * g_fwidth) << "Simulation:");
   LOG (std::left << std::setw (g_fwidth) << "" <<
        std::left << std::setw (g_fwidth) << "Time (s)" <<
        std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
        std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
        std::left << std::setw (g_fwidth) << "Time (s)" <<
        std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+       std::left << std::setw (g_fwidth) << "Mallocs/ev" );
   LOG (std::setfill ('-') <<
        std::right << std::setw (g_fwidth) << " " <<
        std::right << std::setw (g_fwidth) << " " <<
@@ -282,6 +565,7 @@ int main (int argc, char *argv[])
        std::right << std::setw (g_fwidth) << " " <<
        std::right << std::setw (g_fwidth) << " " <<
        std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
        std::setfill (' ')
        );
 